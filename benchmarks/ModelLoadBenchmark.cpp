@@ -0,0 +1,215 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Model.h"
+#include "OBJParser.h"
+#include "SRMeshModelLoader.h"
+
+/**
+ * @brief Load time of OBJParser, on one thread and on more, against the string-stream OBJ loader it replaced
+ *
+ * The reference loader is the one OBJModelLoader and Model::loadFromOBJ used
+ * before: std::getline per line, an std::istringstream per line and per face
+ * corner, and std::stoi per index, growing every array as it goes; its
+ * faces are triangulated by Model::setPolygons like the parser's. Both
+ * loaders read the same file into a model, whose vertices, texture
+ * coordinates, normals and triangles must match exactly. OBJParser runs with
+ * 1, 2, 4, ... threads up to the hardware concurrency (or the given count),
+ * so the speedup of the chunked parse shows; the chunks are at least
+ * 1 MiB, so small files stay on fewer threads. The model is then written
+ * as a .srmesh file in the temporary directory and loaded back, which also
+ * restores the meshlets and tangent frames that a parsed model still has
+ * to build (timed on their own). Each time is the best
+ * of several trials, alternating the loaders, so that a noisy machine
+ * penalizes both alike; the file stays in the page cache after the first
+ * read, so the times are parsing rather than disk.
+ *
+ * Usage: model-load-benchmark [obj_file] [repetitions] [max_threads]
+ */
+
+namespace {
+
+constexpr int TRIALS = 5;   // Timed trials of every loader, the shortest time is reported
+
+int parseIndex(const std::string& indexStr) {
+    return std::stoi(indexStr) - 1;
+}
+
+void parseFaceVertex(const std::string& vertexData, Model::Polygons& faces) {
+    std::istringstream viss(vertexData);
+    std::string indexStr;
+    std::getline(viss, indexStr, '/');
+    faces.vertexIndices.push_back(indexStr.empty() ? -1 : parseIndex(indexStr));
+    std::getline(viss, indexStr, '/');
+    faces.textureIndices.push_back(indexStr.empty() ? -1 : parseIndex(indexStr));
+    std::getline(viss, indexStr, '/');
+    faces.normalIndices.push_back(indexStr.empty() ? -1 : parseIndex(indexStr));
+}
+
+/**
+ * @brief The string-stream loader, as OBJModelLoader parsed before OBJParser
+ */
+bool loadWithStreams(const std::string& filename, Model& model) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    Model::Polygons faces;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string prefix;
+        iss >> prefix;
+        if (prefix == "v") {
+            float x, y, z;
+            iss >> x >> y >> z;
+            model.addVertex(Eigen::Vector3f(x, y, z));
+        } else if (prefix == "vt") {
+            float u, v;
+            iss >> u >> v;
+            model.addTextureCoord(Eigen::Vector2f(u, v));
+        } else if (prefix == "vn") {
+            float x, y, z;
+            iss >> x >> y >> z;
+            model.addNormal(Eigen::Vector3f(x, y, z));
+        } else if (prefix == "f") {
+            std::string vertexData;
+            while (iss >> vertexData) {
+                parseFaceVertex(vertexData, faces);
+            }
+            if (faces.vertexIndices.size() - faces.starts.back() >= 3) {
+                faces.starts.push_back(static_cast<uint32_t>(faces.vertexIndices.size()));
+            } else {
+                for (auto* list : {&faces.vertexIndices, &faces.textureIndices, &faces.normalIndices}) {
+                    list->resize(faces.starts.back());
+                }
+            }
+        }
+    }
+    model.setPolygons(faces);
+    return true;
+}
+
+bool sameGeometry(const Model& a, const Model& b) {
+    if (a.getVertices() != b.getVertices() || a.getTextureCoords() != b.getTextureCoords() ||
+        a.getNormals() != b.getNormals() || a.getPositionIds() != b.getPositionIds() ||
+        a.getTriangles().size() != b.getTriangles().size() || a.getTriangleFlags() != b.getTriangleFlags()) {
+        return false;
+    }
+    return std::equal(a.getTriangles().begin(), a.getTriangles().end(), b.getTriangles().begin(),
+                      [](const Model::Triangle& ta, const Model::Triangle& tb) {
+                          return std::equal(ta.vertexIndices, ta.vertexIndices + 3, tb.vertexIndices);
+                      });
+}
+
+/**
+ * @brief Best time of a loader in milliseconds per load, keeping the last model it loaded
+ */
+template<typename Load>
+double time(Load load, const std::string& filename, int repetitions, double best, Model& result) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+        Model model;
+        if (!load(filename, model)) {
+            return -1.0;
+        }
+        if (r == repetitions - 1) {
+            result = std::move(model);
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    double perLoad = elapsed.count() / repetitions;
+    return best < 0.0 || perLoad < best ? perLoad : best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    spdlog::set_level(spdlog::level::warn);
+
+    std::string filename = argc > 1 ? argv[1] : "examples/MarbleVase0022.obj";
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    std::error_code error;
+    double megabytes = static_cast<double>(std::filesystem::file_size(filename, error)) / (1024.0 * 1024.0);
+    if (error) {
+        std::cerr << "Could not open " << filename << std::endl;
+        return 1;
+    }
+
+    unsigned int maxThreads = argc > 3 ? static_cast<unsigned int>(std::stoi(argv[3])) : std::thread::hardware_concurrency();
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(std::max(1u, maxThreads));
+
+    double streams = -1.0;
+    std::vector<double> parser(threadCounts.size(), -1.0);
+    Model streamModel;
+    std::vector<Model> parserModels(threadCounts.size());
+    for (int trial = 0; trial < TRIALS; ++trial) {
+        streams = time(loadWithStreams, filename, repetitions, streams, streamModel);
+        for (size_t i = 0; i < threadCounts.size(); ++i) {
+            unsigned int threads = threadCounts[i];
+            auto load = [threads](const std::string& file, Model& model) { return OBJParser::loadFile(file, model, threads); };
+            parser[i] = time(load, filename, repetitions, parser[i], parserModels[i]);
+        }
+        if (streams < 0.0 || parser[0] < 0.0) {
+            std::cerr << "Could not load " << filename << std::endl;
+            return 1;
+        }
+    }
+
+    // The binary mesh format, written from the parsed model
+    const std::string meshFile = (std::filesystem::temp_directory_path() / "model-load-benchmark.srmesh").string();
+    auto build = std::chrono::steady_clock::now();
+    parserModels[0].buildMeshlets();
+    parserModels[0].buildTangentFrames();
+    std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - build;
+    if (!SRMeshModelLoader::saveModel(parserModels[0], meshFile, "")) {
+        std::cerr << "Could not write " << meshFile << std::endl;
+        return 1;
+    }
+    double meshMegabytes = static_cast<double>(std::filesystem::file_size(meshFile)) / (1024.0 * 1024.0);
+    double binary = -1.0;
+    Model binaryModel;
+    auto loadBinary = [](const std::string& file, Model& model) {
+        model = std::move(*SRMeshModelLoader().loadModel(file));
+        return true;
+    };
+    for (int trial = 0; trial < TRIALS; ++trial) {
+        binary = time(loadBinary, meshFile, repetitions, binary, binaryModel);
+    }
+    std::filesystem::remove(meshFile);
+
+    std::cout << filename << ": " << megabytes << " MiB, " << parserModels[0].getVertices().size() << " vertices, "
+              << parserModels[0].getTriangles().size() << " triangles, " << repetitions << " loads per trial" << std::endl;
+    std::cout << "  streams                " << streams << " ms  " << megabytes * 1000.0 / streams << " MiB/s" << std::endl;
+    bool mismatch = false;
+    for (size_t i = 0; i < threadCounts.size(); ++i) {
+        std::cout << "  OBJParser " << threadCounts[i] << (threadCounts[i] == 1 ? " thread   " : " threads  ")
+                  << parser[i] << " ms  " << megabytes * 1000.0 / parser[i] << " MiB/s  " << streams / parser[i] << "x";
+        if (!sameGeometry(streamModel, parserModels[i])) {
+            std::cout << "  GEOMETRY MISMATCH";
+            mismatch = true;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "  + meshlets, tangents   " << buildTime.count() << " ms" << std::endl;
+    std::cout << "  srmesh                 " << binary << " ms  " << meshMegabytes * 1000.0 / binary << " MiB/s  "
+              << streams / binary << "x";
+    if (!sameGeometry(streamModel, binaryModel)) {
+        std::cout << "  GEOMETRY MISMATCH";
+        mismatch = true;
+    }
+    std::cout << std::endl;
+    return mismatch ? 1 : 0;
+}
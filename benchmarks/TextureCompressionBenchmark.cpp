@@ -0,0 +1,145 @@
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Texture.h"
+#include "TextureSampler.h"
+#include "TextureWalk.h"
+
+/**
+ * @brief Size, quality and fetch throughput of the block-compressed texture formats
+ *
+ * The texture is converted from RGBA8 to BC1 and BC3, timing the
+ * compression, and each format reports the bytes of its pixel data and the
+ * PSNR of its RGB channels against the RGBA8 original. Nearest and bilinear
+ * fetches then walk a 512x512 pixel grid across the texture (see
+ * TextureWalk) with the scalar sampler (and the 8-wide sampler in AVX2
+ * builds), whose checksums must match since both decode the same blocks.
+ * Each rate is the best of several trials, alternating the formats, so that
+ * a noisy machine penalizes all alike.
+ *
+ * Usage: texture-compression-benchmark [tga_file] [repetitions]
+ */
+
+namespace {
+
+constexpr int GRID = TextureWalk::GRID;
+constexpr int TRIALS = TextureWalk::TRIALS;
+using Result = TextureWalk::Result;
+
+/**
+ * @brief Peak signal-to-noise ratio of the RGB channels of a texture against a reference, in dB
+ */
+double psnr(const Texture& reference, const Texture& texture) {
+    double squaredError = 0.0;
+    for (int y = 0; y < reference.getHeight(); ++y) {
+        for (int x = 0; x < reference.getWidth(); ++x) {
+            uint32_t a = reference.getTexel(x, y), b = texture.getTexel(x, y);
+            for (int shift = 0; shift < 24; shift += 8) {
+                double difference = static_cast<double>((a >> shift) & 0xFF) - static_cast<double>((b >> shift) & 0xFF);
+                squaredError += difference * difference;
+            }
+        }
+    }
+    double meanSquaredError = squaredError / (3.0 * reference.getWidth() * reference.getHeight());
+    return meanSquaredError == 0.0 ? INFINITY : 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+template<bool Bilinear>
+Result runScalar(const TextureSampler& sampler, const TextureWalk& walk, int repetitions) {
+    const TextureSampler::Level& level = sampler.getLevel(0);
+    return walk.runScalar(repetitions, [&](float u, float v) {
+        return Bilinear ? sampler.sampleBilinear(level, u, v) : sampler.sampleNearest(level, u, v);
+    });
+}
+
+#ifdef __AVX2__
+template<bool Bilinear>
+Result runSimd(const TextureSampler& sampler, const TextureWalk& walk, int repetitions) {
+    const TextureSampler::Level& level = sampler.getLevel(0);
+    const __m256i all = _mm256_set1_epi32(-1);
+    return walk.runSimd(repetitions, [&](__m256 u, __m256 v) {
+        return Bilinear ? sampler.sampleBilinear(level, u, v, all) : sampler.sampleNearest(level, u, v, all);
+    });
+}
+#endif
+
+/**
+ * @brief Times a filter on every format and prints the best fetch rates, checking scalar against AVX2
+ */
+template<bool Bilinear>
+void report(const char* filter, const TextureWalk& walk, const std::vector<TextureSampler>& samplers,
+            const char* const names[], int repetitions) {
+    std::vector<Result> scalar(samplers.size(), Result{ 0.0, 0 });
+#ifdef __AVX2__
+    std::vector<Result> simd(samplers.size(), Result{ 0.0, 0 });
+#endif
+    for (int trial = 0; trial < TRIALS; ++trial) {
+        for (size_t i = 0; i < samplers.size(); ++i) {
+            Result s = runScalar<Bilinear>(samplers[i], walk, repetitions);
+            if (s.fetchesPerSecond > scalar[i].fetchesPerSecond) scalar[i] = s;
+#ifdef __AVX2__
+            Result v = runSimd<Bilinear>(samplers[i], walk, repetitions);
+            if (v.fetchesPerSecond > simd[i].fetchesPerSecond) simd[i] = v;
+#endif
+        }
+    }
+
+    for (size_t i = 0; i < samplers.size(); ++i) {
+        std::cout << "  " << filter << "  " << names[i]
+                  << "  scalar " << scalar[i].fetchesPerSecond / 1e6 << " M/s";
+#ifdef __AVX2__
+        std::cout << "  avx2 " << simd[i].fetchesPerSecond / 1e6 << " M/s"
+                  << (scalar[i].checksum == simd[i].checksum ? "" : "  CHECKSUM MISMATCH");
+#endif
+        std::cout << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    spdlog::set_level(spdlog::level::warn);
+
+    std::string filename = argc > 1 ? argv[1] : "examples/head/african_head_diffuse.tga";
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 4;
+
+    Texture original;
+    if (!original.loadFromTGA(filename)) {
+        std::cerr << "Could not load " << filename << std::endl;
+        return 1;
+    }
+    original.setFormat(TextureFormat::RGBA8);
+
+    std::cout << filename << ": " << original.getWidth() << "x" << original.getHeight()
+              << ", " << GRID << "x" << GRID << " fetches x " << repetitions << std::endl;
+
+    const char* const names[] = { "rgba8", "bc1  ", "bc3  " };
+    const TextureFormat formats[] = { TextureFormat::RGBA8, TextureFormat::BC1, TextureFormat::BC3 };
+    std::vector<Texture> textures;
+    for (TextureFormat format : formats) {
+        Texture texture = original;
+        auto start = std::chrono::steady_clock::now();
+        texture.setFormat(format);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "  " << names[textures.size()] << "  " << texture.getData().size() / 1024 << " KiB"
+                  << "  psnr " << psnr(original, texture) << " dB"
+                  << "  compressed in " << elapsed.count() << " ms" << std::endl;
+        textures.push_back(std::move(texture));
+    }
+
+    // Samplers point into the textures, which stay in place from here on
+    std::vector<TextureSampler> samplers;
+    for (const Texture& texture : textures) {
+        samplers.emplace_back(&texture);
+    }
+
+    const TextureWalk walk(30.0f);
+    report<false>("nearest ", walk, samplers, names, repetitions);
+    report<true>("bilinear", walk, samplers, names, repetitions);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <spdlog/spdlog.h>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "PixelShading.h"
+#include "Texture.h"
+#include "TextureSampler.h"
+#include "TextureWalk.h"
+
+/**
+ * @brief Texture fetch throughput of the linear and the Morton layout
+ *
+ * Every pattern walks a 512x512 pixel grid across the texture at a fixed
+ * angle (see TextureWalk). The same texture is sampled in both layouts with
+ * the scalar sampler (and the 8-wide sampler in AVX2 builds); the checksums
+ * must match, since only the addressing differs.
+ * Each measurement is the best of several trials, alternating the layouts,
+ * so that a noisy machine penalizes both alike.
+ *
+ * Usage: texture-fetch-benchmark [tga_file] [repetitions]
+ */
+
+namespace {
+
+constexpr int GRID = TextureWalk::GRID;
+constexpr int TRIALS = TextureWalk::TRIALS;
+using Result = TextureWalk::Result;
+
+struct Pattern {
+    const char* name;
+    float degrees;          // Rotation of the UV axes against the texture
+};
+
+/**
+ * @brief Times a sampler on both layouts and prints the best fetch rates
+ */
+template<typename Run>
+void report(const char* sampler, const Pattern& pattern, const Texture& linear, const Texture& morton, Run run) {
+    Result bestLinear{ 0.0, 0 }, bestMorton{ 0.0, 0 };
+    for (int trial = 0; trial < TRIALS; ++trial) {
+        Result l = run(linear);
+        Result m = run(morton);
+        if (l.fetchesPerSecond > bestLinear.fetchesPerSecond) bestLinear = l;
+        if (m.fetchesPerSecond > bestMorton.fetchesPerSecond) bestMorton = m;
+    }
+
+    std::cout << "  " << sampler << "  " << pattern.name
+              << "  linear " << bestLinear.fetchesPerSecond / 1e6 << " M/s"
+              << "  morton " << bestMorton.fetchesPerSecond / 1e6 << " M/s"
+              << "  speedup " << bestMorton.fetchesPerSecond / bestLinear.fetchesPerSecond << "x"
+              << (bestLinear.checksum == bestMorton.checksum ? "" : "  CHECKSUM MISMATCH") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    spdlog::set_level(spdlog::level::warn);
+
+    std::string filename = argc > 1 ? argv[1] : "examples/head/african_head_diffuse.tga";
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 4;
+
+    Texture linear;
+    if (!linear.loadFromTGA(filename)) {
+        std::cerr << "Could not load " << filename << std::endl;
+        return 1;
+    }
+    Texture morton = linear;
+    if (!morton.setLayout(TextureLayout::MORTON)) {
+        std::cerr << "Morton layout needs a power-of-two texture" << std::endl;
+        return 1;
+    }
+
+    std::cout << filename << ": " << linear.getWidth() << "x" << linear.getHeight()
+              << ", " << GRID << "x" << GRID << " fetches x " << repetitions << std::endl;
+
+    const Pattern patterns[] = {
+        { "horizontal", 0.0f },
+        { "diagonal  ", 45.0f },
+        { "vertical  ", 90.0f },
+        { "skewed    ", 70.0f },
+    };
+
+    for (const Pattern& pattern : patterns) {
+        TextureWalk walk(pattern.degrees);
+        report("scalar", pattern, linear, morton, [&](const Texture& texture) {
+            const TextureSampler sampler(&texture);
+            const TextureSampler::Level& level = sampler.getLevel(0);
+            return walk.runScalar(repetitions, [&](float u, float v) { return sampler.sampleNearest(level, u, v); });
+        });
+#ifdef __AVX2__
+        report("avx2  ", pattern, linear, morton, [&](const Texture& texture) {
+            const TextureSampler sampler(&texture);
+            const TextureSampler::Level& level = sampler.getLevel(0);
+            const __m256i all = _mm256_set1_epi32(-1);
+            return walk.runSimd(repetitions, [&](__m256 u, __m256 v) { return sampler.sampleNearest(level, u, v, all); });
+        });
+#endif
+    }
+    return 0;
+}
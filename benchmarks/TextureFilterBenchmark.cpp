@@ -0,0 +1,146 @@
+#include <spdlog/spdlog.h>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include "PixelShading.h"
+#include "Texture.h"
+#include "TextureSampler.h"
+#include "TextureWalk.h"
+
+/**
+ * @brief Cost of bilinear filtering against nearest sampling, per wrap mode
+ *
+ * Walks a 512x512 pixel grid across the texture at several angles (see
+ * TextureWalk) and times nearest and bilinear sampling of a bound
+ * TextureSampler in every wrap mode, scalar and, in AVX2 builds, 8-wide; the
+ * 8-wide kernels must return the same colors as the scalar ones. Unbound
+ * Texture::getColorAt is timed as well, for the cost of deciding the
+ * addressing on every call. The texture is stored the way the loader stores
+ * it (Morton order for power-of-two sizes); a texture with other sizes
+ * exercises the modulo path of the wrap modes. The texture can be converted
+ * to a compact format first, to compare its bandwidth against the decoding
+ * work. Each measurement is the best of several trials.
+ *
+ * Usage: texture-filter-benchmark [tga_file] [repetitions] [rgba8|rgb565|rg8|r8|bc1|bc3]
+ */
+
+namespace {
+
+constexpr int GRID = TextureWalk::GRID;
+constexpr int TRIALS = TextureWalk::TRIALS;
+using Result = TextureWalk::Result;
+
+/**
+ * @brief Best of several trials of one sampler
+ */
+template<typename Run>
+Result best(Run run) {
+    Result result{ 0.0, 0 };
+    for (int trial = 0; trial < TRIALS; ++trial) {
+        Result r = run();
+        if (r.fetchesPerSecond > result.fetchesPerSecond) result = r;
+    }
+    return result;
+}
+
+void print(const char* sampler, const Result& nearest, const Result& bilinear) {
+    std::cout << "      " << sampler
+              << "  nearest " << nearest.fetchesPerSecond / 1e6 << " M/s"
+              << "  bilinear " << bilinear.fetchesPerSecond / 1e6 << " M/s"
+              << "  cost " << nearest.fetchesPerSecond / bilinear.fetchesPerSecond << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    spdlog::set_level(spdlog::level::warn);
+
+    std::string filename = argc > 1 ? argv[1] : "examples/head/african_head_diffuse.tga";
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 4;
+
+    Texture texture;
+    if (!texture.loadFromTGA(filename)) {
+        std::cerr << "Could not load " << filename << std::endl;
+        return 1;
+    }
+    if (argc > 3) {
+        const std::map<std::string, TextureFormat> formats = {
+            { "rgba8", TextureFormat::RGBA8 }, { "rgb565", TextureFormat::RGB565 },
+            { "rg8", TextureFormat::RG8 }, { "r8", TextureFormat::R8 },
+            { "bc1", TextureFormat::BC1 }, { "bc3", TextureFormat::BC3 },
+        };
+        auto format = formats.find(argv[3]);
+        if (format == formats.end()) {
+            std::cerr << "Unknown texture format " << argv[3] << std::endl;
+            return 1;
+        }
+        texture.setFormat(format->second);
+    }
+    if (texture.supportsMortonLayout() && !Texture::isBlockCompressed(texture.getFormat())) {
+        texture.setLayout(TextureLayout::MORTON);
+    }
+
+    std::cout << filename << ": " << texture.getWidth() << "x" << texture.getHeight()
+              << (texture.getLayout() == TextureLayout::MORTON ? " morton" : " linear")
+              << ", " << Texture::getTexelSize(texture.getFormat()) / (Texture::isBlockCompressed(texture.getFormat()) ? 16.0 : 1.0)
+              << " bytes per texel"
+              << ", " << GRID << "x" << GRID << " fetches x " << repetitions << std::endl;
+
+    const struct {
+        const char* name;
+        float degrees;
+    } patterns[] = {
+        { "horizontal", 0.0f },
+        { "diagonal", 45.0f },
+        { "skewed", 70.0f },
+    };
+    const struct {
+        const char* name;
+        TextureWrap mode;
+    } wraps[] = {
+        { "repeat", TextureWrap::REPEAT },
+        { "clamp", TextureWrap::CLAMP },
+        { "mirror", TextureWrap::MIRROR },
+    };
+
+    for (const auto& pattern : patterns) {
+        TextureWalk walk(pattern.degrees);
+        std::cout << "  " << pattern.name << std::endl;
+
+        Result unbound = best([&] {
+            return walk.runScalar(repetitions, [&](float u, float v) { return texture.getColorAt(u, v); });
+        });
+        std::cout << "    unbound  nearest " << unbound.fetchesPerSecond / 1e6 << " M/s" << std::endl;
+
+        for (const auto& wrap : wraps) {
+            TextureSampler sampler(&texture);
+            sampler.setWrap(wrap.mode);
+            const TextureSampler::Level& level = sampler.getLevel(0);
+            std::cout << "    " << wrap.name << std::endl;
+
+            Result scalarNearest = best([&] {
+                return walk.runScalar(repetitions, [&](float u, float v) { return sampler.sampleNearest(level, u, v); });
+            });
+            Result scalarBilinear = best([&] {
+                return walk.runScalar(repetitions, [&](float u, float v) { return sampler.sampleBilinear(level, u, v); });
+            });
+            print("scalar", scalarNearest, scalarBilinear);
+
+#ifdef __AVX2__
+            const __m256i all = _mm256_set1_epi32(-1);
+            Result simdNearest = best([&] {
+                return walk.runSimd(repetitions, [&](__m256 u, __m256 v) { return sampler.sampleNearest(level, u, v, all); });
+            });
+            Result simdBilinear = best([&] {
+                return walk.runSimd(repetitions, [&](__m256 u, __m256 v) { return sampler.sampleBilinear(level, u, v, all); });
+            });
+            print("avx2  ", simdNearest, simdBilinear);
+            bool match = simdNearest.checksum == scalarNearest.checksum && simdBilinear.checksum == scalarBilinear.checksum;
+            std::cout << "      bilinear speedup of avx2 over scalar " << simdBilinear.fetchesPerSecond / scalarBilinear.fetchesPerSecond
+                      << "x" << (match ? "" : "  CHECKSUM MISMATCH") << std::endl;
+#endif
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include "TextureSampler.h"
+
+/**
+ * @brief Texture coordinates of a pixel grid walked across a texture, shared by the texture benchmarks
+ *
+ * The UVs of the GRID x GRID pixels span the texture once, rotated by a
+ * fixed angle against it (wrapping at the borders), the way a rasterizer
+ * visits a model that fills a GRID pixel view. runScalar and runSimd time
+ * any sampler over the walk; each benchmark keeps the best of TRIALS runs.
+ */
+struct TextureWalk {
+    static constexpr int GRID = 512;    // Pixels per side of the walked grid
+    static constexpr int TRIALS = 5;    // Timed runs per measurement, the fastest counts
+
+    /**
+     * @brief Fetch rate of one timed run and the sum of the fetched texels
+     */
+    struct Result {
+        double fetchesPerSecond;
+        uint64_t checksum;
+    };
+
+    float du, dv;           // UV step per pixel in x
+    float rowU, rowV;       // UV step per row
+    float u0, v0;           // UV of the first pixel
+
+    explicit TextureWalk(float degrees) {
+        float radians = degrees * 3.14159265f / 180.0f;
+        float c = std::cos(radians), s = std::sin(radians);
+        du = c / GRID;
+        dv = s / GRID;
+        rowU = -s / GRID;
+        rowV = c / GRID;
+        u0 = 0.5f - (du + rowU) * GRID / 2;
+        v0 = 0.5f - (dv + rowV) * GRID / 2;
+    }
+
+    /**
+     * @brief Times a scalar sampler over the walk
+     * @param repetitions Number of times the grid is walked
+     * @param sample Callable taking (u, v) and returning the packed texel
+     */
+    template<typename Sample>
+    Result runScalar(int repetitions, Sample sample) const {
+        uint64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r) {
+            for (int y = 0; y < GRID; ++y) {
+                float u = u0 + rowU * y;
+                float v = v0 + rowV * y;
+                for (int x = 0; x < GRID; ++x) {
+                    checksum += sample(u + du * x, v + dv * x);
+                }
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return { static_cast<double>(repetitions) * GRID * GRID / elapsed.count(), checksum };
+    }
+
+#ifdef __AVX2__
+    /**
+     * @brief Times an 8-wide sampler over the walk; the checksum matches runScalar for the same texels
+     * @param repetitions Number of times the grid is walked
+     * @param sample Callable taking (__m256 u, __m256 v) and returning eight packed texels
+     */
+    template<typename Sample>
+    Result runSimd(int repetitions, Sample sample) const {
+        const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i sum = _mm256_setzero_si256();
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r) {
+            for (int y = 0; y < GRID; ++y) {
+                float u = u0 + rowU * y;
+                float v = v0 + rowV * y;
+                for (int x = 0; x < GRID; x += 8) {
+                    __m256 xs = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lane);
+                    __m256 us = _mm256_add_ps(_mm256_set1_ps(u), _mm256_mul_ps(_mm256_set1_ps(du), xs));
+                    __m256 vs = _mm256_add_ps(_mm256_set1_ps(v), _mm256_mul_ps(_mm256_set1_ps(dv), xs));
+                    __m256i texels = sample(us, vs);
+                    sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(texels)));
+                    sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(texels, 1)));
+                }
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+        return { static_cast<double>(repetitions) * GRID * GRID / elapsed.count(), lanes[0] + lanes[1] + lanes[2] + lanes[3] };
+    }
+#endif
+};
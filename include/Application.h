@@ -4,6 +4,7 @@
 #include <string>
 #include "Model.h"
 #include "Renderer.h"
+#include "Shaders.h"
 
 /**
  * @brief Main application class for the software renderer
@@ -36,12 +37,20 @@ public:
     bool loadModel(const std::string& filename);
     
     /**
-     * @brief Sets a texture for the model
+     * @brief Sets a texture for the model, shared through the texture cache if the file is already loaded
      * @param filename Path to the TGA texture file
      * @return True if loading was successful, false otherwise
      */
     bool setTexture(const std::string& filename);
     
+    /**
+     * @brief Sets the normal map of the model, shared through the texture cache like textures
+     * @param filename Path to the TGA normal map
+     * @param space Space the normals of the map are expressed in
+     * @return True if loading was successful, false otherwise
+     */
+    bool setNormalMap(const std::string& filename, NormalSpace space);
+    
     /**
      * @brief Sets the camera position
      * @param x X coordinate
@@ -56,6 +65,49 @@ public:
      */
     void setRenderMode(RenderMode mode);
     
+    /**
+     * @brief Sets the number of rendering threads
+     * @param threadCount Number of threads (0 = hardware concurrency)
+     */
+    void setThreadCount(unsigned int threadCount);
+    
+    /**
+     * @brief Sets the rasterizer backend used for filled triangles
+     * @param backend Rasterizer backend
+     */
+    void setRasterBackend(RasterBackend backend);
+    
+    /**
+     * @brief Sets the texture filter of the textured modes
+     * @param filter Texture filter
+     */
+    void setTextureFilter(TextureFilter filter);
+    
+    /**
+     * @brief Sets the texture wrap mode of the textured modes
+     * @param wrap Texture wrap mode
+     */
+    void setTextureWrap(TextureWrap wrap);
+    
+    /**
+     * @brief Converts the texture of the model to another storage format
+     * @param format Texture format
+     * @return True if the model has a texture to convert, false otherwise
+     */
+    bool setTextureFormat(TextureFormat format);
+    
+    /**
+     * @brief Sets which triangle facing is culled
+     * @param mode Cull mode
+     */
+    void setCullMode(CullMode mode);
+    
+    /**
+     * @brief Sets the shader program used instead of the render mode
+     * @param look Built-in shader look, NONE to use the render mode
+     */
+    void setShaderLook(ShaderLook look);
+    
     /**
      * @brief Renders the current model
      * @return True if rendering was successful, false otherwise
@@ -86,4 +138,5 @@ private:
     int height;                             // Height of the output image
     std::shared_ptr<Model> model;           // Current 3D model
     std::unique_ptr<Renderer> renderer;     // Renderer
+    ShaderLook shaderLook = ShaderLook::NONE;   // Shader program replacing the render mode
 }; 
\ No newline at end of file
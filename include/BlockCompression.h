@@ -0,0 +1,278 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief BC1 and BC3 style block compression of 4x4 texel tiles
+ *
+ * A BC1 block takes 8 bytes: two RGB565 endpoints followed by a 2-bit
+ * selector per texel, texel (x, y) of the tile at bits 2 * (4 * y + x).
+ * If the first endpoint is greater, the selectors pick from the endpoints
+ * and the colors a third and two thirds of the way between them; otherwise
+ * from the endpoints, their midpoint and transparent black.
+ *
+ * A BC3 block takes 16 bytes: an alpha block (two 8-bit endpoints followed
+ * by a 3-bit selector per texel in the next 6 bytes) and a BC1 color block
+ * that always uses four colors. With the first alpha endpoint greater, the
+ * selectors pick from the endpoints and six alphas between them; otherwise
+ * from the endpoints, four alphas between them, 0 and 255.
+ *
+ * Interpolated channels are rounded down, with divisions written as
+ * multiplies and shifts that are exact over the channel range, so the
+ * scalar and the 8-wide decoders return identical colors.
+ */
+
+constexpr size_t BC1_BLOCK_BYTES = 8;   // Bytes of a BC1 block
+constexpr size_t BC3_BLOCK_BYTES = 16;  // Bytes of a BC3 block
+
+/**
+ * @brief Widens an RGB565 color to opaque ARGB, repeating the top bits of each channel
+ */
+inline uint32_t expandRGB565(uint32_t value) {
+    uint32_t r = (value >> 11) & 0x1F, g = (value >> 5) & 0x3F, b = value & 0x1F;
+    return 0xFF000000 | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+/**
+ * @brief Rounds 8-bit RGB channels to RGB565
+ */
+inline uint32_t packRGB565(uint32_t r, uint32_t g, uint32_t b) {
+    return ((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255);
+}
+
+/**
+ * @brief Weighted average of the RGB channels of two opaque colors, rounded down
+ * @param divisor weightA + weightB, 2 or 3
+ */
+inline uint32_t blendEndpoints(uint32_t a, uint32_t b, uint32_t weightA, uint32_t weightB, uint32_t divisor) {
+    uint32_t result = 0xFF000000;
+    for (int shift = 0; shift < 24; shift += 8) {
+        uint32_t sum = ((a >> shift) & 0xFF) * weightA + ((b >> shift) & 0xFF) * weightB;
+        result |= (divisor == 3 ? (sum * 0xAAAB) >> 17 : sum >> 1) << shift;
+    }
+    return result;
+}
+
+/**
+ * @brief Color a selector of a BC1 color block picks
+ * @param endpoints Both RGB565 endpoints, the first in the low 16 bits
+ * @param selector 0 to 3
+ * @param fourColors Always interpolate four colors, as BC3 color blocks do
+ */
+inline uint32_t decodeBC1Color(uint32_t endpoints, uint32_t selector, bool fourColors) {
+    uint32_t c0 = endpoints & 0xFFFF, c1 = endpoints >> 16;
+    uint32_t a = expandRGB565(c0), b = expandRGB565(c1);
+    fourColors = fourColors || c0 > c1;
+    switch (selector) {
+        case 0: return a;
+        case 1: return b;
+        case 2: return fourColors ? blendEndpoints(a, b, 2, 1, 3) : blendEndpoints(a, b, 1, 1, 2);
+        default: return fourColors ? blendEndpoints(a, b, 1, 2, 3) : 0;
+    }
+}
+
+/**
+ * @brief Alpha a selector of a BC3 alpha block picks
+ * @param selector 0 to 7
+ */
+inline uint32_t decodeBC3Alpha(uint32_t a0, uint32_t a1, uint32_t selector) {
+    if (selector < 2) {
+        return selector == 0 ? a0 : a1;
+    }
+    if (a0 > a1) {
+        return (((8 - selector) * a0 + (selector - 1) * a1) * 2341) >> 14;     // Division by 7
+    }
+    if (selector >= 6) {
+        return selector == 6 ? 0 : 255;
+    }
+    return (((6 - selector) * a0 + (selector - 1) * a1) * 1639) >> 13;         // Division by 5
+}
+
+/**
+ * @brief Decodes one texel of a BC1 block
+ * @param block First byte of the block
+ * @param slot Position in the tile, 4 * y + x
+ * @return Texel as ARGB
+ */
+inline uint32_t decodeBC1Texel(const uint8_t* block, uint32_t slot) {
+    uint32_t words[2];
+    std::memcpy(words, block, sizeof(words));
+    return decodeBC1Color(words[0], (words[1] >> (2 * slot)) & 3, false);
+}
+
+/**
+ * @brief Decodes one texel of a BC3 block
+ * @param block First byte of the block
+ * @param slot Position in the tile, 4 * y + x
+ * @return Texel as ARGB
+ */
+inline uint32_t decodeBC3Texel(const uint8_t* block, uint32_t slot) {
+    uint64_t alphaBlock;
+    uint32_t words[2];
+    std::memcpy(&alphaBlock, block, sizeof(alphaBlock));
+    std::memcpy(words, block + 8, sizeof(words));
+    uint32_t alpha = decodeBC3Alpha(alphaBlock & 0xFF, (alphaBlock >> 8) & 0xFF,
+                                    static_cast<uint32_t>(alphaBlock >> (16 + 3 * slot)) & 7);
+    return (decodeBC1Color(words[0], (words[1] >> (2 * slot)) & 3, true) & 0x00FFFFFF) | (alpha << 24);
+}
+
+/**
+ * @brief Compresses a 4x4 tile into a BC1 block
+ *
+ * The endpoints span the bounding box of the tile's colors along the
+ * diagonal that follows their correlation, inset by a sixteenth of the
+ * range, and every texel takes the nearest color of the block. Tiles with
+ * texels below half alpha use the three-color mode and store those texels
+ * as transparent black.
+ *
+ * @param texels Tile as ARGB, row by row
+ * @param block 8 bytes to write
+ */
+void compressBC1Block(const uint32_t texels[16], uint8_t* block);
+
+/**
+ * @brief Compresses a 4x4 tile into a BC3 block
+ *
+ * Colors are fit as in compressBC1Block, always with four colors; the
+ * alpha endpoints are the tile's extremes, each texel taking the nearest
+ * of the eight alphas between them.
+ *
+ * @param texels Tile as ARGB, row by row
+ * @param block 16 bytes to write
+ */
+void compressBC3Block(const uint32_t texels[16], uint8_t* block);
+
+#ifdef __AVX2__
+/**
+ * @brief 8-wide expandRGB565 on the low 16 bits of each lane
+ */
+inline __m256i expandRGB565(__m256i value) {
+    __m256i r = _mm256_and_si256(_mm256_srli_epi32(value, 11), _mm256_set1_epi32(0x1F));
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(value, 5), _mm256_set1_epi32(0x3F));
+    __m256i b = _mm256_and_si256(value, _mm256_set1_epi32(0x1F));
+    r = _mm256_or_si256(_mm256_slli_epi32(r, 3), _mm256_srli_epi32(r, 2));
+    g = _mm256_or_si256(_mm256_slli_epi32(g, 2), _mm256_srli_epi32(g, 4));
+    b = _mm256_or_si256(_mm256_slli_epi32(b, 3), _mm256_srli_epi32(b, 2));
+    __m256i color = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(r, 16), _mm256_slli_epi32(g, 8)), b);
+    return _mm256_or_si256(color, _mm256_set1_epi32(static_cast<int>(0xFF000000)));
+}
+
+/**
+ * @brief 8-wide blendEndpoints, two channels per 32-bit word as in lerpTexels
+ */
+inline __m256i blendEndpoints(__m256i a, __m256i b, int weightA, int weightB, int divisor) {
+    const __m256i channelMask = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i wa = _mm256_set1_epi16(static_cast<short>(weightA)), wb = _mm256_set1_epi16(static_cast<short>(weightB));
+    __m256i rb = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(a, channelMask), wa),
+                                  _mm256_mullo_epi16(_mm256_and_si256(b, channelMask), wb));
+    __m256i ag = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(a, 8), channelMask), wa),
+                                  _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(b, 8), channelMask), wb));
+    if (divisor == 3) {
+        const __m256i reciprocal = _mm256_set1_epi16(static_cast<short>(0xAAAB));
+        rb = _mm256_srli_epi16(_mm256_mulhi_epu16(rb, reciprocal), 1);
+        ag = _mm256_srli_epi16(_mm256_mulhi_epu16(ag, reciprocal), 1);
+    } else {
+        rb = _mm256_srli_epi16(rb, 1);
+        ag = _mm256_srli_epi16(ag, 1);
+    }
+    return _mm256_or_si256(rb, _mm256_slli_epi32(ag, 8));
+}
+
+/**
+ * @brief 8-wide decodeBC1Color
+ * @param endpoints Color endpoints of each lane's block
+ * @param selector Selector of each lane, 0 to 3
+ */
+inline __m256i decodeBC1Color(__m256i endpoints, __m256i selector, bool fourColors) {
+    __m256i c0 = _mm256_and_si256(endpoints, _mm256_set1_epi32(0xFFFF));
+    __m256i c1 = _mm256_srli_epi32(endpoints, 16);
+    __m256i a = expandRGB565(c0), b = expandRGB565(c1);
+
+    __m256i third = blendEndpoints(a, b, 2, 1, 3);
+    __m256i twoThirds = blendEndpoints(a, b, 1, 2, 3);
+    if (!fourColors) {
+        __m256i four = _mm256_cmpgt_epi32(c0, c1);
+        third = _mm256_blendv_epi8(blendEndpoints(a, b, 1, 1, 2), third, four);
+        twoThirds = _mm256_and_si256(twoThirds, four);
+    }
+
+    __m256i color = _mm256_blendv_epi8(a, b, _mm256_cmpeq_epi32(selector, _mm256_set1_epi32(1)));
+    color = _mm256_blendv_epi8(color, third, _mm256_cmpeq_epi32(selector, _mm256_set1_epi32(2)));
+    return _mm256_blendv_epi8(color, twoThirds, _mm256_cmpeq_epi32(selector, _mm256_set1_epi32(3)));
+}
+
+/**
+ * @brief 8-wide decodeBC3Alpha
+ */
+inline __m256i decodeBC3Alpha(__m256i a0, __m256i a1, __m256i selector) {
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i lowerWeight = _mm256_sub_epi32(selector, one);
+    __m256i sevenths = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(_mm256_set1_epi32(8), selector), a0),
+                                        _mm256_mullo_epi32(lowerWeight, a1));
+    sevenths = _mm256_srli_epi32(_mm256_mullo_epi32(sevenths, _mm256_set1_epi32(2341)), 14);
+    __m256i fifths = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(_mm256_set1_epi32(6), selector), a0),
+                                      _mm256_mullo_epi32(lowerWeight, a1));
+    fifths = _mm256_srli_epi32(_mm256_mullo_epi32(fifths, _mm256_set1_epi32(1639)), 13);
+
+    // Six-alpha blocks end in 0 and 255
+    fifths = _mm256_blendv_epi8(fifths, _mm256_setzero_si256(), _mm256_cmpeq_epi32(selector, _mm256_set1_epi32(6)));
+    fifths = _mm256_blendv_epi8(fifths, _mm256_set1_epi32(255), _mm256_cmpeq_epi32(selector, _mm256_set1_epi32(7)));
+
+    __m256i alpha = _mm256_blendv_epi8(fifths, sevenths, _mm256_cmpgt_epi32(a0, a1));
+    alpha = _mm256_blendv_epi8(alpha, a0, _mm256_cmpeq_epi32(selector, _mm256_setzero_si256()));
+    return _mm256_blendv_epi8(alpha, a1, _mm256_cmpeq_epi32(selector, one));
+}
+
+/**
+ * @brief Gathers and decodes 8 texels of BC1 blocks
+ * @param blocks First byte of the block data
+ * @param index Per lane block * 16 + slot
+ * @param mask Lanes to fetch; the others return 0
+ */
+inline __m256i gatherBC1Texels(const uint8_t* blocks, __m256i index, __m256i mask) {
+    const __m256i zero = _mm256_setzero_si256();
+    const int* base = reinterpret_cast<const int*>(blocks);
+    __m256i offset = _mm256_slli_epi32(_mm256_srli_epi32(index, 4), 3);
+    __m256i slot = _mm256_and_si256(index, _mm256_set1_epi32(15));
+    __m256i endpoints = _mm256_mask_i32gather_epi32(zero, base, offset, mask, 1);
+    __m256i selectors = _mm256_mask_i32gather_epi32(zero, base, _mm256_add_epi32(offset, _mm256_set1_epi32(4)), mask, 1);
+    __m256i selector = _mm256_and_si256(_mm256_srlv_epi32(selectors, _mm256_add_epi32(slot, slot)), _mm256_set1_epi32(3));
+    return _mm256_and_si256(decodeBC1Color(endpoints, selector, false), mask);
+}
+
+/**
+ * @brief Gathers and decodes 8 texels of BC3 blocks
+ * @param blocks First byte of the block data
+ * @param index Per lane block * 16 + slot
+ * @param mask Lanes to fetch; the others return 0
+ */
+inline __m256i gatherBC3Texels(const uint8_t* blocks, __m256i index, __m256i mask) {
+    const __m256i zero = _mm256_setzero_si256();
+    const int* base = reinterpret_cast<const int*>(blocks);
+    __m256i offset = _mm256_slli_epi32(_mm256_srli_epi32(index, 4), 4);
+    __m256i slot = _mm256_and_si256(index, _mm256_set1_epi32(15));
+
+    // The 3-bit alpha selector of a slot starts at bit 3 * slot past the endpoints; a 32-bit load from its byte holds it
+    __m256i alphaBit = _mm256_add_epi32(_mm256_add_epi32(slot, slot), slot);
+    __m256i alphaOffset = _mm256_add_epi32(offset, _mm256_add_epi32(_mm256_srli_epi32(alphaBit, 3), _mm256_set1_epi32(2)));
+    __m256i alphaEndpoints = _mm256_mask_i32gather_epi32(zero, base, offset, mask, 1);
+    __m256i alphaSelectors = _mm256_mask_i32gather_epi32(zero, base, alphaOffset, mask, 1);
+    __m256i alphaSelector = _mm256_and_si256(_mm256_srlv_epi32(alphaSelectors, _mm256_and_si256(alphaBit, _mm256_set1_epi32(7))),
+                                             _mm256_set1_epi32(7));
+    __m256i alpha = decodeBC3Alpha(_mm256_and_si256(alphaEndpoints, _mm256_set1_epi32(0xFF)),
+                                   _mm256_and_si256(_mm256_srli_epi32(alphaEndpoints, 8), _mm256_set1_epi32(0xFF)), alphaSelector);
+
+    __m256i colorOffset = _mm256_add_epi32(offset, _mm256_set1_epi32(8));
+    __m256i endpoints = _mm256_mask_i32gather_epi32(zero, base, colorOffset, mask, 1);
+    __m256i selectors = _mm256_mask_i32gather_epi32(zero, base, _mm256_add_epi32(colorOffset, _mm256_set1_epi32(4)), mask, 1);
+    __m256i selector = _mm256_and_si256(_mm256_srlv_epi32(selectors, _mm256_add_epi32(slot, slot)), _mm256_set1_epi32(3));
+    __m256i color = _mm256_and_si256(decodeBC1Color(endpoints, selector, true), _mm256_set1_epi32(0x00FFFFFF));
+    return _mm256_and_si256(_mm256_or_si256(color, _mm256_slli_epi32(alpha, 24)), mask);
+}
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Vertex in homogeneous clip space together with its interpolated attributes
+ */
+struct ClipVertex {
+    float x, y, z, w;       // Clip-space position
+    float u, v;             // Texture coordinates
+    float intensity;        // Lighting intensity
+    float light[3];         // Direction to the light in the space of the normal map
+};
+
+/**
+ * @brief Clipping of primitives in homogeneous clip space
+ *
+ * Primitives are clipped against the near plane and against a guard band
+ * that is GUARD_BAND times larger than the viewport in normalized device
+ * coordinates. Primitives that lie entirely inside the guard band are accepted
+ * as they are; the rasterizers scissor them to the viewport. Only primitives
+ * crossing the near plane or leaving the guard band are actually clipped, which
+ * keeps w > 0 for the perspective divide and screen coordinates bounded.
+ */
+class Clipper {
+public:
+    /**
+     * @brief Outcode bits, one per plane
+     *
+     * The near and guard band planes are the ones primitives get clipped
+     * against; the view frustum planes are only used to reject primitives.
+     */
+    enum Plane : uint16_t {
+        NEAR         = 1 << 0,  // z < -w
+        GUARD_LEFT   = 1 << 1,  // x < -GUARD_BAND * w
+        GUARD_RIGHT  = 1 << 2,  // x >  GUARD_BAND * w
+        GUARD_BOTTOM = 1 << 3,  // y < -GUARD_BAND * w
+        GUARD_TOP    = 1 << 4,  // y >  GUARD_BAND * w
+        FAR          = 1 << 5,  // z >  w
+        LEFT         = 1 << 6,  // x < -w
+        RIGHT        = 1 << 7,  // x >  w
+        BOTTOM       = 1 << 8,  // y < -w
+        TOP          = 1 << 9   // y >  w
+    };
+
+    static constexpr uint16_t CLIP_PLANES = NEAR | GUARD_LEFT | GUARD_RIGHT | GUARD_BOTTOM | GUARD_TOP;
+    static constexpr uint16_t FRUSTUM_PLANES = NEAR | FAR | LEFT | RIGHT | BOTTOM | TOP;
+
+    static constexpr float GUARD_BAND = 4.0f;       // Guard band size relative to the viewport
+    static constexpr int MAX_POLYGON_VERTICES = 8;  // A triangle clipped by all 5 planes has at most 8 vertices
+
+    /**
+     * @brief Computes the outcode of a clip-space position
+     * @return Bitwise OR of the planes the position lies outside of
+     */
+    static uint16_t computeOutcode(float x, float y, float z, float w);
+
+    /**
+     * @brief Clips a convex polygon against the given planes (Sutherland-Hodgman)
+     * @param vertices Polygon vertices, replaced by the clipped polygon; must hold MAX_POLYGON_VERTICES entries
+     * @param count Number of input vertices
+     * @param planes Planes to clip against (usually the OR of the vertex outcodes, only CLIP_PLANES are used)
+     * @return Number of vertices of the clipped polygon (0 if nothing is left)
+     */
+    static int clipPolygon(ClipVertex* vertices, int count, uint16_t planes);
+
+    /**
+     * @brief Clips a line segment against the given planes
+     * @param a First end point, moved onto the clip boundary if needed
+     * @param b Second end point, moved onto the clip boundary if needed
+     * @param planes Planes to clip against (only CLIP_PLANES are used)
+     * @return False if the segment lies completely outside
+     */
+    static bool clipLine(ClipVertex& a, ClipVertex& b, uint16_t planes);
+};
@@ -4,17 +4,29 @@
 #include <vector>
 #include <optional>
 #include "Renderer.h"
+#include "Shaders.h"
 
 struct RendererConfig {
     std::string inputFile;
     std::string textureFile;
+    std::string normalMapFile;
+    NormalSpace normalSpace = NormalSpace::TANGENT;
     std::string outputFile = "output.tga";
     int width = 800;
     int height = 600;
     RenderMode renderMode = RenderMode::WIREFRAME;
+    RasterBackend rasterBackend = RasterBackend::SCANLINE;
+    std::optional<TextureFilter> textureFilter;     // Unset: each texture's own filter
+    std::optional<TextureWrap> textureWrap;         // Unset: each texture's own wrap mode
+    std::optional<TextureFormat> textureFormat;     // Unset: the format the file calls for
+    std::optional<int> textureCacheMiB;             // Unset: TextureLoaderFactory::DEFAULT_CACHE_BUDGET
+    bool meshCache = true;                          // Load models through their .srmesh cache
+    CullMode cullMode = CullMode::BACK;
+    ShaderLook shaderLook = ShaderLook::NONE;
     float cameraX = 0.0f;
     float cameraY = 0.0f;
     float cameraZ = 5.0f;
+    int threads = 0;
     bool generateTestTextures = false;
 };
 
@@ -36,5 +48,12 @@ private:
     std::optional<int> parseIntArg(const std::string& argName);
     std::optional<float> parseFloatArg(const std::string& argName);
     std::optional<RenderMode> parseRenderModeArg(const std::string& argName);
+    std::optional<RasterBackend> parseRasterBackendArg(const std::string& argName);
+    std::optional<TextureFilter> parseTextureFilterArg(const std::string& argName);
+    std::optional<TextureWrap> parseTextureWrapArg(const std::string& argName);
+    std::optional<TextureFormat> parseTextureFormatArg(const std::string& argName);
+    std::optional<NormalSpace> parseNormalSpaceArg(const std::string& argName);
+    std::optional<CullMode> parseCullModeArg(const std::string& argName);
+    std::optional<ShaderLook> parseShaderLookArg(const std::string& argName);
     bool parseBoolArg(const std::string& argName);
 }; 
\ No newline at end of file
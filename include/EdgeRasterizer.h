@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "PixelShading.h"
+#include "ScreenTriangle.h"
+#include "Texture.h"
+#include "TileBinner.h"
+#include "TriangleSetup.h"
+#include "VisibilityBuffer.h"
+
+/**
+ * @brief Half-space triangle rasterizer that processes 8 pixels per step
+ *
+ * Every triangle is described by three edge functions that are evaluated for
+ * a row of 8 pixels at once and stepped incrementally along the row. Coverage,
+ * depth test, evaluation of the attribute planes (TriangleSetup), texel fetch
+ * and the frame buffer write
+ * are all done on 8 lanes under a coverage mask. With AVX2 available this maps
+ * to 256-bit registers; otherwise the same lane loops are compiled as plain C++.
+ * Pixels are sampled at integer coordinates, like the scanline rasterizer.
+ *
+ * Corners are snapped to a 28.4 fixed-point subpixel grid and coverage is
+ * decided with exact integer edge functions and a top-left fill rule, so
+ * triangles sharing an edge never leave cracks and never write a pixel twice.
+ * Attributes are evaluated from their floating-point plane equations.
+ */
+class EdgeRasterizer {
+public:
+    static constexpr int SUBPIXEL_BITS = 4;                     // Fractional bits of the fixed-point positions
+    static constexpr int SUBPIXEL_SCALE = 1 << SUBPIXEL_BITS;   // Subpixel steps per pixel
+
+    /**
+     * @brief Constructor
+     * @param frameBuffer Color buffer to draw into
+     * @param zBuffer Depth buffer used for depth testing
+     * @param width Width of both buffers in pixels
+     */
+    EdgeRasterizer(std::vector<uint32_t>& frameBuffer, std::vector<float>& zBuffer, int width);
+
+    /**
+     * @brief Rounds a screen coordinate to the subpixel grid the rasterizer works on
+     * @param value Screen coordinate in pixels
+     * @return Nearest multiple of 1 / SUBPIXEL_SCALE
+     */
+    static float snapToSubpixel(float value);
+
+    /**
+     * @brief Draws a flat colored triangle without depth testing
+     * @param triangle Screen-space triangle (uses position and color)
+     * @param clip Tile rectangle that limits the written pixels
+     */
+    void drawTriangle(const ScreenTriangle& triangle, const TileRect& clip);
+
+    /**
+     * @brief Draws a flat colored triangle with depth testing
+     * @param triangle Screen-space triangle (uses position and color)
+     * @param setup Attribute planes of the triangle (uses depth)
+     * @param clip Tile rectangle that limits the written pixels
+     */
+    void drawDepthTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup, const TileRect& clip);
+
+    /**
+     * @brief Draws a textured triangle lit with the intensity of its first corner
+     * @param triangle Screen-space triangle
+     * @param setup Attribute planes of the triangle
+     * @param sampler Texture and filter to use
+     * @param clip Tile rectangle that limits the written pixels
+     */
+    void drawTexturedTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                              const TextureSampler& sampler, const TileRect& clip);
+
+    /**
+     * @brief Draws a textured triangle with interpolated per-vertex lighting
+     * @param triangle Screen-space triangle
+     * @param setup Attribute planes of the triangle
+     * @param sampler Texture and filter to use
+     * @param clip Tile rectangle that limits the written pixels
+     */
+    void drawShadedTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                            const TextureSampler& sampler, const TileRect& clip);
+
+    /**
+     * @brief Draws a textured triangle lit per pixel from a normal map
+     * @param triangle Screen-space triangle
+     * @param setup Attribute planes of the triangle (uses the light direction planes)
+     * @param sampler Texture and filter to use
+     * @param normalSampler Normal map, sampled at the same texture coordinates
+     * @param clip Tile rectangle that limits the written pixels
+     */
+    void drawNormalMappedTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup, const TextureSampler& sampler,
+                                  const TextureSampler& normalSampler, const TileRect& clip);
+
+    /**
+     * @brief Depth tests a triangle and records its id instead of a color
+     * @param triangle Screen-space triangle (uses position)
+     * @param setup Attribute planes of the triangle (uses depth)
+     * @param id Triangle id stored for the covered pixels
+     * @param tile Tile buffer receiving the ids
+     * @param clip Tile rectangle that limits the written pixels, and that the tile buffer belongs to
+     */
+    void drawVisibilityTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                                uint32_t id, VisibilityTile& tile, const TileRect& clip);
+
+private:
+    /**
+     * @brief Shading applied to covered pixels
+     */
+    enum class Shading {
+        FLAT,               // Constant color, no depth test
+        FLAT_DEPTH,         // Constant color with depth test
+        TEXTURED,           // Texture modulated by a constant intensity
+        TEXTURED_SHADED,    // Texture modulated by an interpolated intensity
+        NORMAL_MAPPED,      // Texture modulated by the intensity from a normal map and an interpolated light direction
+        VISIBILITY          // Triangle id with depth test, shaded later
+    };
+
+    /**
+     * @brief Shared rasterization loop, specialized per shading at compile time
+     * @param triangle Screen-space triangle
+     * @param setup Attribute planes for depth-tested shadings (null otherwise)
+     * @param sampler Texture and filter for textured shadings (null otherwise)
+     * @param normalSampler Normal map for the normal-mapped shading (null otherwise)
+     * @param id Triangle id for the visibility shading
+     * @param tile Target of the visibility shading (null otherwise)
+     * @param clip Tile rectangle that limits the written pixels
+     */
+    template<Shading S>
+    void rasterize(const ScreenTriangle& triangle, const TriangleSetup* setup, const TextureSampler* sampler,
+                   const TextureSampler* normalSampler, uint32_t id, VisibilityTile* tile, const TileRect& clip);
+
+    std::vector<uint32_t>& frameBuffer;     // Color buffer
+    std::vector<float>& zBuffer;            // Depth buffer
+    int width;                              // Width of the buffers
+};
+
+/**
+ * @brief Integer edge function E(x, y) = a * x + b * y + c of a directed triangle edge
+ *
+ * Positions are in 28.4 fixed point, so E is exact (24.8 fixed point).
+ */
+struct EdgeFunction {
+    int32_t a, b;       // Coefficients (28.4)
+    int64_t c;          // Constant (24.8)
+    int32_t bias;       // 0 if samples exactly on the edge are covered, -1 if not
+
+    int64_t evaluate(int64_t x, int64_t y) const { return a * x + b * y + c; }
+};
+
+/**
+ * @brief Coverage of a triangle snapped to the subpixel grid, shared by the edge and scanline rasterizers
+ *
+ * Holds the three edge functions oriented so that the inside is positive
+ * and biased by the top-left fill rule, so every rasterizer built on it
+ * covers exactly the same pixels: shared edges are drawn once, without
+ * cracks.
+ */
+struct TriangleEdges {
+    EdgeFunction edges[3];          // Edge i lies opposite corner i
+    int minX, minY, maxX, maxY;     // Bounding box in whole pixels, not scissored
+
+    /**
+     * @brief Snaps the corners to the subpixel grid and builds the edge functions
+     * @param triangle Screen-space triangle (uses position)
+     * @return False if the triangle covers no pixels: degenerate, or with a non-finite corner
+     */
+    bool setup(const ScreenTriangle& triangle);
+
+    /**
+     * @brief Finds the covered pixels of a row
+     * @param y Row
+     * @param xStart, xEnd Receive the first and last covered pixel, within the bounding box
+     * @return False if no pixel of the row is covered
+     */
+    bool rowSpan(int y, int& xStart, int& xEnd) const;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Hierarchical depth buffer holding the maximum depth of every 8x8 pixel block
+ *
+ * Sits on top of a flat z-buffer. Depth values in the z-buffer only ever
+ * decrease between clears, so a stored block maximum is always an upper bound
+ * of the real one. Blocks that were drawn into are only marked dirty, and
+ * their maximum is recomputed from the z-buffer when a query cannot be
+ * answered from the stale (conservative) value.
+ *
+ * Blocks never straddle a 64x64 screen tile, so tiles rasterized on
+ * different threads never share a block.
+ */
+class HiZBuffer {
+public:
+    static constexpr int BLOCK_SIZE = 8;    // Block edge length in pixels
+
+    /**
+     * @brief Constructor
+     * @param zBuffer Z-buffer the block maxima are computed from
+     * @param width Width of the z-buffer in pixels
+     * @param height Height of the z-buffer in pixels
+     */
+    HiZBuffer(const std::vector<float>& zBuffer, int width, int height);
+
+    /**
+     * @brief Resets all blocks to infinite depth, to be called whenever the z-buffer is cleared
+     */
+    void clear();
+
+    /**
+     * @brief Checks whether a primitive is hidden behind the existing depth in a pixel rectangle
+     * @param x0, y0 Inclusive top-left pixel of the rectangle
+     * @param x1, y1 Inclusive bottom-right pixel of the rectangle
+     * @param minDepth Smallest depth of the primitive
+     * @return True if no pixel in the rectangle can pass the depth test (z < stored)
+     */
+    bool isOccluded(int x0, int y0, int x1, int y1, float minDepth);
+
+    /**
+     * @brief Marks the blocks of a pixel rectangle as written
+     * @param x0, y0 Inclusive top-left pixel of the rectangle
+     * @param x1, y1 Inclusive bottom-right pixel of the rectangle
+     */
+    void markDirty(int x0, int y0, int x1, int y1);
+
+private:
+    /**
+     * @brief Recomputes the maximum depth of a block from the z-buffer
+     */
+    void refreshBlock(int bx, int by);
+
+    const std::vector<float>& zBuffer;  // Full resolution depth
+    int width;                          // Width of the z-buffer
+    int height;                         // Height of the z-buffer
+    int blocksX;                        // Number of block columns
+    int blocksY;                        // Number of block rows
+    std::vector<float> maxDepth;        // Upper bound of the depth in each block
+    std::vector<uint8_t> dirty;         // Non-zero if the block was written since its last refresh
+};
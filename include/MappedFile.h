@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The pages of the file are mapped into the address space instead of being
+ * copied into a buffer, so parsers can read the file in place and the OS
+ * pages it in as they go. The mapping is released when the object is
+ * destroyed. Empty files map to an empty range.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Maps a file, releasing any previous mapping
+     * @param filename Path to the file
+     * @return True if the file was mapped, false if it cannot be opened or mapped
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Releases the mapping
+     */
+    void close();
+
+    /**
+     * @brief Gets the first byte of the file
+     * @return Pointer to the mapped bytes, null if nothing is mapped
+     */
+    const char* data() const { return bytes; }
+
+    /**
+     * @brief Gets the size of the file
+     * @return Size in bytes
+     */
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;    // Start of the mapping
+    size_t length = 0;              // Size of the file
+#ifdef _WIN32
+    void* mapping = nullptr;        // File mapping object
+#endif
+};
@@ -1,29 +1,98 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
 #include <Eigen/Dense>
-#include <sstream>
 #include "Texture.h"
 
 // Forward declarations
 class Texture;
 
+/**
+ * @brief Space in which a normal map stores its normals
+ */
+enum class NormalSpace {
+    TANGENT,            // Relative to the surface: x along the tangent, y along the bitangent, z along the normal
+    OBJECT              // Model coordinates, independent of the surface
+};
+
 /**
  * @brief Class representing a 3D model loaded from an OBJ file
  */
 class Model {
 public:
     /**
-     * @brief Represents a face in the model (polygon)
+     * @brief Triangle of the model, as indices of its corners in the vertex stream
+     *
+     * Polygons are split into triangles once, when they are set with
+     * setPolygons(), and every index is checked then, so renderers index the
+     * vertex stream without bounds checks. One index gives a corner's
+     * position, texture coordinate and normal.
+     */
+    struct Triangle {
+        uint32_t vertexIndices[3];      // Indices into getVertices(), getTextureCoords() and getNormals()
+    };
+
+    // Bits of getTriangleFlags()
+    static constexpr uint8_t POLYGON_EDGES = 0x07;          // Bit k: the edge from corner k to corner (k + 1) % 3 is on the polygon's outline
+    static constexpr uint8_t HAS_TEXTURE_COORDS = 0x08;     // The corners have texture coordinates
+    static constexpr uint8_t HAS_NORMALS = 0x10;            // The corners have normals
+
+    /**
+     * @brief Polygons as loaders read them, in flat arrays, before triangulation
+     *
+     * Polygon p has the corners starts[p] up to starts[p + 1]. Indices are
+     * 0-based and not yet checked; a corner without a texture coordinate or
+     * normal has -1 there.
+     */
+    struct Polygons {
+        std::vector<uint32_t> starts{0};    // First corner of each polygon, followed by the corner count
+        std::vector<int> vertexIndices;     // Per corner
+        std::vector<int> textureIndices;    // Per corner
+        std::vector<int> normalIndices;     // Per corner
+    };
+
+    /**
+     * @brief Cluster of neighbouring triangles with bounds for coarse culling
+     *
+     * The triangles and vertices of a meshlet are stored as ranges in
+     * getMeshletTriangles() and getMeshletVertices(). The normal cone contains
+     * the normals of all triangles in the meshlet, so a meshlet whose cone
+     * points away from the camera consists of back faces only.
+     */
+    struct Meshlet {
+        uint32_t firstTriangle;     // Offset of the first triangle index in getMeshletTriangles()
+        uint32_t triangleCount;     // Number of triangles in the meshlet
+        uint32_t firstVertex;       // Offset of the first vertex index in getMeshletVertices()
+        uint32_t vertexCount;       // Number of unique vertices used by the triangles
+        Eigen::Vector3f center;     // Bounding sphere center
+        float radius;               // Bounding sphere radius
+        Eigen::Vector3f coneAxis;   // Average triangle normal direction
+        float coneCos;              // Cosine of the cone half-angle (-1 if the normals are too spread to cull)
+        float coneSin;              // Sine of the cone half-angle
+    };
+
+    /**
+     * @brief Per-vertex tangent frames for tangent-space normal mapping, as structure of arrays
+     *
+     * Indexed like getTextureCoords(), that is by vertex; since the frame
+     * follows the texture mapping, a position on a UV seam is split into a
+     * vertex per side, each with its own frame. The tangent points along
+     * increasing u and the bitangent along increasing v; both are averaged
+     * over the triangles sharing the vertex and normalized, but not
+     * orthogonalized against the normal. Vertices without texture
+     * coordinates get zero vectors.
      */
-    struct Face {
-        std::vector<int> vertexIndices;       // Indices for vertices
-        std::vector<int> textureIndices;      // Indices for texture coordinates
-        std::vector<int> normalIndices;       // Indices for normal vectors
+    struct TangentFrames {
+        std::vector<float> tangentX, tangentY, tangentZ;
+        std::vector<float> bitangentX, bitangentY, bitangentZ;
     };
 
+    static constexpr uint32_t MAX_MESHLET_VERTICES = 64;    // Upper bound on unique vertices per meshlet
+    static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;  // Upper bound on triangles per meshlet
+
     Model() = default;
     
     /**
@@ -42,40 +111,190 @@ public:
 
     /**
      * @brief Gets the vertices of the model
+     *
+     * Once polygons are set, the vertices, texture coordinates and normals
+     * form one vertex stream in structure-of-arrays form: element i of each
+     * array belongs to vertex i, a distinct combination of position, texture
+     * coordinate and normal of the model file.
+     *
      * @return Vector of vertices (positions in 3D space)
      */
     const std::vector<Eigen::Vector3f>& getVertices() const { return vertices; }
     
     /**
      * @brief Gets the texture coordinates of the model
-     * @return Vector of texture coordinates
+     * @return One per vertex, zero for vertices without one; empty if no vertex has any
      */
     const std::vector<Eigen::Vector2f>& getTextureCoords() const { return textureCoords; }
     
     /**
      * @brief Gets the normal vectors of the model
-     * @return Vector of normal vectors
+     * @return One per vertex, zero for vertices without one; empty if no vertex has any
      */
     const std::vector<Eigen::Vector3f>& getNormals() const { return normals; }
     
     /**
-     * @brief Gets the faces of the model
-     * @return Vector of faces
+     * @brief Gets which vertices share a position
+     *
+     * Vertices welded from the same position of the model file, which differ
+     * in texture coordinate or normal (as on a texture seam or a hard edge),
+     * have the same id; ids are numbered from 0 without gaps. Used where the
+     * surface matters rather than its attributes, like neighbourhoods.
+     *
+     * @return Position id per vertex
+     */
+    const std::vector<uint32_t>& getPositionIds() const { return positionIds; }
+    
+    /**
+     * @brief Gets the triangles of the model
+     * @return Vector of triangles, with validated indices
+     */
+    const std::vector<Triangle>& getTriangles() const { return triangles; }
+    
+    /**
+     * @brief Gets the flags of each triangle
+     *
+     * The POLYGON_EDGES bits tell which edges of a triangle lie on the outline
+     * of the polygon it was cut from rather than being diagonals added by
+     * triangulation; the wireframe draws only those edges. HAS_TEXTURE_COORDS
+     * and HAS_NORMALS tell whether the corners' entries in getTextureCoords()
+     * and getNormals() hold data.
+     *
+     * @return One entry per triangle
+     */
+    const std::vector<uint8_t>& getTriangleFlags() const { return triangleFlags; }
+    
+    /**
+     * @brief Gets the meshlets of the model, building them first if the triangles changed
+     * @return Vector of meshlets
+     */
+    const std::vector<Meshlet>& getMeshlets() const;
+    
+    /**
+     * @brief Gets the triangle indices of all meshlets, grouped by meshlet
+     * @return Triangle indices referenced by Meshlet::firstTriangle and Meshlet::triangleCount
+     */
+    const std::vector<uint32_t>& getMeshletTriangles() const { getMeshlets(); return meshletTriangles; }
+    
+    /**
+     * @brief Gets the unique vertex indices of all meshlets, grouped by meshlet
+     * @return Vertex indices referenced by Meshlet::firstVertex and Meshlet::vertexCount
      */
-    const std::vector<Face>& getFaces() const { return faces; }
+    const std::vector<uint32_t>& getMeshletVertices() const { getMeshlets(); return meshletVertices; }
+    
+    /**
+     * @brief Splits the triangles into meshlets and computes their bounds
+     *
+     * Called by the loaders once the geometry is complete. Triangles are grouped
+     * by growing each meshlet over triangles that share positions with it, until it
+     * reaches MAX_MESHLET_VERTICES or MAX_MESHLET_TRIANGLES.
+     */
+    void buildMeshlets() const;
+    
+    /**
+     * @brief Gets the tangent frames of the model, building them first if the geometry changed
+     * @return Tangent frames indexed by vertex
+     */
+    const TangentFrames& getTangentFrames() const;
+    
+    /**
+     * @brief Computes the tangent frames from the positions and texture coordinates of the triangles
+     *
+     * Called by the loaders once the geometry is complete, so that rendering
+     * never derives a frame per pixel or per frame. Each triangle adds its
+     * tangent and bitangent, solved from the edges in position and texture
+     * space and weighted by its area, to every corner.
+     */
+    void buildTangentFrames() const;
     
     /**
      * @brief Gets the texture associated with the model
      * @return Pointer to the texture
      */
-    std::shared_ptr<Texture> getTexture() const { return texture; }
+    std::shared_ptr<const Texture> getTexture() const { return texture; }
+    
+    /**
+     * @brief Gets the normal map associated with the model
+     * @return Pointer to the normal map, null if none is set
+     */
+    std::shared_ptr<const Texture> getNormalMap() const { return normalMap; }
+    
+    /**
+     * @brief Gets the space the normals of the normal map are expressed in
+     * @return Normal space of the normal map
+     */
+    NormalSpace getNormalSpace() const { return normalSpace; }
 
     // Setters
-    void setVertices(const std::vector<Eigen::Vector3f>& v) { vertices = v; }
-    void setTextureCoords(const std::vector<Eigen::Vector2f>& tc) { textureCoords = tc; }
-    void setNormals(const std::vector<Eigen::Vector3f>& n) { normals = n; }
-    void setFaces(const std::vector<Face>& f) { faces = f; }
-    void setTexture(std::shared_ptr<Texture> t) { texture = t; }
+    // Taken by value, so that loaders can move freshly built arrays in without a copy
+    void setVertices(std::vector<Eigen::Vector3f> v) { vertices = std::move(v); meshletsDirty = true; tangentsDirty = true; }
+    void setTextureCoords(std::vector<Eigen::Vector2f> tc) { textureCoords = std::move(tc); tangentsDirty = true; }
+    void setNormals(std::vector<Eigen::Vector3f> n) { normals = std::move(n); }
+    
+    /**
+     * @brief Triangulates polygons, welds their corners into the vertex stream and makes them the model's triangles
+     *
+     * Call it after setting the vertices, texture coordinates and normals,
+     * which the polygons index separately, as in a model file. Triangles and
+     * convex polygons are split as a fan around their first corner, other
+     * polygons by ear clipping in the plane of their average normal. Polygons
+     * with fewer than three corners or an index out of range are dropped with
+     * a warning; texture coordinates or normals given for only some corners of
+     * a polygon are ignored for the whole polygon.
+     *
+     * Every distinct (position, texture coordinate, normal) combination used
+     * by a corner then becomes one vertex, numbered in order of first use,
+     * and the vertices, texture coordinates and normals are replaced by the
+     * resulting vertex stream, so a single index per corner reaches all of
+     * its attributes. Elements no corner uses are dropped.
+     *
+     * @param polygons Polygons with 0-based indices into the current arrays
+     */
+    void setPolygons(const Polygons& polygons);
+    
+    /**
+     * @brief Sets triangles of the current vertex stream whose indices have already been validated, such as those of the mesh cache
+     * @param t Triangles, see getTriangles()
+     * @param flags Flags per triangle, see getTriangleFlags()
+     * @param ids Position id per vertex, see getPositionIds()
+     */
+    void setTriangles(std::vector<Triangle> t, std::vector<uint8_t> flags, std::vector<uint32_t> ids) {
+        triangles = std::move(t);
+        triangleFlags = std::move(flags);
+        positionIds = std::move(ids);
+        meshletsDirty = true;
+        tangentsDirty = true;
+    }
+    void setTexture(std::shared_ptr<const Texture> t) { texture = std::move(t); }
+    
+    /**
+     * @brief Restores meshlets built earlier for the current triangles and vertices, instead of building them again
+     *
+     * For loaders of formats that store the meshlets, like the mesh cache;
+     * call it after setting the triangles and vertices.
+     *
+     * @param m Meshlets
+     * @param triangleIndices Triangle indices grouped by meshlet, see getMeshletTriangles()
+     * @param vertexIndices Unique vertex indices grouped by meshlet, see getMeshletVertices()
+     */
+    void setMeshlets(std::vector<Meshlet> m, std::vector<uint32_t> triangleIndices, std::vector<uint32_t> vertexIndices) {
+        meshlets = std::move(m);
+        meshletTriangles = std::move(triangleIndices);
+        meshletVertices = std::move(vertexIndices);
+        meshletsDirty = false;
+    }
+    
+    /**
+     * @brief Restores tangent frames built earlier for the current geometry, instead of building them again
+     *
+     * For loaders of formats that store the frames; call it after setting the
+     * triangles, vertices and texture coordinates.
+     *
+     * @param frames Tangent frames indexed by vertex
+     */
+    void setTangentFrames(TangentFrames frames) { tangentFrames = std::move(frames); tangentsDirty = false; }
+    
+    void setNormalMap(std::shared_ptr<const Texture> map, NormalSpace space) { normalMap = std::move(map); normalSpace = space; }
     
     /**
      * @brief Sets the texture for the model from a file
@@ -85,26 +304,29 @@ public:
     void setTexture(const std::string& texturePath);
     
     // Add data
-    void addVertex(const Eigen::Vector3f& vertex) { vertices.push_back(vertex); }
-    void addTextureCoord(const Eigen::Vector2f& texCoord) { textureCoords.push_back(texCoord); }
+    void addVertex(const Eigen::Vector3f& vertex) { vertices.push_back(vertex); meshletsDirty = true; tangentsDirty = true; }
+    void addTextureCoord(const Eigen::Vector2f& texCoord) { textureCoords.push_back(texCoord); tangentsDirty = true; }
     void addNormal(const Eigen::Vector3f& normal) { normals.push_back(normal); }
-    void addFace(const Face& face) { faces.push_back(face); }
 
 private:
-    // OBJ parsing helper methods
-    void parseVertex(std::istringstream& iss);
-    void parseTextureCoord(std::istringstream& iss);
-    void parseNormal(std::istringstream& iss);
-    void parseFace(std::istringstream& iss);
-    
-    // Face parsing helper methods
-    void parseFaceVertex(const std::string& vertexData, Face& face);
-    int parseIndex(const std::string& indexStr);
-    
     // Data members
     std::vector<Eigen::Vector3f> vertices;      // Vertex positions
     std::vector<Eigen::Vector2f> textureCoords; // Texture coordinates
     std::vector<Eigen::Vector3f> normals;       // Normal vectors
-    std::vector<Face> faces;                    // Faces (polygons)
-    std::shared_ptr<Texture> texture;           // Texture for the model
+    std::vector<uint32_t> positionIds;          // Shared by vertices with the same position
+    std::vector<Triangle> triangles;            // Triangulated polygons
+    std::vector<uint8_t> triangleFlags;         // Polygon outline and attribute flags per triangle
+    std::shared_ptr<const Texture> texture;     // Texture for the model, possibly shared with other models
+    std::shared_ptr<const Texture> normalMap;   // Normal map for the normal-mapped mode
+    NormalSpace normalSpace = NormalSpace::TANGENT; // Space of the normal map's normals
+    
+    // Meshlet data, derived from the triangles and rebuilt when they change
+    mutable std::vector<Meshlet> meshlets;      // Triangle clusters with culling bounds
+    mutable std::vector<uint32_t> meshletTriangles; // Triangle indices, grouped by meshlet
+    mutable std::vector<uint32_t> meshletVertices; // Unique vertex indices, grouped by meshlet
+    mutable bool meshletsDirty = true;          // Triangles or vertices changed since the last build
+    
+    // Tangent frames, derived from the triangles and rebuilt when the geometry changes
+    mutable TangentFrames tangentFrames;        // Per texture coordinate tangent and bitangent
+    mutable bool tangentsDirty = true;          // Triangles, vertices or texture coordinates changed since the last build
 }; 
\ No newline at end of file
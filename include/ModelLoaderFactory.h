@@ -8,6 +8,34 @@ class ModelLoaderFactory {
 public:
     static std::shared_ptr<IModelLoader> createLoader(const std::string& fileExtension);
     static void registerLoader(const std::string& extension, std::shared_ptr<IModelLoader> loader);
+
+    /**
+     * @brief Loads a model with the loader registered for its extension, through the mesh cache
+     *
+     * With the cache enabled, a model file is first looked up as a .srmesh
+     * file next to it (getCachePath), which is used if it was made from the
+     * file's current contents (SRMeshModelLoader::loadCache). Otherwise the
+     * file is loaded by its loader and the cache is written for the next
+     * run; a cache that cannot be written only costs the speedup.
+     *
+     * @param filename Model file
+     * @return The model, or nullptr if no loader handles the extension
+     * @throws std::runtime_error if the loader cannot load the file
+     */
+    static std::shared_ptr<Model> loadModel(const std::string& filename);
+
+    /**
+     * @brief Enables or disables reading and writing the mesh cache in loadModel (enabled by default)
+     */
+    static void setMeshCacheEnabled(bool enabled) { meshCacheEnabled = enabled; }
+    static bool isMeshCacheEnabled() { return meshCacheEnabled; }
+
+    /**
+     * @brief Gets the path of the mesh cache of a model file: the same path with ".srmesh" appended
+     */
+    static std::string getCachePath(const std::string& filename) { return filename + ".srmesh"; }
+
 private:
     static std::unordered_map<std::string, std::shared_ptr<IModelLoader>> loaders;
+    static bool meshCacheEnabled;
 }; 
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "Model.h"
+
+/**
+ * @brief Parser for Wavefront OBJ text, shared by Model::loadFromOBJ and OBJModelLoader
+ *
+ * The file is memory-mapped and tokenized in place: numbers are read with
+ * std::from_chars straight from the mapped bytes, without line strings,
+ * string streams or locale lookups. Large texts are split into chunks at
+ * line boundaries that are parsed concurrently. A first pass counts the v,
+ * vt, vn and f lines of every chunk; the running totals allocate the
+ * geometry arrays once at their final size, tell each chunk where its
+ * elements go, and give the element counts that relative face indices
+ * count back from. The second pass fills the arrays. The faces end up as
+ * flat polygon arrays, which Model::setPolygons validates and triangulates.
+ *
+ * Supported are v (x y z, a w is ignored), vt (u, v defaults to 0), vn and
+ * f with v, v/vt, v//vn or v/vt/vn corners, whose indices may be negative
+ * (relative to the elements defined so far); comments and other statements
+ * are skipped. Malformed v, vt and vn lines become zero vectors, so later
+ * indices keep their meaning, malformed faces are skipped, and both are
+ * counted in a warning.
+ */
+class OBJParser {
+public:
+    /**
+     * @brief Loads an OBJ file into a model, replacing its vertices, texture coordinates, normals and triangles
+     * @param filename Path to the OBJ file
+     * @param model Model receiving the geometry
+     * @param threadCount Threads parsing the file (0 = hardware concurrency)
+     * @return True if the file was read, false if it cannot be opened
+     */
+    static bool loadFile(const std::string& filename, Model& model, unsigned int threadCount = 0);
+
+    /**
+     * @brief Parses OBJ text into a model, replacing its vertices, texture coordinates, normals and triangles
+     * @param data First byte of the text
+     * @param size Length of the text in bytes
+     * @param model Model receiving the geometry
+     * @param threadCount Threads parsing the text (0 = hardware concurrency); texts below a few MiB use fewer
+     */
+    static void parse(const char* data, size_t size, Model& model, unsigned int threadCount = 0);
+};
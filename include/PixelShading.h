@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include "TextureSampler.h"
+#include "TriangleSetup.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Per-pixel texel fetch and lighting shared by the edge-function and visibility buffer paths
+ *
+ * Both paths must produce bit-identical colors, so they use these helpers
+ * instead of their own copies.
+ */
+
+/**
+ * @brief Modulates the RGB channels of a texel by a light intensity
+ */
+inline uint32_t applyLighting(uint32_t color, float intensity) {
+    uint8_t r = static_cast<uint8_t>(std::min(255.0f, ((color >> 16) & 0xFF) * intensity));
+    uint8_t g = static_cast<uint8_t>(std::min(255.0f, ((color >> 8) & 0xFF) * intensity));
+    uint8_t b = static_cast<uint8_t>(std::min(255.0f, (color & 0xFF) * intensity));
+    uint8_t a = static_cast<uint8_t>((color >> 24) & 0xFF);
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+constexpr float NORMAL_MAP_AMBIENT = 0.2f;     // Light intensity of surfaces facing away from the light in the normal-mapped mode
+constexpr float NORMAL_MAP_DIFFUSE = 0.8f;     // Light intensity added by a surface facing the light head-on
+
+/**
+ * @brief Light intensity of a pixel from its normal map texel and the direction to the light
+ *
+ * The RGB channels of the texel hold the x, y and z of the normal, mapped
+ * from [-1, 1] to [0, 255] and expressed in the same space as the light
+ * direction, so the lighting is a single dot product with no per-pixel
+ * change of basis. Interpolation shortens the light direction, so it is
+ * renormalized; the normal is used as filtered.
+ *
+ * @param normalTexel Texel of the normal map
+ * @param lightX, lightY, lightZ Interpolated direction to the light
+ */
+inline float normalMapIntensity(uint32_t normalTexel, float lightX, float lightY, float lightZ) {
+    float normalX = static_cast<float>((normalTexel >> 16) & 0xFF) * (2.0f / 255.0f) - 1.0f;
+    float normalY = static_cast<float>((normalTexel >> 8) & 0xFF) * (2.0f / 255.0f) - 1.0f;
+    float normalZ = static_cast<float>(normalTexel & 0xFF) * (2.0f / 255.0f) - 1.0f;
+    float length = std::sqrt(lightX * lightX + lightY * lightY + lightZ * lightZ);
+    float cosine = (normalX * lightX + normalY * lightY + normalZ * lightZ) / length;
+    return NORMAL_MAP_AMBIENT + NORMAL_MAP_DIFFUSE * std::max(0.0f, cosine);   // std::max keeps 0 for NaN: a zero direction gets the ambient term
+}
+
+/**
+ * @brief Cheap log2 for positive values: the exponent plus the mantissa read as a linear fraction
+ *
+ * Exact at powers of two and at most 0.09 below log2 in between, which is
+ * plenty for picking mip levels and the same in the scalar and SIMD paths.
+ */
+inline float approximateLog2(float x) {
+    int32_t bits = std::bit_cast<int32_t>(x);
+    float exponent = static_cast<float>((bits >> 23) - 127);
+    float mantissa = static_cast<float>(bits & 0x7FFFFF) * (1.0f / 8388608.0f);
+    return exponent + mantissa;
+}
+
+/**
+ * @brief Level of detail of a texture fetch from the screen-space derivatives of its texture coordinates
+ *
+ * The derivatives of u = (u / w) / (1 / w) follow from the attribute planes
+ * by the quotient rule, so no neighbouring pixels are needed. The level is
+ * log2 of the longer texel footprint of a pixel step in x or in y.
+ *
+ * @param uOverW, vOverW, inverseW Attribute planes of the triangle
+ * @param w Interpolated w at the pixel
+ * @param u, v Texture coordinates at the pixel
+ * @param level Full-resolution level of the sampler, whose size scales the footprint
+ */
+inline float textureLod(const AttributePlane& uOverW, const AttributePlane& vOverW, const AttributePlane& inverseW,
+                        float w, float u, float v, const TextureSampler::Level& level) {
+    float width = static_cast<float>(level.width) * w;
+    float height = static_cast<float>(level.height) * w;
+    float dudx = (uOverW.a - u * inverseW.a) * width;
+    float dvdx = (vOverW.a - v * inverseW.a) * height;
+    float dudy = (uOverW.b - u * inverseW.b) * width;
+    float dvdy = (vOverW.b - v * inverseW.b) * height;
+    float footprint = std::max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+    return 0.5f * approximateLog2(footprint);
+}
+
+/**
+ * @brief Samples the texture of a sampler at a pixel, selecting the mip level from the attribute planes
+ * @param sampler Texture bound for the draw
+ * @param uOverW, vOverW, inverseW Attribute planes of the triangle
+ * @param w Interpolated w at the pixel
+ * @param u, v Texture coordinates at the pixel
+ */
+inline uint32_t sampleTexture(const TextureSampler& sampler,
+                              const AttributePlane& uOverW, const AttributePlane& vOverW, const AttributePlane& inverseW,
+                              float w, float u, float v) {
+    if (!sampler.usesMipmaps()) {
+        return sampler.sample(u, v);
+    }
+    return sampler.sample(u, v, textureLod(uOverW, vOverW, inverseW, w, u, v, sampler.getLevel(0)));
+}
+
+#ifdef __AVX2__
+/**
+ * @brief 8-wide approximateLog2
+ */
+inline __m256 approximateLog2(__m256 x) {
+    __m256i bits = _mm256_castps_si256(x);
+    __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srai_epi32(bits, 23), _mm256_set1_epi32(127)));
+    __m256 mantissa = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFF))),
+                                    _mm256_set1_ps(1.0f / 8388608.0f));
+    return _mm256_add_ps(exponent, mantissa);
+}
+
+/**
+ * @brief 8-wide textureLod, the plane coefficients given per lane
+ */
+inline __m256 textureLod(__m256 uA, __m256 uB, __m256 vA, __m256 vB, __m256 wA, __m256 wB,
+                         __m256 w, __m256 u, __m256 v, const TextureSampler::Level& level) {
+    __m256 width = _mm256_mul_ps(_mm256_set1_ps(static_cast<float>(level.width)), w);
+    __m256 height = _mm256_mul_ps(_mm256_set1_ps(static_cast<float>(level.height)), w);
+    __m256 dudx = _mm256_mul_ps(_mm256_sub_ps(uA, _mm256_mul_ps(u, wA)), width);
+    __m256 dvdx = _mm256_mul_ps(_mm256_sub_ps(vA, _mm256_mul_ps(v, wA)), height);
+    __m256 dudy = _mm256_mul_ps(_mm256_sub_ps(uB, _mm256_mul_ps(u, wB)), width);
+    __m256 dvdy = _mm256_mul_ps(_mm256_sub_ps(vB, _mm256_mul_ps(v, wB)), height);
+    __m256 footprint = _mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(dudx, dudx), _mm256_mul_ps(dvdx, dvdx)),
+                                     _mm256_add_ps(_mm256_mul_ps(dudy, dudy), _mm256_mul_ps(dvdy, dvdy)));
+    return _mm256_mul_ps(_mm256_set1_ps(0.5f), approximateLog2(footprint));
+}
+
+/**
+ * @brief Samples the texture of a sampler at 8 pixels, selecting the mip levels from the attribute planes
+ *
+ * The plane gradients are given per lane, so the pixels may belong to different triangles.
+ */
+inline __m256i sampleTexture(const TextureSampler& sampler, __m256 uA, __m256 uB, __m256 vA, __m256 vB,
+                             __m256 wA, __m256 wB, __m256 w, __m256 u, __m256 v, __m256i mask) {
+    if (!sampler.usesMipmaps()) {
+        return sampler.sample(u, v, mask);
+    }
+    return sampler.sample(u, v, textureLod(uA, uB, vA, vB, wA, wB, w, u, v, sampler.getLevel(0)), mask);
+}
+
+/**
+ * @brief 8-wide normalMapIntensity
+ */
+inline __m256 normalMapIntensity(__m256i normalTexels, __m256 lightX, __m256 lightY, __m256 lightZ) {
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256 scale = _mm256_set1_ps(2.0f / 255.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 normalX = _mm256_fmsub_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(normalTexels, 16), byteMask)), scale, one);
+    __m256 normalY = _mm256_fmsub_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(normalTexels, 8), byteMask)), scale, one);
+    __m256 normalZ = _mm256_fmsub_ps(_mm256_cvtepi32_ps(_mm256_and_si256(normalTexels, byteMask)), scale, one);
+
+    __m256 lengthSquared = _mm256_fmadd_ps(lightX, lightX, _mm256_fmadd_ps(lightY, lightY, _mm256_mul_ps(lightZ, lightZ)));
+    __m256 dot = _mm256_fmadd_ps(normalX, lightX, _mm256_fmadd_ps(normalY, lightY, _mm256_mul_ps(normalZ, lightZ)));
+    __m256 cosine = _mm256_div_ps(dot, _mm256_sqrt_ps(lengthSquared));
+
+    // max returns its second operand for NaN, so a zero direction gives the ambient term like the scalar path
+    return _mm256_fmadd_ps(_mm256_set1_ps(NORMAL_MAP_DIFFUSE), _mm256_max_ps(cosine, _mm256_setzero_ps()),
+                           _mm256_set1_ps(NORMAL_MAP_AMBIENT));
+}
+
+/**
+ * @brief Modulates the RGB channels of 8 texels by per-lane light intensities
+ */
+inline __m256i applyLighting(__m256i color, __m256 intensity) {
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256 maxChannel = _mm256_set1_ps(255.0f);
+
+    __m256 r = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(color, 16), byteMask));
+    __m256 g = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(color, 8), byteMask));
+    __m256 b = _mm256_cvtepi32_ps(_mm256_and_si256(color, byteMask));
+
+    __m256i ri = _mm256_cvttps_epi32(_mm256_min_ps(maxChannel, _mm256_mul_ps(r, intensity)));
+    __m256i gi = _mm256_cvttps_epi32(_mm256_min_ps(maxChannel, _mm256_mul_ps(g, intensity)));
+    __m256i bi = _mm256_cvttps_epi32(_mm256_min_ps(maxChannel, _mm256_mul_ps(b, intensity)));
+
+    __m256i alpha = _mm256_and_si256(color, _mm256_set1_epi32(static_cast<int>(0xFF000000)));
+    return _mm256_or_si256(_mm256_or_si256(alpha, _mm256_slli_epi32(ri, 16)),
+                           _mm256_or_si256(_mm256_slli_epi32(gi, 8), bi));
+}
+#endif
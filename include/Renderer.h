@@ -1,11 +1,25 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <Eigen/Dense>
 #include "Model.h"
 #include "Texture.h"
+#include "TextureSampler.h"
+#include "EdgeRasterizer.h"
+#include "HiZBuffer.h"
+#include "ScanlineRasterizer.h"
+#include "ScreenTriangle.h"
+#include "ShaderProgram.h"
+#include "ThreadPool.h"
+#include "TileBinner.h"
+#include "TriangleSetup.h"
+#include "VertexProcessor.h"
+#include "VisibilityBuffer.h"
 
 /**
  * @brief Enum defining different rendering modes
@@ -15,7 +29,52 @@ enum class RenderMode {
     SOLID,              // Solid color rendering
     TEXTURED,           // Textured rendering
     TEXTURED_SHADED,    // Textured with shading
-    COLORFUL            // Colorful rendering
+    COLORFUL,           // Colorful rendering
+    NORMAL_MAPPED       // Textured with per-pixel lighting from a normal map
+};
+
+/**
+ * @brief Enum selecting the rasterization core used for filled triangles
+ */
+enum class RasterBackend {
+    SCANLINE,           // Scanline walkers with per-pixel attribute stepping
+    EDGE,               // Half-space edge functions, 8 pixels per step
+    VISIBILITY          // Edge functions writing triangle ids, textured modes shaded once per pixel afterwards
+};
+
+/**
+ * @brief Enum selecting which triangle facing is culled
+ */
+enum class CullMode {
+    NONE,               // Draw both sides
+    BACK,               // Cull triangles wound clockwise on screen
+    FRONT               // Cull triangles wound counter-clockwise on screen
+};
+
+/**
+ * @brief Number of triangles removed by each test of the culling stage
+ */
+struct CullStats {
+    size_t triangles = 0;       // Triangles entering the culling stage
+    size_t frustum = 0;         // Completely outside one of the view frustum planes
+    size_t backface = 0;        // Facing away according to the cull mode
+    size_t zeroArea = 0;        // No area left in screen space
+    size_t occluded = 0;        // Triangle-tile pairs rejected by the hierarchical z-buffer
+    size_t meshlets = 0;        // Meshlets entering the culling stage
+    size_t meshletFrustum = 0;  // Meshlets whose bounding sphere is outside the view frustum
+    size_t meshletBackface = 0; // Meshlets whose normal cone faces away according to the cull mode
+    
+    CullStats& operator+=(const CullStats& other) {
+        meshlets += other.meshlets;
+        meshletFrustum += other.meshletFrustum;
+        meshletBackface += other.meshletBackface;
+        triangles += other.triangles;
+        frustum += other.frustum;
+        backface += other.backface;
+        zeroArea += other.zeroArea;
+        occluded += other.occluded;
+        return *this;
+    }
 };
 
 /**
@@ -53,12 +112,79 @@ public:
      */
     void setRenderMode(RenderMode mode);
     
+    /**
+     * @brief Sets the number of threads used for binning and tile rasterization
+     * @param threadCount Number of threads (0 = hardware concurrency)
+     */
+    void setThreadCount(unsigned int threadCount);
+    
+    /**
+     * @brief Sets the rasterization core used for filled triangles
+     * @param backend Rasterizer backend
+     */
+    void setRasterBackend(RasterBackend backend);
+    
+    /**
+     * @brief Overrides how the textured modes sample the texture
+     * @param filter Texture filter for every texture, or nullopt to use each texture's own filter
+     */
+    void setTextureFilter(std::optional<TextureFilter> filter);
+    
+    /**
+     * @brief Overrides how the textured modes wrap texture coordinates outside [0, 1)
+     * @param wrap Wrap mode for every texture, or nullopt to use each texture's own wrap mode
+     */
+    void setTextureWrap(std::optional<TextureWrap> wrap);
+    
+    /**
+     * @brief Binds a texture for a draw, applying the filter and wrap overrides
+     * @param texture Texture to sample, null for opaque black
+     * @return Sampler to hand to the rasterizers and shaders of the draw
+     */
+    TextureSampler bindSampler(const Texture* texture) const;
+    
+    /**
+     * @brief Sets which triangle facing is culled in the filled modes
+     * @param mode Cull mode
+     */
+    void setCullMode(CullMode mode);
+    
+    /**
+     * @brief Gets the culling statistics of the last rendered frame
+     * @return Culling statistics
+     */
+    const CullStats& getCullStats() const { return cullStats; }
+    
+    /**
+     * @brief Gets the number of threads used for rendering
+     * @return Thread count
+     */
+    unsigned int getThreadCount() const { return threadPool ? threadPool->getThreadCount() : ThreadPool::resolveThreadCount(threadCount); }
+    
     /**
      * @brief Renders a model
      * @param model Model to render
      */
     void render(const Model& model);
     
+    /**
+     * @brief Renders a model with a shader program instead of the render mode
+     *
+     * The vertex shader runs once per visible vertex (once per face corner
+     * for faces without normals, which are lit by their face normal) and the
+     * fragment shader once per depth-tested pixel; both are inlined into the
+     * pipeline, so a custom look runs as fast as a built-in mode. Culling,
+     * clipping, binning and the hierarchical z-buffer work as in the filled
+     * modes. Programs are drawn by the scanline rasterizer whatever the
+     * selected backend, since the edge-function paths are specialized per mode.
+     *
+     * @param model Model to render
+     * @param vertexShader Computes the varyings of each vertex
+     * @param fragmentShader Computes the color of each pixel from the interpolated varyings
+     */
+    template<VertexShader VS, FragmentShader<typename VS::Varyings> FS>
+    void renderProgram(const Model& model, const VS& vertexShader, const FS& fragmentShader);
+    
     /**
      * @brief Clears the frame buffer
      * @param color Color to clear with
@@ -85,11 +211,124 @@ public:
     int getHeight() const { return height; }
 
 private:
+    static constexpr size_t TRIANGLES_PER_CHUNK = 4096;    // Triangles set up and binned by one task
+    static constexpr size_t VERTICES_PER_CHUNK = 16384;   // Vertices a shader program runs on in one task
+
+    /**
+     * @brief Screen-space line produced by the wireframe setup stage
+     */
+    struct ScreenLine {
+        int x0, y0;                 // First end point
+        int x1, y1;                 // Second end point
+        uint32_t color;             // Line color
+    };
+
     /**
      * @brief Updates the view matrix based on camera position and target
      */
     void updateViewMatrix();
 
+    /**
+     * @brief Culls whole meshlets and collects the triangles and vertices of the visible ones
+     *
+     * Meshlets whose bounding sphere lies outside the view frustum, or whose
+     * normal cone faces away from the camera according to the cull mode, are
+     * rejected before any per-vertex work. The triangles of the remaining meshlets
+     * are gathered into visibleTriangles and their vertices are marked in vertexMask.
+     *
+     * @param model Model whose meshlets are culled
+     * @param mvp Model-view-projection matrix
+     * @param coneCulling Whether the normal cones are tested (off for see-through modes)
+     */
+    void cullMeshlets(const Model& model, const Eigen::Matrix4f& mvp, bool coneCulling);
+
+    /**
+     * @brief Runs the per-frame stages that precede triangle setup: meshlet culling and vertex processing
+     * @param model Model to render
+     * @param coneCulling Whether the normal cones are tested (off for see-through modes)
+     */
+    void prepareFrame(const Model& model, bool coneCulling);
+
+    /**
+     * @brief Logs the frame time and the culling statistics of the frame
+     * @param startTime Time at which the frame started
+     */
+    void logFrame(std::chrono::steady_clock::time_point startTime) const;
+
+    /**
+     * @brief Runs a setup function over the visible triangles in parallel chunks and bins the results
+     * @param setup Callable invoked as setup(chunk, triangleIndex) that submits primitives
+     */
+    template<typename SetupFunction>
+    void binTriangles(SetupFunction&& setup);
+
+    /**
+     * @brief Culls a triangle, positions it from the vertex cache, clips it if needed and records it
+     *
+     * This is the culling stage shared by all filled modes: triangles completely
+     * outside the view frustum are rejected by their vertex outcodes, back (or
+     * front) faces by the sign of their homogeneous determinant, and triangles
+     * without area in screen space after positioning. Triangles inside the guard
+     * band use the cached screen positions directly; triangles crossing the near
+     * plane or the guard band are clipped in homogeneous space and the resulting
+     * polygon is recorded as a triangle fan.
+     *
+     * @param chunk Chunk of the model triangle that produced the triangle
+     * @param i0, i1, i2 Model vertex indices of the corners
+     * @param triangle Triangle whose attributes (u, v, intensity, color) are already set up
+     */
+    void submitTriangle(size_t chunk, int i0, int i1, int i2, ScreenTriangle triangle);
+
+    /**
+     * @brief Positions a line from the vertex cache, clips it if needed and records it
+     * @param chunk Chunk of the model triangle that produced the line
+     * @param i0, i1 Model vertex indices of the end points
+     * @param color Line color
+     */
+    void submitLine(size_t chunk, int i0, int i1, uint32_t color);
+
+    /**
+     * @brief Records a screen-space triangle for tile rasterization
+     * @param chunk Chunk of the model triangle that produced the triangle
+     * @param triangle Screen-space triangle
+     */
+    void binTriangle(size_t chunk, const ScreenTriangle& triangle);
+
+    /**
+     * @brief Records a screen-space line for tile rasterization
+     * @param chunk Chunk of the model triangle that produced the line
+     * @param line Screen-space line
+     */
+    void binLine(size_t chunk, const ScreenLine& line);
+
+    /**
+     * @brief Rasterizes all binned primitives, processing tiles in parallel
+     * @param mode Mode whose rasterization routine is used for the primitives
+     * @param texture Texture for textured modes (may be null otherwise)
+     * @param normalMap Normal map for the normal-mapped mode (may be null otherwise)
+     */
+    void rasterizeTiles(RenderMode mode, const Texture* texture, const Texture* normalMap = nullptr);
+
+    /**
+     * @brief Rasterizes all binned triangles of a shader program with the scanline rasterizer
+     * @tparam Varyings Scanline varyings of the program (see ProgramVaryings)
+     * @param fragmentShader Fragment shader passed to Varyings::shade
+     */
+    template<typename Varyings, typename FS>
+    void rasterizeProgramTiles(const FS& fragmentShader);
+
+    /**
+     * @brief Tests a triangle against the hierarchical z-buffer inside one tile
+     *
+     * A triangle that is not rejected marks the blocks it may write as dirty.
+     *
+     * @param tile Tile being rasterized
+     * @param triangle Screen-space triangle
+     * @param clip Rectangle of the tile
+     * @return True if the triangle lies behind every block it touches in the tile
+     */
+    bool isOccludedInTile(size_t tile, const ScreenTriangle& triangle, const TileRect& clip);
+
     /**
      * @brief Renders a model in wireframe mode
      * @param model Model to render
@@ -121,86 +360,24 @@ private:
     void renderTexturedShaded(const Model& model);
     
     /**
-     * @brief Draws a textured triangle
-     * @param x0, y0, z0 Coordinates of the first vertex
-     * @param u0, v0 Texture coordinates of the first vertex
-     * @param x1, y1, z1 Coordinates of the second vertex
-     * @param u1, v1 Texture coordinates of the second vertex
-     * @param x2, y2, z2 Coordinates of the third vertex
-     * @param u2, v2 Texture coordinates of the third vertex
-     * @param lightIntensity Intensity of the light
-     * @param texture Texture to use
-     */
-    void renderTexturedTriangle(
-        int x0, int y0, float z0, float u0, float v0,
-        int x1, int y1, float z1, float u1, float v1,
-        int x2, int y2, float z2, float u2, float v2,
-        float lightIntensity, const Texture& texture);
-    
-    /**
-     * @brief Draws a shaded textured triangle with per-vertex lighting
-     * @param x0, y0, z0 Coordinates of the first vertex
-     * @param u0, v0 Texture coordinates of the first vertex
-     * @param i0 Light intensity at the first vertex
-     * @param x1, y1, z1 Coordinates of the second vertex
-     * @param u1, v1 Texture coordinates of the second vertex
-     * @param i1 Light intensity at the second vertex
-     * @param x2, y2, z2 Coordinates of the third vertex
-     * @param u2, v2 Texture coordinates of the third vertex
-     * @param i2 Light intensity at the third vertex
-     * @param texture Texture to use
-     */
-    void renderShadedTriangle(
-        int x0, int y0, float z0, float u0, float v0, float i0,
-        int x1, int y1, float z1, float u1, float v1, float i1,
-        int x2, int y2, float z2, float u2, float v2, float i2,
-        const Texture& texture);
-    
-    /**
-     * @brief Draws textured scanlines for triangle rasterization
-     * @param yStart, yEnd Start and end Y coordinates
-     * @param xLeft, dxLeft Left edge X and its increment
-     * @param xRight, dxRight Right edge X and its increment
-     * @param zLeft, dzLeft Left edge Z and its increment
-     * @param zRight, dzRight Right edge Z and its increment
-     * @param uLeft, duLeft Left edge U and its increment
-     * @param uRight, duRight Right edge U and its increment
-     * @param vLeft, dvLeft Left edge V and its increment
-     * @param vRight, dvRight Right edge V and its increment
-     * @param lightIntensity Intensity of the light
-     * @param texture Texture to use
-     */
-    void drawTexturedScanlines(
-        int yStart, int yEnd,
-        float xLeft, float dxLeft, float xRight, float dxRight,
-        float zLeft, float dzLeft, float zRight, float dzRight,
-        float uLeft, float duLeft, float uRight, float duRight,
-        float vLeft, float dvLeft, float vRight, float dvRight,
-        float lightIntensity, const Texture& texture);
-        
+     * @brief Renders a model textured and lit per pixel from its normal map
+     *
+     * The direction to the light is brought into the space of the normal map
+     * once per face corner: the model space for object-space maps, the
+     * corner's tangent frame (Model::getTangentFrames(), orthonormalized
+     * against the corner normal) for tangent-space maps. The rasterizers
+     * interpolate it, so lighting a pixel is one dot product with the
+     * fetched normal.
+     *
+     * @param model Model to render
+     */
+    void renderNormalMapped(const Model& model);
+    
     /**
-     * @brief Draws shaded textured scanlines with per-vertex lighting interpolation
-     * @param yStart, yEnd Start and end Y coordinates
-     * @param xLeft, dxLeft Left edge X and its increment
-     * @param xRight, dxRight Right edge X and its increment
-     * @param zLeft, dzLeft Left edge Z and its increment
-     * @param zRight, dzRight Right edge Z and its increment
-     * @param uLeft, duLeft Left edge U and its increment
-     * @param uRight, duRight Right edge U and its increment
-     * @param vLeft, dvLeft Left edge V and its increment
-     * @param vRight, dvRight Right edge V and its increment
-     * @param iLeft, diLeft Left edge lighting intensity and its increment
-     * @param iRight, diRight Right edge lighting intensity and its increment
-     * @param texture Texture to use
-     */
-    void drawShadedScanlines(
-        int yStart, int yEnd,
-        float xLeft, float dxLeft, float xRight, float dxRight,
-        float zLeft, float dzLeft, float zRight, float dzRight,
-        float uLeft, float duLeft, float uRight, float duRight,
-        float vLeft, float dvLeft, float vRight, float dvRight,
-        float iLeft, float diLeft, float iRight, float diRight,
-        const Texture& texture);
+     * @brief Gets the rendering thread pool, starting it with the requested thread count on first use
+     * @return Thread pool
+     */
+    ThreadPool& getThreadPool();
     
     /**
      * @brief Draws a line between two points
@@ -209,64 +386,18 @@ private:
      * @param x1 X coordinate of the second point
      * @param y1 Y coordinate of the second point
      * @param color Color of the line
+     * @param clip Tile rectangle that limits the written pixels
      */
-    void drawLine(int x0, int y0, int x1, int y1, uint32_t color);
-    
-    /**
-     * @brief Draws a triangle
-     * @param x0 X coordinate of the first vertex
-     * @param y0 Y coordinate of the first vertex
-     * @param x1 X coordinate of the second vertex
-     * @param y1 Y coordinate of the second vertex
-     * @param x2 X coordinate of the third vertex
-     * @param y2 Y coordinate of the third vertex
-     * @param color Color of the triangle
-     */
-    void drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color);
+    void drawLine(int x0, int y0, int x1, int y1, uint32_t color, const TileRect& clip);
     
     /**
      * @brief Sets a pixel in the frame buffer
      * @param x X coordinate
      * @param y Y coordinate
      * @param color Color of the pixel
+     * @param clip Tile rectangle outside of which the pixel is dropped
      */
-    void setPixel(int x, int y, uint32_t color);
-
-    /**
-     * @brief Helper struct for vertex data with position
-     */
-    struct Vertex {
-        float x, y, z;
-    };
-
-    /**
-     * @brief Draws a triangle with z-buffer support
-     * @param v0 First vertex
-     * @param v1 Second vertex
-     * @param v2 Third vertex
-     * @param color Color of the triangle
-     */
-    void drawTriangle(Vertex v0, Vertex v1, Vertex v2, uint32_t color);
-
-    /**
-     * @brief Draws scanlines for triangle rasterization with z-buffer support
-     * @param yStart Start Y coordinate
-     * @param yEnd End Y coordinate 
-     * @param xLeft Left edge X
-     * @param dxLeft Left edge X increment
-     * @param xRight Right edge X
-     * @param dxRight Right edge X increment
-     * @param zLeft Left edge Z
-     * @param dzLeft Left edge Z increment
-     * @param zRight Right edge Z
-     * @param dzRight Right edge Z increment
-     * @param color Color to draw
-     */
-    void drawScanline(
-        int yStart, int yEnd,
-        float xLeft, float dxLeft, float xRight, float dxRight,
-        float zLeft, float dzLeft, float zRight, float dzRight,
-        uint32_t color);
+    void setPixel(int x, int y, uint32_t color, const TileRect& clip);
 
     /**
      * @brief Generates a random color
@@ -288,4 +419,153 @@ private:
     Eigen::Matrix4f projectionMatrix;   // Projection matrix
     
     RenderMode renderMode;              // Current rendering mode
-}; 
\ No newline at end of file
+    RasterBackend rasterBackend;        // Current rasterizer backend
+    std::optional<TextureFilter> textureFilter; // Filter override of the textured modes
+    std::optional<TextureWrap> textureWrap;     // Wrap mode override of the textured modes
+    CullMode cullMode;                  // Current triangle facing to cull
+    CullStats cullStats;                // Culling statistics of the last frame
+    
+    unsigned int threadCount;                                   // Requested rendering threads (0 = hardware concurrency)
+    std::unique_ptr<ThreadPool> threadPool;                     // Workers for binning and tile rasterization, started by the first render
+    VertexProcessor vertexProcessor;                            // Post-transform cache of the model vertices
+    std::vector<uint32_t> visibleTriangles;                     // Triangles of the meshlets that survived culling
+    std::vector<uint8_t> vertexMask;                            // Non-zero for vertices used by visible meshlets
+    TileBinner binner;                                          // Assigns primitives to screen tiles
+    ScanlineRasterizer scanlineRasterizer;                      // Depth-tested scanline backend writing into the buffers above
+    EdgeRasterizer edgeRasterizer;                              // Edge-function backend writing into the buffers above
+    std::vector<std::vector<ScreenTriangle>> binnedTriangles;   // Triangles of the current frame, per chunk
+    std::vector<std::vector<TriangleSetup>> binnedSetups;       // Attribute planes of the binned triangles, per chunk
+    std::vector<std::vector<ScreenLine>> binnedLines;           // Lines of the current frame, per chunk
+    std::vector<CullStats> chunkCullStats;                      // Culling statistics of the current frame, per chunk
+    HiZBuffer hiZBuffer;                                        // Per-block maximum depth over the z-buffer
+    std::vector<size_t> tileOccluded;                           // Triangles rejected by the hierarchical z-buffer, per tile
+    std::unique_ptr<VisibilityBuffer> visibilityBuffer;         // Per-pixel triangle ids, created for the visibility backend
+};
+
+template<typename SetupFunction>
+void Renderer::binTriangles(SetupFunction&& setup) {
+    size_t triangleCount = visibleTriangles.size();
+    size_t chunkCount = (triangleCount + TRIANGLES_PER_CHUNK - 1) / TRIANGLES_PER_CHUNK;
+    
+    binner.reset(chunkCount);
+    binnedTriangles.resize(chunkCount);
+    binnedSetups.resize(chunkCount);
+    binnedLines.resize(chunkCount);
+    chunkCullStats.assign(chunkCount, CullStats());
+    
+    // Each chunk sets up its triangles into its own primitive lists, so no locking is needed
+    getThreadPool().parallelFor(chunkCount, [&](size_t chunk) {
+        binnedTriangles[chunk].clear();
+        binnedSetups[chunk].clear();
+        binnedLines[chunk].clear();
+        
+        size_t begin = chunk * TRIANGLES_PER_CHUNK;
+        size_t end = std::min(triangleCount, begin + TRIANGLES_PER_CHUNK);
+        for (size_t i = begin; i < end; ++i) {
+            setup(chunk, visibleTriangles[i]);
+        }
+        
+        binner.finishChunk(chunk);
+    });
+    
+    for (const auto& stats : chunkCullStats) {
+        cullStats += stats;
+    }
+}
+
+template<VertexShader VS, FragmentShader<typename VS::Varyings> FS>
+void Renderer::renderProgram(const Model& model, const VS& vertexShader, const FS& fragmentShader) {
+    auto startTime = std::chrono::steady_clock::now();
+    prepareFrame(model, true);
+    
+    const auto& vertices = model.getVertices();
+    const auto& triangles = model.getTriangles();
+    const auto& textureCoords = model.getTextureCoords();
+    const auto& normals = model.getNormals();
+    const auto& triangleFlags = model.getTriangleFlags();
+    
+    // Corners with a normal of their own get the same inputs from every triangle sharing their vertex, so the
+    // vertex shader runs once per visible vertex for them, alongside the position transform
+    std::vector<typename VS::Varyings> vertexVaryings(normals.empty() ? 0 : vertices.size());
+    size_t chunkCount = (vertexVaryings.size() + VERTICES_PER_CHUNK - 1) / VERTICES_PER_CHUNK;
+    getThreadPool().parallelFor(chunkCount, [&](size_t chunk) {
+        size_t begin = chunk * VERTICES_PER_CHUNK;
+        size_t end = std::min(vertexVaryings.size(), begin + VERTICES_PER_CHUNK);
+        for (size_t v = begin; v < end; ++v) {
+            if (!vertexMask[v]) {
+                continue;
+            }
+            VertexInput input;
+            input.index = static_cast<int>(v);
+            input.position = vertices[v];
+            input.normal = normals[v].normalized();
+            input.texCoord = Eigen::Vector2f::Zero();
+            if (!textureCoords.empty()) {
+                input.texCoord = Eigen::Vector2f(textureCoords[v].x(), 1.0f - textureCoords[v].y());
+            }
+            vertexVaryings[v] = vertexShader(input);
+        }
+    });
+    
+    // Carry the varyings of each corner in the attribute slots, running the vertex shader for corners lit by their face normal
+    binTriangles([&](size_t chunk, size_t triangleIndex) {
+        const auto& face = triangles[triangleIndex];
+        const auto& vertexIndices = face.vertexIndices;
+        
+        const bool hasNormals = triangleFlags[triangleIndex] & Model::HAS_NORMALS;
+        const bool hasTextureCoords = triangleFlags[triangleIndex] & Model::HAS_TEXTURE_COORDS;
+        ScreenTriangle triangle;
+        if (hasNormals && (hasTextureCoords || textureCoords.empty())) {
+            for (int k = 0; k < 3; ++k) {
+                storeVaryings(vertexVaryings[vertexIndices[k]], triangle, k);
+            }
+            submitTriangle(chunk, vertexIndices[0], vertexIndices[1], vertexIndices[2], triangle);
+            return;
+        }
+        
+        Eigen::Vector3f faceNormal = Eigen::Vector3f::Zero();
+        if (!hasNormals) {
+            const Eigen::Vector3f& v0 = vertices[vertexIndices[0]];
+            faceNormal = (vertices[vertexIndices[1]] - v0).cross(vertices[vertexIndices[2]] - v0).normalized();
+        }
+        
+        for (int k = 0; k < 3; ++k) {
+            VertexInput input;
+            input.index = vertexIndices[k];
+            input.position = vertices[vertexIndices[k]];
+            input.normal = hasNormals ? normals[vertexIndices[k]].normalized() : faceNormal;
+            input.texCoord = Eigen::Vector2f::Zero();
+            if (hasTextureCoords) {
+                const Eigen::Vector2f& t = textureCoords[vertexIndices[k]];
+                input.texCoord = Eigen::Vector2f(t.x(), 1.0f - t.y());
+            }
+            storeVaryings(vertexShader(input), triangle, k);
+        }
+        
+        submitTriangle(chunk, vertexIndices[0], vertexIndices[1], vertexIndices[2], triangle);
+    });
+    
+    rasterizeProgramTiles<ProgramVaryings<typename VS::Varyings>>(fragmentShader);
+    
+    logFrame(startTime);
+}
+
+template<typename Varyings, typename FS>
+void Renderer::rasterizeProgramTiles(const FS& fragmentShader) {
+    tileOccluded.assign(binner.getTileCount(), 0);
+    
+    getThreadPool().parallelFor(binner.getTileCount(), [&](size_t tile) {
+        TileRect clip = binner.getTileRect(static_cast<int>(tile));
+        binner.forEachPrimitive(static_cast<int>(tile), [&](size_t chunk, uint32_t index) {
+            const ScreenTriangle& t = binnedTriangles[chunk][index];
+            if (isOccludedInTile(tile, t, clip)) {
+                return;
+            }
+            scanlineRasterizer.drawTriangle<Varyings>(t, binnedSetups[chunk][index], fragmentShader, clip);
+        });
+    });
+    
+    for (size_t occluded : tileOccluded) {
+        cullStats.occluded += occluded;
+    }
+}
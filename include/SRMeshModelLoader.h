@@ -0,0 +1,69 @@
+#pragma once
+#include "IModelLoader.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Loads and writes the binary .srmesh format, a ready-to-use copy of a loaded model
+ *
+ * A .srmesh file stores what a model holds after loading: the welded
+ * vertex stream (positions, texture coordinates, normals and position ids),
+ * the triangles with their flags, and the data derived from them at load
+ * time (meshlets and tangent frames).
+ * It is written next to a source model as a cache, so later runs skip
+ * parsing and building; see ModelLoaderFactory::loadModel.
+ *
+ * Layout, in the byte order of the writing machine:
+ * - a fixed header: magic "SRMESH", format version, byte order mark, the
+ *   size, modification time and hash of the source file it was made from,
+ *   and an offset and byte count for every section
+ * - the sections, each a flat array starting at a multiple of 64 bytes:
+ *   positions (3 floats), texture coordinates (2 floats), normals
+ *   (3 floats), position ids (uint32), each one per vertex or, for texture
+ *   coordinates and normals, empty; the triangles (Model::Triangle, 3 uint32
+ *   vertex indices each), their flags (one byte each), the meshlets, their
+ *   triangle and vertex indices (uint32), and the six tangent frame arrays
+ *   (floats, one value per vertex each, if there are texture coordinates)
+ *
+ * Loading maps the file, checks the header and the section bounds, and
+ * copies the arrays straight from the mapping into the model; nothing is
+ * parsed, triangulated, welded or rebuilt, but every index is range-checked. Files of another version or byte order are rejected.
+ */
+class SRMeshModelLoader : public IModelLoader {
+public:
+    /**
+     * @brief Loads a .srmesh file, without checking it against its source
+     * @throws std::runtime_error if the file cannot be opened or is not a valid .srmesh file
+     */
+    std::shared_ptr<Model> loadModel(const std::string& filename) override;
+
+    /**
+     * @brief Loads a .srmesh cache if it was made from the current contents of its source file
+     *
+     * The cache is current if the source has the size and modification time
+     * recorded in it. If only the time differs, the source is hashed and the
+     * cache is still used when the hash matches, recording the new time so
+     * that the next check is quick again.
+     *
+     * @param cacheFile Path to the .srmesh file
+     * @param sourceFile Path to the model file the cache was made from
+     * @return The model, or nullptr if there is no valid, current cache
+     */
+    static std::shared_ptr<Model> loadCache(const std::string& cacheFile, const std::string& sourceFile);
+
+    /**
+     * @brief Writes a model as a .srmesh file, building its meshlets and tangent frames if needed
+     *
+     * The file is written under a temporary name unique to the call and then
+     * renamed, so a concurrent reader never sees it half written and
+     * concurrent writers never write into the same file.
+     *
+     * @param model Model to store
+     * @param filename Path to the .srmesh file
+     * @param sourceFile Model file the data comes from, recorded for loadCache (empty: none)
+     * @return True if the file was written
+     */
+    static bool saveModel(const Model& model, const std::string& filename, const std::string& sourceFile);
+
+    static constexpr uint32_t FORMAT_VERSION = 3;   // Incremented whenever the layout changes
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "EdgeRasterizer.h"
+#include "PixelShading.h"
+#include "ScreenTriangle.h"
+#include "Texture.h"
+#include "TileBinner.h"
+#include "TriangleSetup.h"
+
+/**
+ * @brief Interpolants of the colorful mode: depth only, the color is flat
+ *
+ * A varyings struct is what the scanline rasterizer carries from pixel to
+ * pixel along a span. It provides:
+ * - float z: depth for the depth test
+ * - static at(setup, dx, dy): the values at an offset from the setup's origin
+ * - static gradient(setup): the change per pixel in x
+ * - step(gradient): advances to the next pixel
+ * - shade(triangle, setup, context): the color of the current pixel, given
+ *   the per-draw context passed to drawTriangle (the texture sampler for the
+ *   built-in modes, the fragment shader for shader programs)
+ * - optionally static constexpr bool DEPTH_TEST: false to draw without
+ *   reading or writing the depth buffer (true if absent)
+ */
+struct DepthVaryings {
+    float z;
+
+    static DepthVaryings at(const TriangleSetup& setup, float dx, float dy) {
+        return { setup.depth.at(dx, dy) };
+    }
+
+    static DepthVaryings gradient(const TriangleSetup& setup) {
+        return { setup.depth.a };
+    }
+
+    void step(const DepthVaryings& gradient) {
+        z += gradient.z;
+    }
+
+    uint32_t shade(const ScreenTriangle& triangle, const TriangleSetup&, const TextureSampler&) const {
+        return triangle.color;
+    }
+};
+
+/**
+ * @brief Interpolants of the solid mode: none, the color is flat and drawn without depth test
+ */
+struct FlatVaryings {
+    static constexpr bool DEPTH_TEST = false;
+
+    static FlatVaryings at(const TriangleSetup&, float, float) {
+        return {};
+    }
+
+    static FlatVaryings gradient(const TriangleSetup&) {
+        return {};
+    }
+
+    void step(const FlatVaryings&) {
+    }
+
+    uint32_t shade(const ScreenTriangle& triangle, const TriangleSetup&, const TextureSampler&) const {
+        return triangle.color;
+    }
+};
+
+/**
+ * @brief Interpolants of the textured mode: perspective-correct texture coordinates, flat lighting
+ */
+struct TexturedVaryings {
+    float z, inverseW, uOverW, vOverW;
+
+    static TexturedVaryings at(const TriangleSetup& setup, float dx, float dy) {
+        return { setup.depth.at(dx, dy), setup.inverseW.at(dx, dy),
+                 setup.uOverW.at(dx, dy), setup.vOverW.at(dx, dy) };
+    }
+
+    static TexturedVaryings gradient(const TriangleSetup& setup) {
+        return { setup.depth.a, setup.inverseW.a, setup.uOverW.a, setup.vOverW.a };
+    }
+
+    void step(const TexturedVaryings& gradient) {
+        z += gradient.z;
+        inverseW += gradient.inverseW;
+        uOverW += gradient.uOverW;
+        vOverW += gradient.vOverW;
+    }
+
+    uint32_t shade(const ScreenTriangle& triangle, const TriangleSetup& setup, const TextureSampler& sampler) const {
+        float w = 1.0f / inverseW;
+        uint32_t texel = sampleTexture(sampler, setup.uOverW, setup.vOverW, setup.inverseW, w, uOverW * w, vOverW * w);
+        return applyLighting(texel, triangle.intensity[0]);
+    }
+};
+
+/**
+ * @brief Interpolants of the shaded mode: perspective-correct texture coordinates and light intensity
+ */
+struct ShadedVaryings {
+    float z, inverseW, uOverW, vOverW, intensityOverW;
+
+    static ShadedVaryings at(const TriangleSetup& setup, float dx, float dy) {
+        return { setup.depth.at(dx, dy), setup.inverseW.at(dx, dy),
+                 setup.uOverW.at(dx, dy), setup.vOverW.at(dx, dy), setup.intensityOverW.at(dx, dy) };
+    }
+
+    static ShadedVaryings gradient(const TriangleSetup& setup) {
+        return { setup.depth.a, setup.inverseW.a, setup.uOverW.a, setup.vOverW.a, setup.intensityOverW.a };
+    }
+
+    void step(const ShadedVaryings& gradient) {
+        z += gradient.z;
+        inverseW += gradient.inverseW;
+        uOverW += gradient.uOverW;
+        vOverW += gradient.vOverW;
+        intensityOverW += gradient.intensityOverW;
+    }
+
+    uint32_t shade(const ScreenTriangle&, const TriangleSetup& setup, const TextureSampler& sampler) const {
+        float w = 1.0f / inverseW;
+        uint32_t texel = sampleTexture(sampler, setup.uOverW, setup.vOverW, setup.inverseW, w, uOverW * w, vOverW * w);
+        return applyLighting(texel, intensityOverW * w);
+    }
+};
+
+/**
+ * @brief Per-draw context of the normal-mapped mode: the texture and the normal map
+ */
+struct NormalMappedSamplers {
+    const TextureSampler& diffuse;      // Texture modulated by the lighting
+    const TextureSampler& normals;      // Normal map, sampled at the same texture coordinates
+};
+
+/**
+ * @brief Interpolants of the normal-mapped mode: perspective-correct texture coordinates and light direction
+ */
+struct NormalMappedVaryings {
+    float z, inverseW, uOverW, vOverW, lightXOverW, lightYOverW, lightZOverW;
+
+    static NormalMappedVaryings at(const TriangleSetup& setup, float dx, float dy) {
+        return { setup.depth.at(dx, dy), setup.inverseW.at(dx, dy),
+                 setup.uOverW.at(dx, dy), setup.vOverW.at(dx, dy),
+                 setup.lightXOverW.at(dx, dy), setup.lightYOverW.at(dx, dy), setup.lightZOverW.at(dx, dy) };
+    }
+
+    static NormalMappedVaryings gradient(const TriangleSetup& setup) {
+        return { setup.depth.a, setup.inverseW.a, setup.uOverW.a, setup.vOverW.a,
+                 setup.lightXOverW.a, setup.lightYOverW.a, setup.lightZOverW.a };
+    }
+
+    void step(const NormalMappedVaryings& gradient) {
+        z += gradient.z;
+        inverseW += gradient.inverseW;
+        uOverW += gradient.uOverW;
+        vOverW += gradient.vOverW;
+        lightXOverW += gradient.lightXOverW;
+        lightYOverW += gradient.lightYOverW;
+        lightZOverW += gradient.lightZOverW;
+    }
+
+    uint32_t shade(const ScreenTriangle&, const TriangleSetup& setup, const NormalMappedSamplers& samplers) const {
+        float w = 1.0f / inverseW;
+        float u = uOverW * w, v = vOverW * w;
+        uint32_t texel = sampleTexture(samplers.diffuse, setup.uOverW, setup.vOverW, setup.inverseW, w, u, v);
+        uint32_t normal = sampleTexture(samplers.normals, setup.uOverW, setup.vOverW, setup.inverseW, w, u, v);
+        return applyLighting(texel, normalMapIntensity(normal, lightXOverW * w, lightYOverW * w, lightZOverW * w));
+    }
+};
+
+/**
+ * @brief Scanline rasterizer, generic over the varyings it interpolates
+ *
+ * The triangle is walked row by row. The span of each row comes from the
+ * exact integer edge functions of the edge rasterizer (TriangleEdges), on
+ * the same 28.4 subpixel grid and with the same top-left fill rule, so both
+ * cover the same pixels and shared edges are written exactly once. Every
+ * span starts from the attribute planes evaluated at its first pixel and
+ * steps only the varyings of the instantiated struct, so each mode gets its
+ * own fully inlined inner loop. Adding a mode only takes a new varyings struct.
+ */
+class ScanlineRasterizer {
+public:
+    /**
+     * @brief Constructor
+     * @param frameBuffer Color buffer to draw into
+     * @param zBuffer Depth buffer used for depth testing
+     * @param width Width of both buffers in pixels
+     */
+    ScanlineRasterizer(std::vector<uint32_t>& frameBuffer, std::vector<float>& zBuffer, int width);
+
+    /**
+     * @brief Draws a triangle, depth tested unless the varyings opt out
+     * @tparam Varyings Interpolants and shading of the mode (see DepthVaryings)
+     * @param triangle Screen-space triangle
+     * @param setup Attribute planes of the triangle
+     * @param context Passed to Varyings::shade, e.g. the texture sampler of textured varyings
+     * @param clip Tile rectangle that limits the written pixels
+     */
+    template<typename Varyings, typename Context>
+    void drawTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                      const Context& context, const TileRect& clip);
+
+private:
+    /**
+     * @brief Whether a varyings struct is drawn with the depth test (see DepthVaryings)
+     */
+    template<typename Varyings>
+    static constexpr bool depthTested() {
+        if constexpr (requires { Varyings::DEPTH_TEST; }) {
+            return Varyings::DEPTH_TEST;
+        } else {
+            return true;
+        }
+    }
+
+    std::vector<uint32_t>& frameBuffer;     // Color buffer
+    std::vector<float>& zBuffer;            // Depth buffer
+    int width;                              // Width of the buffers
+};
+
+template<typename Varyings, typename Context>
+void ScanlineRasterizer::drawTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                                      const Context& context, const TileRect& clip) {
+    TriangleEdges edges;
+    if (!edges.setup(triangle)) {
+        return;
+    }
+
+    // Local copy, so the compiler can keep the gradient in registers across the buffer writes
+    const Varyings gradient = Varyings::gradient(setup);
+
+    int yEnd = std::min(clip.y1 - 1, edges.maxY);
+    for (int y = std::max(clip.y0, edges.minY); y <= yEnd; y++) {
+        // Covered pixels of the row, scissored to the tile
+        int xStart, xEnd;
+        if (!edges.rowSpan(y, xStart, xEnd)) {
+            continue;
+        }
+        xStart = std::max(xStart, clip.x0);
+        xEnd = std::min(xEnd, clip.x1 - 1);
+
+        // Evaluate the varyings at the first pixel, then step them along the span
+        Varyings varyings = Varyings::at(setup, xStart - setup.originX, y - setup.originY);
+        for (int x = xStart; x <= xEnd; x++) {
+            int index = y * width + x;
+            if constexpr (!depthTested<Varyings>()) {
+                frameBuffer[index] = varyings.shade(triangle, setup, context);
+            } else if (varyings.z < zBuffer[index]) {
+                frameBuffer[index] = varyings.shade(triangle, setup, context);
+                zBuffer[index] = varyings.z;
+            }
+            varyings.step(gradient);
+        }
+    }
+}
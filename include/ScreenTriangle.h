@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Screen-space triangle produced by the setup stage and rasterized per tile
+ */
+struct ScreenTriangle {
+    float x[3], y[3], z[3];     // Screen position and depth of each corner
+    float invW[3];              // Reciprocal clip-space w of each corner, for perspective-correct interpolation
+    float u[3], v[3];           // Texture coordinates of each corner
+    float intensity[3];         // Light intensity of each corner
+    float lightX[3] = {}, lightY[3] = {}, lightZ[3] = {};  // Direction to the light in the space of the normal map, per corner (normal-mapped mode only)
+    uint32_t color;             // Flat color for untextured modes
+};
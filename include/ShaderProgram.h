@@ -0,0 +1,135 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <Eigen/Dense>
+#include "ScreenTriangle.h"
+#include "TriangleSetup.h"
+
+/**
+ * @brief Programmable shading stages, bound at compile time
+ *
+ * A shader program is a pair of plain C++ types: a vertex shader that turns
+ * the attributes of a face corner into varyings, and a fragment shader that
+ * turns interpolated varyings into a color. Renderer::renderProgram is a
+ * template over both, so they are inlined into the face setup and into the
+ * scanline inner loop; there is no virtual call per vertex or pixel.
+ *
+ * Positions are not programmable: they come from the shared post-transform
+ * cache (VertexProcessor), which every mode and program reuses.
+ */
+
+/**
+ * @brief Attributes of one face corner handed to the vertex shader
+ */
+struct VertexInput {
+    int index;                  // Index of the vertex in the model
+    Eigen::Vector3f position;   // Model-space position
+    Eigen::Vector3f normal;     // Model-space vertex normal, or the face normal if the model has none
+    Eigen::Vector2f texCoord;   // Texture coordinates with V flipped, zero if the model has none
+};
+
+/**
+ * @brief Maximum number of floats a program can interpolate
+ *
+ * Varyings travel through clipping, triangle setup and rasterization in the
+ * three perspective-correct attribute slots of a ScreenTriangle.
+ */
+constexpr int MAX_SHADER_VARYINGS = 3;
+
+/**
+ * @brief Varyings: a trivially copyable struct of at most MAX_SHADER_VARYINGS floats
+ */
+template<typename V>
+concept ShaderVaryings = std::is_trivially_copyable_v<V> && std::is_default_constructible_v<V> &&
+                         sizeof(V) % sizeof(float) == 0 &&
+                         sizeof(V) <= MAX_SHADER_VARYINGS * sizeof(float);
+
+/**
+ * @brief Vertex shader: declares its Varyings and computes them for a face corner
+ */
+template<typename S>
+concept VertexShader = requires(const S& shader, const VertexInput& input) {
+    typename S::Varyings;
+    requires ShaderVaryings<typename S::Varyings>;
+    { shader(input) } -> std::same_as<typename S::Varyings>;
+};
+
+/**
+ * @brief Fragment shader: computes the ARGB color of a pixel from interpolated varyings
+ */
+template<typename S, typename V>
+concept FragmentShader = ShaderVaryings<V> && requires(const S& shader, const V& varyings) {
+    { shader(varyings) } -> std::convertible_to<uint32_t>;
+};
+
+/**
+ * @brief Stores the varyings of a face corner in the attribute slots of a screen triangle
+ */
+template<ShaderVaryings V>
+void storeVaryings(const V& varyings, ScreenTriangle& triangle, int corner) {
+    float slots[MAX_SHADER_VARYINGS] = {};
+    std::memcpy(slots, &varyings, sizeof(V));
+    triangle.u[corner] = slots[0];
+    triangle.v[corner] = slots[1];
+    triangle.intensity[corner] = slots[2];
+}
+
+/**
+ * @brief Scanline varyings (see DepthVaryings) that interpolate a program's varyings and run its fragment shader
+ *
+ * Only the slots the program uses are carried along the span.
+ */
+template<ShaderVaryings V>
+struct ProgramVaryings {
+    static constexpr int COUNT = sizeof(V) / sizeof(float);
+
+    float z, inverseW;
+    float overW[COUNT];     // Varyings divided by w
+
+    /**
+     * @brief Plane of an attribute slot: u, v and intensity in that order
+     */
+    static const AttributePlane& plane(const TriangleSetup& setup, int slot) {
+        const AttributePlane* planes[MAX_SHADER_VARYINGS] = { &setup.uOverW, &setup.vOverW, &setup.intensityOverW };
+        return *planes[slot];
+    }
+
+    static ProgramVaryings at(const TriangleSetup& setup, float dx, float dy) {
+        ProgramVaryings result{ setup.depth.at(dx, dy), setup.inverseW.at(dx, dy), {} };
+        for (int i = 0; i < COUNT; ++i) {
+            result.overW[i] = plane(setup, i).at(dx, dy);
+        }
+        return result;
+    }
+
+    static ProgramVaryings gradient(const TriangleSetup& setup) {
+        ProgramVaryings result{ setup.depth.a, setup.inverseW.a, {} };
+        for (int i = 0; i < COUNT; ++i) {
+            result.overW[i] = plane(setup, i).a;
+        }
+        return result;
+    }
+
+    void step(const ProgramVaryings& gradient) {
+        z += gradient.z;
+        inverseW += gradient.inverseW;
+        for (int i = 0; i < COUNT; ++i) {
+            overW[i] += gradient.overW[i];
+        }
+    }
+
+    template<FragmentShader<V> FS>
+    uint32_t shade(const ScreenTriangle&, const TriangleSetup&, const FS& fragmentShader) const {
+        float w = 1.0f / inverseW;
+        float values[COUNT];
+        for (int i = 0; i < COUNT; ++i) {
+            values[i] = overW[i] * w;
+        }
+        V varyings;
+        std::memcpy(&varyings, values, sizeof(V));
+        return fragmentShader(varyings);
+    }
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <Eigen/Dense>
+#include "Model.h"
+#include "PixelShading.h"
+#include "ShaderProgram.h"
+#include "TextureSampler.h"
+
+/**
+ * @brief Enum selecting one of the built-in shader programs
+ */
+enum class ShaderLook {
+    NONE,               // No program, the render mode is used
+    TOON,               // Banded diffuse lighting
+    NORMALS,            // Surface normals as colors
+    AMBIENT_OCCLUSION   // Crevices darkened and tinted by per-vertex occlusion
+};
+
+/**
+ * @brief Vertex shader of the toon look: texture coordinates and diffuse light
+ */
+struct ToonVertexShader {
+    struct Varyings {
+        float u, v;         // Texture coordinates
+        float diffuse;      // Unclamped cosine between normal and light
+    };
+
+    Eigen::Vector3f lightDirection;     // Normalized direction to the light in model space
+
+    Varyings operator()(const VertexInput& input) const {
+        return { input.texCoord.x(), input.texCoord.y(), input.normal.dot(lightDirection) };
+    }
+};
+
+/**
+ * @brief Fragment shader of the toon look: quantizes the diffuse light into flat bands
+ */
+struct ToonFragmentShader {
+    static constexpr float BANDS = 4.0f;    // Number of light levels above the ambient term
+    static constexpr float AMBIENT = 0.25f; // Light level of surfaces facing away
+
+    const TextureSampler* sampler;          // Base color, white if null
+
+    uint32_t operator()(const ToonVertexShader::Varyings& varyings) const {
+        float level = std::ceil(std::clamp(varyings.diffuse, 0.0f, 1.0f) * BANDS) / BANDS;
+        uint32_t color = sampler ? sampler->sample(varyings.u, varyings.v) : 0xFFFFFFFF;
+        return applyLighting(color, AMBIENT + (1.0f - AMBIENT) * level);
+    }
+};
+
+/**
+ * @brief Vertex shader of the normal visualization: passes the model-space normal on
+ */
+struct NormalVertexShader {
+    struct Varyings {
+        float x, y, z;      // Interpolated normal, no longer unit length
+    };
+
+    Varyings operator()(const VertexInput& input) const {
+        return { input.normal.x(), input.normal.y(), input.normal.z() };
+    }
+};
+
+/**
+ * @brief Fragment shader of the normal visualization: maps each axis from [-1, 1] to a color channel
+ */
+struct NormalFragmentShader {
+    uint32_t operator()(const NormalVertexShader::Varyings& varyings) const {
+        float length = std::sqrt(varyings.x * varyings.x + varyings.y * varyings.y + varyings.z * varyings.z);
+        float scale = length > 0.0f ? 0.5f / length : 0.0f;
+        auto channel = [scale](float value) {
+            return static_cast<uint32_t>(std::clamp(value * scale + 0.5f, 0.0f, 1.0f) * 255.0f);
+        };
+        return 0xFF000000 | (channel(varyings.x) << 16) | (channel(varyings.y) << 8) | channel(varyings.z);
+    }
+};
+
+/**
+ * @brief Vertex shader of the ambient occlusion look: texture coordinates and the occlusion of the vertex
+ */
+struct OcclusionVertexShader {
+    struct Varyings {
+        float u, v;         // Texture coordinates
+        float occlusion;    // 0 for open surfaces, 1 for fully enclosed ones
+    };
+
+    const std::vector<float>* occlusion;    // Per-vertex occlusion from computeVertexOcclusion()
+
+    Varyings operator()(const VertexInput& input) const {
+        return { input.texCoord.x(), input.texCoord.y(), (*occlusion)[input.index] };
+    }
+};
+
+/**
+ * @brief Fragment shader of the ambient occlusion look: darkens occluded areas and tints them towards a cool shadow color
+ */
+struct OcclusionFragmentShader {
+    static constexpr float SHADOW_R = 40.0f, SHADOW_G = 48.0f, SHADOW_B = 96.0f;    // Tint of fully occluded areas
+
+    const TextureSampler* sampler;          // Base color, light grey if null
+
+    uint32_t operator()(const OcclusionVertexShader::Varyings& varyings) const {
+        float occlusion = std::clamp(varyings.occlusion, 0.0f, 1.0f);
+        uint32_t color = sampler ? sampler->sample(varyings.u, varyings.v) : 0xFFD0D0D0;
+        float light = 1.0f - occlusion;
+        auto channel = [&](int shift, float shadow) {
+            float base = static_cast<float>((color >> shift) & 0xFF);
+            return static_cast<uint32_t>(base * light + shadow * occlusion) << shift;
+        };
+        return (color & 0xFF000000) | channel(16, SHADOW_R) | channel(8, SHADOW_G) | channel(0, SHADOW_B);
+    }
+};
+
+/**
+ * @brief Estimates how occluded each vertex of a model is from the shape of its neighbourhood
+ *
+ * A vertex whose neighbours rise above its tangent plane sits in a crevice
+ * and receives less ambient light. The estimate is the height of the
+ * neighbours' centroid above that plane relative to their mean distance,
+ * which is cheap enough to compute on load and needs no ray casting.
+ * Vertices sharing a position (Model::getPositionIds) get the same value.
+ *
+ * @param model Model whose vertices are evaluated
+ * @return Occlusion in [0, 1] for each vertex of the model
+ */
+std::vector<float> computeVertexOcclusion(const Model& model);
@@ -2,7 +2,49 @@
 
 #include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include "BlockCompression.h"
+
+/**
+ * @brief Order in which the texels of a texture are stored
+ */
+enum class TextureLayout {
+    LINEAR,     // Row-major, texel (x, y) at y * width + x
+    MORTON      // Z-order curve: the bits of x and y are interleaved, so texels close in u and v are close in memory
+};
+
+/**
+ * @brief How a texture is sampled for a pixel
+ */
+enum class TextureFilter {
+    NEAREST,            // Nearest texel of the full-resolution level
+    BILINEAR,           // 2x2 texels of the full-resolution level, weighted by distance
+    NEAREST_MIPMAP,     // Nearest texel of the mip level closest to the pixel's footprint
+    TRILINEAR           // Bilinear samples of the two mip levels around the footprint, blended
+};
+
+/**
+ * @brief How the texels of a texture are stored; sampling decodes every format to ARGB
+ */
+enum class TextureFormat {
+    RGBA8,      // 4 bytes: 8-bit alpha, red, green and blue
+    RGB565,     // 2 bytes: 5-bit red, 6-bit green and 5-bit blue, opaque
+    RG8,        // 2 bytes: 8-bit red and green (e.g. the x and y of a normal map), blue 0, opaque
+    R8,         // 1 byte: one 8-bit channel (grayscale images, masks), sampled as opaque grey
+    BC1,        // 8 bytes per 4x4 block: two RGB565 colors and 2-bit selectors, 1-bit alpha (see BlockCompression.h)
+    BC3         // 16 bytes per 4x4 block: BC1 colors plus interpolated 8-bit alpha
+};
+
+/**
+ * @brief How texture coordinates outside [0, 1) are mapped onto the texture
+ */
+enum class TextureWrap {
+    REPEAT,     // The texture tiles
+    CLAMP,      // The border texels extend outwards
+    MIRROR      // The texture tiles, every second copy flipped
+};
 
 /**
  * @brief Class representing a texture loaded from a TGA file
@@ -44,9 +86,262 @@ public:
      * @param u Horizontal texture coordinate (0.0 to 1.0)
      * @param v Vertical texture coordinate (0.0 to 1.0)
      * @return Color at the specified texture coordinates as RGBA
+     *
+     * Repeats and reads the nearest texel of level 0 whatever the filter and
+     * wrap mode; renders sample through a TextureSampler instead.
      */
     uint32_t getColorAt(float u, float v) const;
     
+    /**
+     * @brief Builds the mip chain by repeatedly averaging 2x2 texel blocks down to 1x1
+     *
+     * Each level is stored in the layout of the texture. The chain adds a
+     * third to the memory of the texture.
+     */
+    void generateMipmaps();
+    
+    /**
+     * @brief Gets the number of mip levels, including the full-resolution level
+     * @return 1 if no mip chain was generated
+     */
+    int getLevelCount() const { return 1 + static_cast<int>(mipLevels.size()); }
+    
+    /**
+     * @brief Gets a mip level
+     * @param level Level, 0 being the texture itself
+     * @return Texture of the level
+     */
+    const Texture& getLevel(int level) const { return level == 0 ? *this : mipLevels[level - 1]; }
+    
+    /**
+     * @brief Gets the texel at integer coordinates, whatever the layout
+     * @param x Column, in [0, width)
+     * @param y Row, in [0, height)
+     * @return Texel as ARGB
+     */
+    uint32_t getTexel(int x, int y) const { return fetchTexel(data.data(), getTexelIndex(x, y), format); }
+    
+    /**
+     * @brief Gets the position of a texel in the pixel data
+     *
+     * Block-compressed textures number their texels block by block, so the
+     * index of a texel is 16 * block + 4 * (y % 4) + x % 4, the blocks being
+     * stored row by row.
+     *
+     * @param x Column, in [0, width)
+     * @param y Row, in [0, height)
+     * @return Index of the texel, see fetchTexel()
+     */
+    size_t getTexelIndex(int x, int y) const {
+        if (layout == TextureLayout::MORTON) {
+            return mortonColumns[x] | mortonRows[y];
+        }
+        if (isBlockCompressed(format)) {
+            size_t block = static_cast<size_t>(y >> 2) * ((width + 3) >> 2) + (x >> 2);
+            return block * 16 + ((y & 3) << 2) + (x & 3);
+        }
+        return static_cast<size_t>(y) * width + x;
+    }
+    
+    /**
+     * @brief Interleaves the low bits of x and y and appends the remaining high bits
+     *
+     * For a power-of-two texture of 2^a x 2^b texels, the low min(a, b) bits
+     * of both coordinates form a Z-order curve; the excess bits of the longer
+     * side select one of the square Morton blocks placed one after another.
+     *
+     * @param x Column
+     * @param y Row
+     * @param bits Number of interleaved bits, log2 of the shorter side
+     * @return Index of the texel in Morton order
+     */
+    static uint32_t mortonIndex(uint32_t x, uint32_t y, int bits) {
+        uint32_t lowMask = (1u << bits) - 1;
+        uint32_t low = spreadBits(x & lowMask) | (spreadBits(y & lowMask) << 1);
+        uint32_t high = ((x >> bits) | (y >> bits)) << (2 * bits);
+        return low | high;
+    }
+    
+    /**
+     * @brief Checks whether a format stores 4x4 blocks rather than single texels
+     */
+    static constexpr bool isBlockCompressed(TextureFormat format) {
+        return format == TextureFormat::BC1 || format == TextureFormat::BC3;
+    }
+    
+    /**
+     * @brief Gets the number of bytes of a texel in a format, or of a 4x4 block in a block-compressed one
+     */
+    static constexpr size_t getTexelSize(TextureFormat format) {
+        switch (format) {
+            case TextureFormat::BC1:
+                return BC1_BLOCK_BYTES;
+            case TextureFormat::BC3:
+                return BC3_BLOCK_BYTES;
+            case TextureFormat::RGB565:
+            case TextureFormat::RG8:
+                return 2;
+            case TextureFormat::R8:
+                return 1;
+            case TextureFormat::RGBA8:
+            default:
+                return 4;
+        }
+    }
+    
+    /**
+     * @brief Expands a stored texel to ARGB
+     *
+     * The 5- and 6-bit channels of RGB565 are widened by repeating their top
+     * bits, so 0 and the maximum map to 0 and 255.
+     *
+     * @param texel First byte of the texel
+     * @param format Format of the texel, not block-compressed
+     * @return Texel as ARGB
+     */
+    static uint32_t decodeTexel(const uint8_t* texel, TextureFormat format) {
+        switch (format) {
+            case TextureFormat::RGB565: {
+                uint16_t value;
+                std::memcpy(&value, texel, sizeof(value));
+                return expandRGB565(value);
+            }
+            case TextureFormat::RG8:
+                return 0xFF000000 | (uint32_t(texel[0]) << 16) | (uint32_t(texel[1]) << 8);
+            case TextureFormat::R8:
+                return 0xFF000000 | uint32_t(texel[0]) * 0x010101;
+            case TextureFormat::RGBA8:
+            default: {
+                uint32_t value;
+                std::memcpy(&value, texel, sizeof(value));
+                return value;
+            }
+        }
+    }
+    
+    /**
+     * @brief Reads a texel of pixel data as ARGB, whatever the format
+     * @param texels Pixel data
+     * @param index Index of the texel, as getTexelIndex() numbers it
+     * @param format Format of the pixel data
+     * @return Texel as ARGB
+     */
+    static uint32_t fetchTexel(const uint8_t* texels, size_t index, TextureFormat format) {
+        switch (format) {
+            case TextureFormat::BC1:
+                return decodeBC1Texel(texels + (index >> 4) * BC1_BLOCK_BYTES, index & 15);
+            case TextureFormat::BC3:
+                return decodeBC3Texel(texels + (index >> 4) * BC3_BLOCK_BYTES, index & 15);
+            default:
+                return decodeTexel(texels + index * getTexelSize(format), format);
+        }
+    }
+    
+    /**
+     * @brief Stores an ARGB color in a format, rounding the channels it narrows and dropping those it lacks
+     * @param color Color as ARGB
+     * @param format Format to store in, not block-compressed
+     * @param texel First byte of the texel
+     */
+    static void encodeTexel(uint32_t color, TextureFormat format, uint8_t* texel) {
+        uint32_t r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
+        switch (format) {
+            case TextureFormat::RGB565: {
+                uint16_t value = static_cast<uint16_t>(packRGB565(r, g, b));
+                std::memcpy(texel, &value, sizeof(value));
+                break;
+            }
+            case TextureFormat::RG8:
+                texel[0] = static_cast<uint8_t>(r);
+                texel[1] = static_cast<uint8_t>(g);
+                break;
+            case TextureFormat::R8:
+                texel[0] = static_cast<uint8_t>(r);
+                break;
+            case TextureFormat::RGBA8:
+            default:
+                std::memcpy(texel, &color, sizeof(color));
+                break;
+        }
+    }
+    
+    /**
+     * @brief Gets the format the texels are stored in
+     * @return Texture format
+     */
+    TextureFormat getFormat() const { return format; }
+    
+    /**
+     * @brief Converts the texels, including the mip levels, to another format
+     *
+     * Narrower formats lose the channels and the precision they lack; converting back does not restore them.
+     * Block-compressed formats keep their blocks in rows, so they take the texture out of the Morton layout.
+     *
+     * @param newFormat Format to convert to
+     */
+    void setFormat(TextureFormat newFormat);
+    
+    /**
+     * @brief Gets the memory held by the texels of the texture and its mip levels
+     * @return Size in bytes
+     */
+    size_t getMemoryUsage() const;
+    
+    /**
+     * @brief Gets the storage order of the pixel data
+     * @return Texture layout
+     */
+    TextureLayout getLayout() const { return layout; }
+    
+    /**
+     * @brief Gets the filter the texture is sampled with unless a render overrides it
+     * @return Texture filter
+     */
+    TextureFilter getFilter() const { return filter; }
+    
+    /**
+     * @brief Sets the filter the texture is sampled with unless a render overrides it
+     * @param newFilter Texture filter
+     */
+    void setFilter(TextureFilter newFilter) { filter = newFilter; }
+    
+    /**
+     * @brief Gets the wrap mode the texture is sampled with unless a render overrides it
+     * @return Texture wrap mode
+     */
+    TextureWrap getWrap() const { return wrap; }
+    
+    /**
+     * @brief Sets the wrap mode the texture is sampled with unless a render overrides it
+     * @param newWrap Texture wrap mode
+     */
+    void setWrap(TextureWrap newWrap) { wrap = newWrap; }
+    
+    /**
+     * @brief Gets the Morton index bits of each column; the index of texel (x, y) is columns[x] | rows[y]
+     * @return One entry per column, empty for the linear layout
+     */
+    const std::vector<uint32_t>& getMortonColumns() const { return mortonColumns; }
+    
+    /**
+     * @brief Gets the Morton index bits of each row, see getMortonColumns()
+     * @return One entry per row, empty for the linear layout
+     */
+    const std::vector<uint32_t>& getMortonRows() const { return mortonRows; }
+    
+    /**
+     * @brief Checks whether the texture can be stored in Morton order
+     * @return True if both sides are powers of two
+     */
+    bool supportsMortonLayout() const;
+    
+    /**
+     * @brief Reorders the pixel data into another layout
+     * @param newLayout Layout to convert to
+     * @return True if successful, false if the layout is not supported by the texture size
+     */
+    bool setLayout(TextureLayout newLayout);
+    
     /**
      * @brief Gets the width of the texture
      * @return Width in pixels
@@ -61,9 +356,15 @@ public:
     
     /**
      * @brief Gets the raw pixel data
-     * @return Pointer to the pixel data
+     *
+     * Texels take getTexelSize(getFormat()) bytes each, in the order given by
+     * getLayout(); block-compressed formats store that many bytes per 4x4
+     * block instead. TEXEL_PADDING bytes follow the last texel, so 32-bit
+     * loads of narrower texels stay inside the buffer.
+     *
+     * @return Pixel data, empty if no texture is loaded
      */
-    const std::vector<uint32_t>& getData() const { return data; }
+    const std::vector<uint8_t>& getData() const { return data; }
 
     /**
      * @brief Sets the width of the texture
@@ -78,10 +379,20 @@ public:
     void setHeight(int h) { height = h; }
     
     /**
-     * @brief Sets the raw pixel data
-     * @param pixelData Vector of pixel data in RGBA format
+     * @brief Sets the raw pixel data, which resets the layout to linear and the format to RGBA8
+     * @param pixelData Vector of pixel data in ARGB format, row-major
      */
-    void setData(const std::vector<uint32_t>& pixelData) { data = pixelData; }
+    void setData(const std::vector<uint32_t>& pixelData) {
+        format = TextureFormat::RGBA8;
+        allocate(pixelData.size());
+        std::memcpy(data.data(), pixelData.data(), pixelData.size() * sizeof(uint32_t));
+        layout = TextureLayout::LINEAR;
+        mortonColumns.clear();
+        mortonRows.clear();
+        mipLevels.clear();
+    }
+    
+    static constexpr size_t TEXEL_PADDING = 3;  // Bytes after the last texel, see getData()
 
     bool loadRLEData(std::ifstream& file,
                  int width, int height,
@@ -90,7 +401,38 @@ public:
 
 
 private:
+    /**
+     * @brief Sizes the pixel data for a number of texels in the current format, zeroed; blocks follow the texture size
+     */
+    void allocate(size_t texelCount) {
+        size_t units = isBlockCompressed(format) ? static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) : texelCount;
+        data.assign(texelCount == 0 ? 0 : units * getTexelSize(format) + TEXEL_PADDING, 0);
+    }
+    
+    /**
+     * @brief Stores a color at a texel index in the current format
+     */
+    void setTexel(size_t index, uint32_t color) { encodeTexel(color, format, &data[index * getTexelSize(format)]); }
+    
+    /**
+     * @brief Inserts a zero bit above each of the low 16 bits of a value
+     */
+    static uint32_t spreadBits(uint32_t v) {
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
     int width = 0;                  // Width of the texture in pixels
     int height = 0;                 // Height of the texture in pixels
-    std::vector<uint32_t> data;     // Pixel data (RGBA format, 8 bits per channel)
+    std::vector<uint8_t> data;      // Pixel data in the texture format, see getData()
+    TextureFormat format = TextureFormat::RGBA8;    // Storage of each texel
+    TextureLayout layout = TextureLayout::LINEAR;   // Order of the pixel data
+    TextureFilter filter = TextureFilter::NEAREST;  // Default filter of the renders that sample the texture
+    TextureWrap wrap = TextureWrap::REPEAT;         // Default wrap mode of the renders that sample the texture
+    std::vector<uint32_t> mortonColumns;    // Morton index bits contributed by each x
+    std::vector<uint32_t> mortonRows;       // Morton index bits contributed by each y
+    std::vector<Texture> mipLevels; // Mip levels 1 and up, each half the size of the previous one
 }; 
\ No newline at end of file
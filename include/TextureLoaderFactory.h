@@ -1,6 +1,10 @@
 #pragma once
 #include "ITextureLoader.h"
+#include <cstddef>
+#include <filesystem>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -8,6 +12,60 @@ class TextureLoaderFactory {
 public:
     static std::shared_ptr<ITextureLoader> createLoader(const std::string& fileExtension);
     static void registerLoader(const std::string& extension, std::shared_ptr<ITextureLoader> loader);
+
+    /**
+     * @brief Loads a texture with the loader registered for its extension, through the process-wide texture cache
+     *
+     * Textures are cached by canonical path and modification time, so every
+     * caller asking for the same unchanged file shares one decoded texture;
+     * a file written since it was cached is decoded again. Cached textures
+     * are shared, so they are handed out const: callers that convert a
+     * texture copy it first. When the cached textures exceed the budget, the least
+     * recently requested ones leave the cache (textures still in use stay
+     * alive with their users).
+     *
+     * @param filename Texture file
+     * @return The texture, or nullptr if the file does not exist or no loader handles it
+     */
+    static std::shared_ptr<const Texture> loadTexture(const std::string& filename);
+
+    /**
+     * @brief Sets the memory the texture cache may hold, evicting textures beyond it
+     * @param bytes Budget in bytes, 0 disables caching
+     */
+    static void setCacheBudget(size_t bytes);
+    static size_t getCacheBudget();
+
+    /**
+     * @brief Memory of the cached textures, including their mip levels
+     */
+    static size_t getCacheUsage();
+
+    /**
+     * @brief Drops every cached texture
+     */
+    static void clearCache();
+
+    static constexpr size_t DEFAULT_CACHE_BUDGET = size_t(256) << 20;  // 256 MiB
+
 private:
+    struct CacheEntry {
+        std::string path;                                   // Canonical path of the file
+        std::filesystem::file_time_type modified;           // Modification time of the file when it was decoded
+        std::shared_ptr<const Texture> texture;
+        size_t bytes;                                       // Texture::getMemoryUsage() of the texture
+    };
+
+    /**
+     * @brief Evicts the least recently used textures until the cache fits its budget; needs cacheMutex
+     */
+    static void evict();
+
     static std::unordered_map<std::string, std::shared_ptr<ITextureLoader>> loaders;
-}; 
\ No newline at end of file
+
+    static std::list<CacheEntry> cache;    // Most recently requested first
+    static std::unordered_map<std::string, std::list<CacheEntry>::iterator> cacheIndex;   // By canonical path
+    static size_t cacheBudget;
+    static size_t cacheUsage;
+    static std::mutex cacheMutex;
+};
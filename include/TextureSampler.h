@@ -0,0 +1,446 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Texture.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief A texture bound for drawing, with the addressing of every mip level precomputed
+ *
+ * Binding happens once per draw and settles everything that
+ * Texture::getColorAt decides per call: empty textures are replaced by a
+ * black texel, and the filter, wrap mode, sizes, layout tables and whether
+ * masks can replace modulos are captured per level. Texture coordinates
+ * become texel coordinates in 24.8 fixed point by one multiply and a floor.
+ * The integer part addresses the texel after a mask (repeat), a clamp or a
+ * mirror, and the fraction weights bilinear taps. The fixed-point range
+ * limits coordinates to |u| * width < 2^22; beyond that they saturate.
+ *
+ * Texels are decoded to ARGB as they are fetched, so compact formats
+ * cost memory and bandwidth in proportion to their size and only a few
+ * integer operations per texel.
+ *
+ * The scalar and the 8-wide paths use the same integer arithmetic, so
+ * every backend returns identical colors.
+ */
+class TextureSampler {
+public:
+    static constexpr int MAX_LEVELS = 16;   // Mip levels of a 32768 texel wide texture
+
+    /**
+     * @brief Addressing state of one mip level
+     */
+    struct Level {
+        const uint8_t* texels;          // Pixel data in the layout and format of the texture
+        TextureFormat format;           // Storage of each texel
+        const uint32_t* mortonColumns;  // Morton index bits per column, null in the linear layout
+        const uint32_t* mortonRows;     // Morton index bits per row, null in the linear layout
+        int32_t width, height;          // Size in texels
+        float scaleX, scaleY;           // Size * 256: converts u and v to 24.8 fixed-point texel coordinates
+        bool powerOfTwo;                // Both sides are powers of two, so wrapping can mask
+    };
+
+    /**
+     * @brief Binds a texture with its own filter and wrap mode
+     * @param texture Texture to sample, null or empty for opaque black
+     */
+    explicit TextureSampler(const Texture* texture);
+
+    /**
+     * @brief Gets the bound texture
+     * @return Texture given on binding, may be null
+     */
+    const Texture* getTexture() const { return texture; }
+
+    /**
+     * @brief Gets the filter
+     * @return Texture filter
+     */
+    TextureFilter getFilter() const { return filter; }
+
+    /**
+     * @brief Overrides the filter of the texture
+     * @param newFilter Texture filter
+     */
+    void setFilter(TextureFilter newFilter) { filter = newFilter; }
+
+    /**
+     * @brief Gets the wrap mode
+     * @return Texture wrap mode
+     */
+    TextureWrap getWrap() const { return wrap; }
+
+    /**
+     * @brief Overrides the wrap mode of the texture
+     * @param newWrap Texture wrap mode
+     */
+    void setWrap(TextureWrap newWrap) { wrap = newWrap; }
+
+    /**
+     * @brief Checks whether the filter selects mip levels, so sampling needs a level of detail
+     * @return True for NEAREST_MIPMAP and TRILINEAR
+     */
+    bool usesMipmaps() const { return filter == TextureFilter::NEAREST_MIPMAP || filter == TextureFilter::TRILINEAR; }
+
+    /**
+     * @brief Gets the addressing state of a mip level
+     * @param level Level, 0 being the full resolution
+     * @return Level state
+     */
+    const Level& getLevel(int level) const { return levels[level]; }
+
+    /**
+     * @brief Gets the number of bound mip levels
+     * @return At least 1
+     */
+    int getLevelCount() const { return levelCount; }
+
+    /**
+     * @brief Samples the full-resolution level, bilinearly for the bilinear and trilinear filters
+     * @param u Horizontal texture coordinate (0.0 to 1.0 covers the texture once)
+     * @param v Vertical texture coordinate (0.0 to 1.0 covers the texture once)
+     * @return Color as ARGB
+     */
+    uint32_t sample(float u, float v) const {
+        bool bilinear = filter == TextureFilter::BILINEAR || filter == TextureFilter::TRILINEAR;
+        return bilinear ? sampleBilinear(levels[0], u, v) : sampleNearest(levels[0], u, v);
+    }
+
+    /**
+     * @brief Samples the mip levels selected by a level of detail
+     * @param u Horizontal texture coordinate
+     * @param v Vertical texture coordinate
+     * @param lod Level of detail, log2 of the texels covered by one pixel (see textureLod)
+     * @return Color as ARGB
+     */
+    uint32_t sample(float u, float v, float lod) const;
+
+    /**
+     * @brief Fetches the texel nearest to a texture coordinate
+     */
+    uint32_t sampleNearest(const Level& level, float u, float v) const {
+        int32_t x = wrapCoordinate(toFixed(u, level.scaleX) >> 8, level.width, level.powerOfTwo);
+        int32_t y = wrapCoordinate(toFixed(v, level.scaleY) >> 8, level.height, level.powerOfTwo);
+        return fetchTexel(level, texelIndex(level, x, y));
+    }
+
+    /**
+     * @brief Interpolates the 2x2 texels around a texture coordinate, texel centers lying at half-integer positions
+     */
+    uint32_t sampleBilinear(const Level& level, float u, float v) const {
+        int32_t fx = toFixed(u, level.scaleX) - 128;
+        int32_t fy = toFixed(v, level.scaleY) - 128;
+        int32_t x0 = wrapCoordinate(fx >> 8, level.width, level.powerOfTwo);
+        int32_t x1 = wrapCoordinate((fx >> 8) + 1, level.width, level.powerOfTwo);
+        int32_t y0 = wrapCoordinate(fy >> 8, level.height, level.powerOfTwo);
+        int32_t y1 = wrapCoordinate((fy >> 8) + 1, level.height, level.powerOfTwo);
+        uint32_t wx = static_cast<uint32_t>(fx & 0xFF);
+        uint32_t wy = static_cast<uint32_t>(fy & 0xFF);
+
+        uint32_t top = lerpTexels(fetchTexel(level, texelIndex(level, x0, y0)), fetchTexel(level, texelIndex(level, x1, y0)), wx);
+        uint32_t bottom = lerpTexels(fetchTexel(level, texelIndex(level, x0, y1)), fetchTexel(level, texelIndex(level, x1, y1)), wx);
+        return lerpTexels(top, bottom, wy);
+    }
+
+#ifdef __AVX2__
+    /**
+     * @brief Samples 8 pixels of the full-resolution level, as sample(u, v)
+     * @param mask Lanes to fetch; the others return 0
+     */
+    __m256i sample(__m256 u, __m256 v, __m256i mask) const {
+        bool bilinear = filter == TextureFilter::BILINEAR || filter == TextureFilter::TRILINEAR;
+        return bilinear ? sampleBilinear(levels[0], u, v, mask) : sampleNearest(levels[0], u, v, mask);
+    }
+
+    /**
+     * @brief Samples 8 pixels from the mip levels selected by their levels of detail, as sample(u, v, lod)
+     * @param mask Lanes to fetch; the others return 0
+     */
+    __m256i sample(__m256 u, __m256 v, __m256 lod, __m256i mask) const;
+
+    /**
+     * @brief 8-wide sampleNearest
+     */
+    __m256i sampleNearest(const Level& level, __m256 u, __m256 v, __m256i mask) const {
+        __m256i x = wrapCoordinate(_mm256_srai_epi32(toFixed(u, level.scaleX), 8), level.width, level.powerOfTwo);
+        __m256i y = wrapCoordinate(_mm256_srai_epi32(toFixed(v, level.scaleY), 8), level.height, level.powerOfTwo);
+        return gatherTexels(level, texelIndex(level, x, y), mask);
+    }
+
+    /**
+     * @brief 8-wide sampleBilinear
+     *
+     * The 4 texels of every footprint are gathered whole and interpolated on
+     * their packed channels with lerpTexels.
+     */
+    __m256i sampleBilinear(const Level& level, __m256 u, __m256 v, __m256i mask) const {
+        const __m256i half = _mm256_set1_epi32(128);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i byteMask = _mm256_set1_epi32(0xFF);
+        __m256i fx = _mm256_sub_epi32(toFixed(u, level.scaleX), half);
+        __m256i fy = _mm256_sub_epi32(toFixed(v, level.scaleY), half);
+        __m256i x = _mm256_srai_epi32(fx, 8);
+        __m256i y = _mm256_srai_epi32(fy, 8);
+        __m256i x0 = wrapCoordinate(x, level.width, level.powerOfTwo);
+        __m256i x1 = wrapCoordinate(_mm256_add_epi32(x, one), level.width, level.powerOfTwo);
+        __m256i y0 = wrapCoordinate(y, level.height, level.powerOfTwo);
+        __m256i y1 = wrapCoordinate(_mm256_add_epi32(y, one), level.height, level.powerOfTwo);
+
+        __m256i i00, i10, i01, i11;
+        if (level.mortonColumns) {
+            const int* columns = reinterpret_cast<const int*>(level.mortonColumns);
+            const int* rows = reinterpret_cast<const int*>(level.mortonRows);
+            __m256i c0 = _mm256_i32gather_epi32(columns, x0, 4), c1 = _mm256_i32gather_epi32(columns, x1, 4);
+            __m256i r0 = _mm256_i32gather_epi32(rows, y0, 4), r1 = _mm256_i32gather_epi32(rows, y1, 4);
+            i00 = _mm256_or_si256(c0, r0);
+            i10 = _mm256_or_si256(c1, r0);
+            i01 = _mm256_or_si256(c0, r1);
+            i11 = _mm256_or_si256(c1, r1);
+        } else if (Texture::isBlockCompressed(level.format)) {
+            i00 = texelIndex(level, x0, y0);
+            i10 = texelIndex(level, x1, y0);
+            i01 = texelIndex(level, x0, y1);
+            i11 = texelIndex(level, x1, y1);
+        } else {
+            const __m256i width = _mm256_set1_epi32(level.width);
+            __m256i r0 = _mm256_mullo_epi32(y0, width), r1 = _mm256_mullo_epi32(y1, width);
+            i00 = _mm256_add_epi32(r0, x0);
+            i10 = _mm256_add_epi32(r0, x1);
+            i01 = _mm256_add_epi32(r1, x0);
+            i11 = _mm256_add_epi32(r1, x1);
+        }
+        __m256i t00 = gatherTexels(level, i00, mask);
+        __m256i t10 = gatherTexels(level, i10, mask);
+        __m256i t01 = gatherTexels(level, i01, mask);
+        __m256i t11 = gatherTexels(level, i11, mask);
+
+        __m256i wx = _mm256_and_si256(fx, byteMask);
+        __m256i wy = _mm256_and_si256(fy, byteMask);
+        return lerpTexels(lerpTexels(t00, t10, wx), lerpTexels(t01, t11, wx), wy);
+    }
+#endif
+
+private:
+    static constexpr float FIXED_LIMIT = 1073741824.0f;     // 2^30, keeps fixed-point coordinates and their neighbours in range
+
+    /**
+     * @brief Converts a texture coordinate to a 24.8 fixed-point texel coordinate, rounding down
+     *
+     * The saturation is written as comparisons that also map NaN to the
+     * lower limit, matching _mm256_max_ps/_mm256_min_ps in the 8-wide path.
+     */
+    static int32_t toFixed(float coordinate, float scale) {
+        float scaled = coordinate * scale;
+        scaled = scaled > -FIXED_LIMIT ? scaled : -FIXED_LIMIT;
+        scaled = scaled < FIXED_LIMIT ? scaled : FIXED_LIMIT;
+        int32_t truncated = static_cast<int32_t>(scaled);
+        return truncated - (scaled < static_cast<float>(truncated) ? 1 : 0);
+    }
+
+    /**
+     * @brief Maps a texel coordinate into [0, size) by the wrap mode
+     * @param powerOfTwo The size is a power of two, so periods can be taken with a mask
+     */
+    int32_t wrapCoordinate(int32_t coordinate, int32_t size, bool powerOfTwo) const {
+        switch (wrap) {
+            case TextureWrap::CLAMP:
+                return std::clamp(coordinate, 0, size - 1);
+            case TextureWrap::MIRROR: {
+                // Every second period runs backwards: t in [size, 2 * size) maps to 2 * size - 1 - t
+                int32_t period = 2 * size;
+                int32_t t = powerOfTwo ? (coordinate & (period - 1)) : positiveModulo(coordinate, period);
+                return t < size ? t : period - 1 - t;
+            }
+            case TextureWrap::REPEAT:
+            default:
+                return powerOfTwo ? (coordinate & (size - 1)) : positiveModulo(coordinate, size);
+        }
+    }
+
+    /**
+     * @brief Modulo whose result has the sign of the divisor
+     */
+    static int32_t positiveModulo(int32_t value, int32_t divisor) {
+        int32_t remainder = value % divisor;
+        return remainder < 0 ? remainder + divisor : remainder;
+    }
+
+    /**
+     * @brief Index of a texel within the pixel data of a level
+     */
+    static size_t texelIndex(const Level& level, int32_t x, int32_t y) {
+        if (level.mortonColumns) {
+            return level.mortonColumns[x] | level.mortonRows[y];
+        }
+        if (Texture::isBlockCompressed(level.format)) {
+            size_t block = static_cast<size_t>(y >> 2) * ((level.width + 3) >> 2) + (x >> 2);
+            return block * 16 + ((y & 3) << 2) + (x & 3);
+        }
+        return static_cast<size_t>(y) * level.width + x;
+    }
+
+    /**
+     * @brief Reads the texel at an index of a level as ARGB
+     */
+    static uint32_t fetchTexel(const Level& level, size_t index) {
+        return Texture::fetchTexel(level.texels, index, level.format);
+    }
+
+    /**
+     * @brief Interpolates two texels on their packed 8-bit channels
+     *
+     * The 0x00RR00BB and 0x00AA00GG halves of a texel hold two channels each,
+     * and their products with a weight up to 256 fit the 16 bits of a channel,
+     * so two channels are weighted per multiply.
+     *
+     * @param weight Weight of b, 0 to 256
+     */
+    static uint32_t lerpTexels(uint32_t a, uint32_t b, uint32_t weight) {
+        uint32_t rb = ((a & 0x00FF00FF) * (256 - weight) + (b & 0x00FF00FF) * weight) >> 8;
+        uint32_t ag = (((a >> 8) & 0x00FF00FF) * (256 - weight) + ((b >> 8) & 0x00FF00FF) * weight) >> 8;
+        return (rb & 0x00FF00FF) | ((ag & 0x00FF00FF) << 8);
+    }
+
+#ifdef __AVX2__
+    /**
+     * @brief 8-wide toFixed
+     */
+    static __m256i toFixed(__m256 coordinate, float scale) {
+        __m256 scaled = _mm256_mul_ps(coordinate, _mm256_set1_ps(scale));
+        scaled = _mm256_max_ps(scaled, _mm256_set1_ps(-FIXED_LIMIT));
+        scaled = _mm256_min_ps(scaled, _mm256_set1_ps(FIXED_LIMIT));
+        return _mm256_cvttps_epi32(_mm256_floor_ps(scaled));
+    }
+
+    /**
+     * @brief 8-wide wrapCoordinate
+     */
+    __m256i wrapCoordinate(__m256i coordinate, int32_t size, bool powerOfTwo) const {
+        const __m256i sizes = _mm256_set1_epi32(size);
+        switch (wrap) {
+            case TextureWrap::CLAMP:
+                return _mm256_min_epi32(_mm256_max_epi32(coordinate, _mm256_setzero_si256()),
+                                        _mm256_sub_epi32(sizes, _mm256_set1_epi32(1)));
+            case TextureWrap::MIRROR: {
+                int32_t period = 2 * size;
+                __m256i t = powerOfTwo ? _mm256_and_si256(coordinate, _mm256_set1_epi32(period - 1))
+                                       : positiveModulo(coordinate, period);
+                __m256i forwards = _mm256_cmpgt_epi32(sizes, t);
+                return _mm256_blendv_epi8(_mm256_sub_epi32(_mm256_set1_epi32(period - 1), t), t, forwards);
+            }
+            case TextureWrap::REPEAT:
+            default:
+                return powerOfTwo ? _mm256_and_si256(coordinate, _mm256_set1_epi32(size - 1))
+                                  : positiveModulo(coordinate, size);
+        }
+    }
+
+    /**
+     * @brief 8-wide positiveModulo; AVX2 has no integer division, so the quotient is estimated in float and corrected
+     */
+    static __m256i positiveModulo(__m256i value, int32_t divisor) {
+        const __m256i divisors = _mm256_set1_epi32(divisor);
+        __m256 quotient = _mm256_floor_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(value), _mm256_set1_ps(1.0f / divisor)));
+        __m256i remainder = _mm256_sub_epi32(value, _mm256_mullo_epi32(_mm256_cvttps_epi32(quotient), divisors));
+        remainder = _mm256_add_epi32(remainder, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), remainder), divisors));
+        remainder = _mm256_sub_epi32(remainder, _mm256_andnot_si256(_mm256_cmpgt_epi32(divisors, remainder), divisors));
+        return remainder;
+    }
+
+    /**
+     * @brief 8-wide fetchTexel
+     *
+     * Compact texels are gathered as 32-bit words at their byte offsets (the
+     * padding after the pixel data keeps the last one in bounds) and decoded
+     * as Texture::decodeTexel does; block texels are decoded from their
+     * blocks as Texture::fetchTexel does.
+     *
+     * @param mask Lanes to fetch; the others return 0
+     */
+    static __m256i gatherTexels(const Level& level, __m256i index, __m256i mask) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+        const int* base = reinterpret_cast<const int*>(level.texels);
+        switch (level.format) {
+            case TextureFormat::RGB565: {
+                __m256i value = _mm256_mask_i32gather_epi32(zero, base, index, mask, 2);
+                return _mm256_and_si256(expandRGB565(value), mask);
+            }
+            case TextureFormat::RG8: {
+                __m256i value = _mm256_mask_i32gather_epi32(zero, base, index, mask, 2);
+                __m256i color = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(value, _mm256_set1_epi32(0xFF)), 16),
+                                                _mm256_and_si256(value, _mm256_set1_epi32(0xFF00)));
+                return _mm256_and_si256(_mm256_or_si256(color, opaque), mask);
+            }
+            case TextureFormat::R8: {
+                __m256i value = _mm256_and_si256(_mm256_mask_i32gather_epi32(zero, base, index, mask, 1), _mm256_set1_epi32(0xFF));
+                __m256i color = _mm256_or_si256(_mm256_or_si256(value, _mm256_slli_epi32(value, 8)), _mm256_slli_epi32(value, 16));
+                return _mm256_and_si256(_mm256_or_si256(color, opaque), mask);
+            }
+            case TextureFormat::BC1:
+                return gatherBC1Texels(level.texels, index, mask);
+            case TextureFormat::BC3:
+                return gatherBC3Texels(level.texels, index, mask);
+            case TextureFormat::RGBA8:
+            default:
+                return _mm256_mask_i32gather_epi32(zero, base, index, mask, 4);
+        }
+    }
+
+    /**
+     * @brief 8-wide texelIndex
+     */
+    static __m256i texelIndex(const Level& level, __m256i x, __m256i y) {
+        if (level.mortonColumns) {
+            // The per-axis tables are small and stay in L1, gathering from them beats spreading the bits in registers
+            return _mm256_or_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(level.mortonColumns), x, 4),
+                                   _mm256_i32gather_epi32(reinterpret_cast<const int*>(level.mortonRows), y, 4));
+        }
+        if (Texture::isBlockCompressed(level.format)) {
+            __m256i block = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(y, 2), _mm256_set1_epi32((level.width + 3) >> 2)),
+                                             _mm256_srli_epi32(x, 2));
+            __m256i slot = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(y, _mm256_set1_epi32(3)), 2),
+                                           _mm256_and_si256(x, _mm256_set1_epi32(3)));
+            return _mm256_or_si256(_mm256_slli_epi32(block, 4), slot);
+        }
+        return _mm256_add_epi32(_mm256_mullo_epi32(y, _mm256_set1_epi32(level.width)), x);
+    }
+
+    /**
+     * @brief 8-wide lerpTexels: 16-bit multiplies weight 16 channels at once
+     * @param weight Per-lane weight of b, 0 to 256
+     */
+    static __m256i lerpTexels(__m256i a, __m256i b, __m256i weight) {
+        const __m256i channelMask = _mm256_set1_epi32(0x00FF00FF);
+
+        // Weights repeated in both 16-bit halves of a lane, one per channel of a pair
+        weight = _mm256_or_si256(weight, _mm256_slli_epi32(weight, 16));
+        __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi32(0x01000100), weight);
+
+        __m256i rb = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(a, channelMask), inverse),
+                                      _mm256_mullo_epi16(_mm256_and_si256(b, channelMask), weight));
+        __m256i ag = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(a, 8), channelMask), inverse),
+                                      _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(b, 8), channelMask), weight));
+        return _mm256_or_si256(_mm256_srli_epi16(rb, 8), _mm256_andnot_si256(channelMask, ag));
+    }
+
+    /**
+     * @brief Samples 8 pixels, each from its own mip level
+     *
+     * Neighbouring pixels nearly always share a level, so this loops over the
+     * distinct levels present and fetches the lanes of each from that level.
+     */
+    __m256i sampleLevels(__m256 u, __m256 v, __m256i level, bool bilinear, __m256i mask) const;
+#endif
+
+    const Texture* texture;                 // Bound texture, may be null
+    TextureFilter filter;                   // Filter in use
+    TextureWrap wrap;                       // Wrap mode in use
+    std::array<Level, MAX_LEVELS> levels;   // Addressing of the mip levels
+    int levelCount;                         // Number of valid entries in levels
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Persistent pool of worker threads used by the rendering pipeline
+ *
+ * Workers are created once and sleep between jobs, so dispatching a frame's
+ * worth of tiles does not pay for thread creation. The calling thread takes
+ * part in every job, which means a pool with a thread count of 1 runs
+ * everything inline.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Constructor
+     * @param threadCount Total number of threads including the caller (0 = hardware concurrency)
+     */
+    explicit ThreadPool(unsigned int threadCount = 0);
+
+    /**
+     * @brief Stops and joins all worker threads
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Runs task(i) for every i in [0, count) and waits for completion
+     * @param count Number of work items
+     * @param task Function invoked once per work item, possibly concurrently
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    /**
+     * @brief Gets the number of threads that execute work, including the caller
+     * @return Thread count
+     */
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+    /**
+     * @brief Gets the thread count a pool constructed with the given count would have
+     * @param threadCount Requested thread count (0 = hardware concurrency)
+     * @return Thread count, at least 1
+     */
+    static unsigned int resolveThreadCount(unsigned int threadCount) {
+        return threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief Gets the index of the calling thread, for picking per-thread scratch storage inside a task
+     * @return 1 to getThreadCount() - 1 on worker threads, 0 on any other thread (including the caller)
+     */
+    static unsigned int getThreadIndex();
+
+private:
+    /**
+     * @brief Main loop of a worker thread
+     * @param index Thread index reported by getThreadIndex on this worker
+     */
+    void workerLoop(unsigned int index);
+
+    /**
+     * @brief Pulls work items of the current job until none are left
+     */
+    void runItems();
+
+    std::vector<std::thread> workers;               // Worker threads (the caller is not included)
+    std::mutex mutex;                               // Guards the job state below
+    std::condition_variable jobAvailable;           // Signals workers that a new job was posted
+    std::condition_variable jobFinished;            // Signals the caller that all workers are idle
+
+    const std::function<void(size_t)>* task = nullptr; // Task of the current job
+    size_t taskCount = 0;                           // Number of items in the current job
+    std::atomic<size_t> nextItem{0};                // Next unclaimed work item
+    size_t generation = 0;                          // Incremented for every posted job
+    unsigned int busyWorkers = 0;                   // Workers still running the current job
+    bool stopping = false;                          // Set when the pool is being destroyed
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Half-open pixel rectangle [x0, x1) x [y0, y1) covered by one screen tile
+ */
+struct TileRect {
+    int x0, y0;     // Inclusive top-left corner
+    int x1, y1;     // Exclusive bottom-right corner
+};
+
+/**
+ * @brief Sorts screen-space primitives into fixed-size tiles
+ *
+ * Primitives are submitted in chunks so that several threads can bin at the
+ * same time. Every chunk keeps its own per-tile index lists, and tiles visit
+ * chunks in order, so a tile always sees primitives in submission order no
+ * matter how many threads did the binning.
+ */
+class TileBinner {
+public:
+    static constexpr int TILE_SIZE = 64;    // Tile edge length in pixels
+
+    /**
+     * @brief Constructor
+     * @param width Width of the render target
+     * @param height Height of the render target
+     */
+    TileBinner(int width, int height);
+
+    /**
+     * @brief Discards all binned primitives and prepares a number of chunks
+     * @param chunkCount Number of chunks that will be submitted
+     */
+    void reset(size_t chunkCount);
+
+    /**
+     * @brief Records a primitive's screen-space bounds in a chunk
+     * @param chunk Chunk the primitive belongs to
+     * @param minX, minY Minimum corner of the primitive's bounding box
+     * @param maxX, maxY Maximum corner of the primitive's bounding box
+     * @return True if the primitive overlaps the render target and was recorded,
+     *         false if it was discarded. Accepted primitives of a chunk are
+     *         numbered consecutively starting at 0.
+     */
+    bool addPrimitive(size_t chunk, float minX, float minY, float maxX, float maxY);
+
+    /**
+     * @brief Builds the per-tile index lists of a chunk once all its primitives are added
+     * @param chunk Chunk to finalize
+     */
+    void finishChunk(size_t chunk);
+
+    /**
+     * @brief Visits all primitives overlapping a tile in submission order
+     * @param tile Tile index
+     * @param visit Callable invoked as visit(chunk, primitiveIndex)
+     */
+    template<typename Visitor>
+    void forEachPrimitive(int tile, Visitor&& visit) const {
+        for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+            const ChunkBins& bins = chunks[chunk];
+            for (uint32_t i = bins.offsets[tile]; i < bins.offsets[tile + 1]; ++i) {
+                visit(chunk, bins.indices[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of tiles covering the render target
+     * @return Tile count
+     */
+    int getTileCount() const { return tilesX * tilesY; }
+
+    /**
+     * @brief Gets the pixel rectangle of a tile, clamped to the render target
+     * @param tile Tile index
+     * @return Tile rectangle
+     */
+    TileRect getTileRect(int tile) const;
+
+private:
+    /**
+     * @brief Inclusive range of tiles touched by one primitive
+     */
+    struct TileRange {
+        uint16_t x0, y0, x1, y1;
+    };
+
+    /**
+     * @brief Binning state of one chunk of primitives
+     */
+    struct ChunkBins {
+        std::vector<TileRange> ranges;      // Tile range of every accepted primitive
+        std::vector<uint32_t> offsets;      // Start of each tile's list in indices (tileCount + 1 entries)
+        std::vector<uint32_t> indices;      // Primitive indices grouped by tile
+    };
+
+    int width;                          // Width of the render target
+    int height;                         // Height of the render target
+    int tilesX;                         // Number of tile columns
+    int tilesY;                         // Number of tile rows
+    std::vector<ChunkBins> chunks;      // Per-chunk bins, reused between frames
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ScreenTriangle.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Plane equation of an attribute over the screen, relative to an origin
+ *
+ * value(x, y) = a * (x - originX) + b * (y - originY) + c. Keeping the
+ * origin at a corner of the triangle keeps the terms small, so slivers do
+ * not lose precision to cancellation.
+ */
+struct AttributePlane {
+    float a, b, c;      // Change per pixel in x and y, value at the origin
+
+    /**
+     * @brief Evaluates the plane at an offset from the origin
+     * @param dx, dy Offset of the pixel from the origin of the triangle setup
+     */
+    float at(float dx, float dy) const { return a * dx + (b * dy + c); }
+};
+
+/**
+ * @brief Attribute plane equations of one triangle, computed once before rasterization
+ *
+ * Every rasterizer evaluates the planes directly at the pixels it visits, so
+ * attributes no longer have to be stepped along edges and spans. Depth is
+ * affine in screen space and interpolated as it is. Texture coordinates,
+ * light intensity and light direction are interpolated perspective-correctly: their planes hold
+ * attribute / w next to a plane for 1 / w, and a pixel recovers the attribute
+ * as (attribute / w) / (1 / w).
+ */
+struct TriangleSetup {
+    float originX, originY;         // Screen position of corner 0, the planes are relative to it
+    AttributePlane depth;           // Depth (z / w)
+    AttributePlane inverseW;        // 1 / w
+    AttributePlane uOverW;          // u / w
+    AttributePlane vOverW;          // v / w
+    AttributePlane intensityOverW;  // Light intensity / w
+    AttributePlane lightXOverW;     // Light direction / w, per component (normal-mapped mode)
+    AttributePlane lightYOverW;
+    AttributePlane lightZOverW;
+
+    /**
+     * @brief Computes the attribute planes of a triangle
+     * @param triangle Screen-space triangle; a zero-area triangle gets constant planes with the values of corner 0
+     */
+    explicit TriangleSetup(const ScreenTriangle& triangle);
+};
+
+#ifdef __AVX2__
+/**
+ * @brief Evaluates 8 attribute planes at 8 offsets from their origins
+ *
+ * Shared by all SIMD paths, so the same pixel yields bit-identical values
+ * regardless of which path evaluates it.
+ */
+inline __m256 evaluatePlane(__m256 a, __m256 b, __m256 c, __m256 dx, __m256 dy) {
+    return _mm256_fmadd_ps(a, dx, _mm256_fmadd_ps(b, dy, c));
+}
+#endif
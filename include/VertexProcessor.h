@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Dense>
+#include "ThreadPool.h"
+
+/**
+ * @brief Vertex processing stage with a post-transform cache
+ *
+ * Transforms every model vertex exactly once per frame (model-view-projection,
+ * perspective divide and viewport mapping) and keeps the results in
+ * structure-of-arrays form, so the per-face setup only reads them by index.
+ * Clip-space positions and outcodes are kept as well, so primitives that
+ * need clipping or lie outside the view frustum can be identified without
+ * transforming again.
+ * Vertices are processed in batches of 8 with AVX2 when available; batches
+ * without any vertex of a visible meshlet are skipped.
+ */
+class VertexProcessor {
+public:
+    /**
+     * @brief Transforms all vertex positions into clip and screen space
+     * @param positions Model-space vertex positions
+     * @param vertexMask Non-zero for the vertices that are needed; the others are skipped in batches of 8
+     * @param mvp Model-view-projection matrix
+     * @param width Width of the viewport in pixels
+     * @param height Height of the viewport in pixels
+     * @param threadPool Pool used to transform batches of vertices in parallel
+     */
+    void process(const std::vector<Eigen::Vector3f>& positions, const std::vector<uint8_t>& vertexMask,
+                 const Eigen::Matrix4f& mvp, int width, int height, ThreadPool& threadPool);
+
+    /**
+     * @brief Gets the screen-space X coordinates
+     * @return One entry per model vertex
+     */
+    const std::vector<float>& getScreenX() const { return screenX; }
+
+    /**
+     * @brief Gets the screen-space Y coordinates
+     * @return One entry per model vertex
+     */
+    const std::vector<float>& getScreenY() const { return screenY; }
+
+    /**
+     * @brief Gets the normalized device depth (z / w) used for depth testing
+     * @return One entry per model vertex
+     */
+    const std::vector<float>& getDepth() const { return depth; }
+
+    /**
+     * @brief Gets the clip-space position of a vertex
+     * @param index Model vertex index
+     * @return Homogeneous clip-space position
+     */
+    Eigen::Vector4f getClipPosition(int index) const {
+        return Eigen::Vector4f(clipX[index], clipY[index], clipZ[index], clipW[index]);
+    }
+
+    /**
+     * @brief Gets the clip and frustum outcodes (see Clipper::Plane)
+     * @return One entry per model vertex; screen-space values are only valid where it is 0
+     */
+    const std::vector<uint16_t>& getOutcodes() const { return outcodes; }
+
+private:
+    static constexpr size_t VERTICES_PER_TASK = 16384;  // Vertices transformed by one pool task
+
+    /**
+     * @brief Transforms the vertices in [begin, end)
+     */
+    void processRange(const std::vector<Eigen::Vector3f>& positions, const std::vector<uint8_t>& vertexMask,
+                      const Eigen::Matrix4f& mvp, int width, int height, size_t begin, size_t end);
+
+    std::vector<float> clipX;       // Clip-space X per vertex
+    std::vector<float> clipY;       // Clip-space Y per vertex
+    std::vector<float> clipZ;       // Clip-space Z per vertex
+    std::vector<float> clipW;       // Clip-space W per vertex
+    std::vector<uint16_t> outcodes; // Planes each vertex lies outside of
+    std::vector<float> screenX;     // Screen-space X per vertex
+    std::vector<float> screenY;     // Screen-space Y per vertex
+    std::vector<float> depth;       // Depth (z / w) per vertex
+};
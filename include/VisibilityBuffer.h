@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PixelShading.h"
+#include "ScreenTriangle.h"
+#include "Texture.h"
+#include "TileBinner.h"
+#include "TriangleSetup.h"
+
+/**
+ * @brief Visible triangle ids of the pixels of one screen tile
+ *
+ * Pixels are stored row by row with a stride of TILE_SIZE, relative to the
+ * top-left corner of the tile. No interpolation payload is needed: the
+ * shading pass evaluates the triangle's attribute planes at the pixel itself.
+ */
+struct VisibilityTile {
+    static constexpr int STRIDE = TileBinner::TILE_SIZE;               // Row stride in pixels
+    static constexpr int PIXELS = STRIDE * TileBinner::TILE_SIZE;      // Pixels per tile
+
+    uint32_t triangleIds[PIXELS];   // Visible triangle per pixel
+};
+
+/**
+ * @brief Deferred shading of the textured modes from per-pixel triangle ids
+ *
+ * The visibility pass only resolves depth and records, for every pixel, which
+ * triangle is visible. Texturing and
+ * lighting then run once per visible pixel in a linear sweep over the tile,
+ * instead of once per depth test that happens to pass while triangles are
+ * still being drawn.
+ *
+ * The payload is kept per tile in a buffer owned by the rasterizing thread, so
+ * it stays in cache between the two passes and never round-trips through
+ * memory. Shading a pixel resets its id, which leaves the buffer empty for the
+ * next tile without a separate clear.
+ */
+class VisibilityBuffer {
+public:
+    static constexpr uint32_t NO_TRIANGLE = 0xFFFFFFFF;    // Id of pixels not covered by any triangle
+
+    /**
+     * @brief Lighting applied by the shading pass, fixed for a frame
+     */
+    enum class Shading {
+        TEXTURED,           // Intensity of the first corner
+        TEXTURED_SHADED,    // Interpolated corner intensities
+        NORMAL_MAPPED       // Intensity from a normal map and the interpolated light direction
+    };
+
+    /**
+     * @brief Constructor
+     * @param frameBuffer Color buffer the shading pass writes into
+     * @param width Width of the color buffer in pixels
+     */
+    VisibilityBuffer(std::vector<uint32_t>& frameBuffer, int width);
+
+    /**
+     * @brief Assigns ids to the triangles of a frame and prepares their shading attributes
+     * @param triangles Binned triangles of the frame, per chunk; ids are assigned in chunk order
+     * @param setups Attribute planes of the binned triangles, per chunk
+     * @param threadCount Number of threads that rasterize tiles, each gets its own tile buffer
+     * @param shading Lighting of the frame; only the normal-mapped shading stores the light direction planes
+     */
+    void setTriangles(const std::vector<std::vector<ScreenTriangle>>& triangles,
+                      const std::vector<std::vector<TriangleSetup>>& setups, unsigned int threadCount, Shading shading);
+
+    /**
+     * @brief Gets the id of a binned triangle
+     * @param chunk Chunk of the triangle
+     * @param index Index of the triangle within its chunk
+     * @return Triangle id to store in the visibility pass
+     */
+    uint32_t getTriangleId(size_t chunk, uint32_t index) const { return chunkFirstId[chunk] + index; }
+
+    /**
+     * @brief Gets the empty tile buffer of the calling thread
+     * @return Tile buffer to record the visibility pass of one tile in
+     */
+    VisibilityTile& getTile();
+
+    /**
+     * @brief Shades every covered pixel of a tile exactly once and empties the tile buffer
+     * @param tile Tile buffer filled by the visibility pass
+     * @param clip Tile rectangle the buffer was filled for
+     * @param sampler Texture and filter to use
+     * @param normalSampler Normal map for the normal-mapped shading (null otherwise)
+     */
+    void shade(VisibilityTile& tile, const TileRect& clip, const TextureSampler& sampler, const TextureSampler* normalSampler);
+
+private:
+    /**
+     * @brief Shading attributes of one triangle: plane origin, plane coefficients and the flat intensity
+     *
+     * The light direction planes come last, so the other shadings store and
+     * fetch only the attributes before LX_A.
+     */
+    enum Attribute {
+        ORIGIN_X, ORIGIN_Y,
+        W_A, W_B, W_C,          // 1 / w
+        U_A, U_B, U_C,          // u / w
+        V_A, V_B, V_C,          // v / w
+        I_A, I_B, I_C,          // Intensity / w
+        INTENSITY,              // Intensity of corner 0 (TEXTURED)
+        LX_A, LX_B, LX_C,       // Light direction x / w (NORMAL_MAPPED)
+        LY_A, LY_B, LY_C,       // Light direction y / w
+        LZ_A, LZ_B, LZ_C,       // Light direction z / w
+        ATTRIBUTE_COUNT
+    };
+
+    std::vector<uint32_t>& frameBuffer;     // Color buffer
+    int width;                              // Width of the color buffer
+    std::vector<uint32_t> chunkFirstId;     // Id of the first triangle of each chunk
+    Shading shading = Shading::TEXTURED;    // Lighting of the current frame
+    int stride = LX_A;                      // Attributes stored per triangle for the shading
+    std::vector<float> attributes;          // stride values per triangle, indexed by id
+    std::vector<VisibilityTile> tiles;      // One tile buffer per rasterizing thread
+};
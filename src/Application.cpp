@@ -34,19 +34,13 @@ bool Application::initialize() {
 
 bool Application::loadModel(const std::string& filename) {
     try {
-        // Get file extension
-        fs::path path(filename);
-        std::string extension = path.extension().string().substr(1); // Remove the dot
-        
-        // Get appropriate loader
-        auto loader = ModelLoaderFactory::createLoader(extension);
-        if (!loader) {
-            spdlog::error("No loader available for file extension: {}", extension);
+        // Load the model with the loader for its extension, or from its mesh cache
+        auto loaded = ModelLoaderFactory::loadModel(filename);
+        if (!loaded) {
+            spdlog::error("No loader available for file: {}", filename);
             return false;
         }
-        
-        // Load the model
-        model = loader->loadModel(filename);
+        model = loaded;
         spdlog::info("Model loaded successfully");
         return true;
     }
@@ -63,19 +57,11 @@ bool Application::setTexture(const std::string& filename) {
     }
     
     try {
-        // Get file extension
-        fs::path path(filename);
-        std::string extension = path.extension().string().substr(1); // Remove the dot
-        
-        // Get appropriate texture loader
-        auto loader = TextureLoaderFactory::createLoader(extension);
-        if (!loader) {
-            spdlog::error("No texture loader available for file extension: {}", extension);
+        // Load the texture, or share it if another model already loaded the same file
+        auto texture = TextureLoaderFactory::loadTexture(filename);
+        if (!texture) {
             return false;
         }
-        
-        // Load the texture
-        auto texture = loader->loadTexture(filename);
         model->setTexture(texture);
         spdlog::info("Texture set successfully");
         return true;
@@ -86,6 +72,21 @@ bool Application::setTexture(const std::string& filename) {
     }
 }
 
+bool Application::setNormalMap(const std::string& filename, NormalSpace space) {
+    if (!model) {
+        spdlog::error("No model loaded. Load a model before setting a normal map");
+        return false;
+    }
+    
+    auto normalMap = TextureLoaderFactory::loadTexture(filename);
+    if (!normalMap) {
+        return false;
+    }
+    model->setNormalMap(normalMap, space);
+    spdlog::info("Normal map set successfully ({} space)", space == NormalSpace::TANGENT ? "tangent" : "object");
+    return true;
+}
+
 void Application::setCameraPosition(float x, float y, float z) {
     if (renderer) {
         renderer->setCameraPosition(Eigen::Vector3f(x, y, z));
@@ -114,12 +115,78 @@ void Application::setRenderMode(RenderMode mode) {
             case RenderMode::COLORFUL:
                 modeName = "COLORFUL";
                 break;
+            case RenderMode::NORMAL_MAPPED:
+                modeName = "NORMAL_MAPPED";
+                break;
         }
         
         spdlog::info("Render mode set to {}", modeName);
     }
 }
 
+void Application::setThreadCount(unsigned int threadCount) {
+    if (renderer) {
+        renderer->setThreadCount(threadCount);
+        spdlog::info("Rendering with {} threads", renderer->getThreadCount());
+    }
+}
+
+void Application::setRasterBackend(RasterBackend backend) {
+    if (renderer) {
+        renderer->setRasterBackend(backend);
+        const char* names[] = {"SCANLINE", "EDGE", "VISIBILITY"};
+        spdlog::info("Rasterizer backend set to {}", names[static_cast<int>(backend)]);
+    }
+}
+
+void Application::setTextureFilter(TextureFilter filter) {
+    if (renderer) {
+        renderer->setTextureFilter(filter);
+        const char* names[] = {"NEAREST", "BILINEAR", "NEAREST_MIPMAP", "TRILINEAR"};
+        spdlog::info("Texture filter set to {}", names[static_cast<int>(filter)]);
+    }
+}
+
+void Application::setTextureWrap(TextureWrap wrap) {
+    if (renderer) {
+        renderer->setTextureWrap(wrap);
+        const char* names[] = {"REPEAT", "CLAMP", "MIRROR"};
+        spdlog::info("Texture wrap mode set to {}", names[static_cast<int>(wrap)]);
+    }
+}
+
+bool Application::setTextureFormat(TextureFormat format) {
+    if (!model || !model->getTexture()) {
+        spdlog::error("No texture loaded. Set a texture before choosing its format");
+        return false;
+    }
+    
+    // The loaded texture may be shared through the texture cache, so convert a copy
+    auto texture = std::make_shared<Texture>(*model->getTexture());
+    texture->setFormat(format);
+    model->setTexture(texture);
+    const char* names[] = {"RGBA8", "RGB565", "RG8", "R8", "BC1", "BC3"};
+    spdlog::info("Texture format set to {}, {} KiB including mip levels",
+                 names[static_cast<int>(format)], texture->getMemoryUsage() / 1024);
+    return true;
+}
+
+void Application::setCullMode(CullMode mode) {
+    if (renderer) {
+        renderer->setCullMode(mode);
+        const char* names[] = {"NONE", "BACK", "FRONT"};
+        spdlog::info("Cull mode set to {}", names[static_cast<int>(mode)]);
+    }
+}
+
+void Application::setShaderLook(ShaderLook look) {
+    shaderLook = look;
+    if (look != ShaderLook::NONE) {
+        const char* names[] = {"NONE", "TOON", "NORMALS", "AMBIENT_OCCLUSION"};
+        spdlog::info("Shader look set to {}", names[static_cast<int>(look)]);
+    }
+}
+
 bool Application::render() {
     if (!renderer) {
         spdlog::error("Renderer not initialized");
@@ -133,7 +200,31 @@ bool Application::render() {
     
     try {
         renderer->clearBuffer();
-        renderer->render(*model);
+        
+        // Shader programs sample level 0 with the filter and wrap mode of the textured modes
+        std::optional<TextureSampler> boundTexture;
+        if (model->getTexture()) {
+            boundTexture.emplace(renderer->bindSampler(model->getTexture().get()));
+        }
+        const TextureSampler* sampler = boundTexture ? &*boundTexture : nullptr;
+        switch (shaderLook) {
+            case ShaderLook::NONE:
+                renderer->render(*model);
+                break;
+            case ShaderLook::TOON:
+                renderer->renderProgram(*model, ToonVertexShader{ Eigen::Vector3f(1, 1, 1).normalized() },
+                                        ToonFragmentShader{ sampler });
+                break;
+            case ShaderLook::NORMALS:
+                renderer->renderProgram(*model, NormalVertexShader{}, NormalFragmentShader{});
+                break;
+            case ShaderLook::AMBIENT_OCCLUSION: {
+                std::vector<float> occlusion = computeVertexOcclusion(*model);
+                renderer->renderProgram(*model, OcclusionVertexShader{ &occlusion },
+                                        OcclusionFragmentShader{ sampler });
+                break;
+            }
+        }
         spdlog::info("Model rendered successfully");
         return true;
     }
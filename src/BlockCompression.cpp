@@ -0,0 +1,145 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+int channel(uint32_t color, int shift) {
+    return static_cast<int>((color >> shift) & 0xFF);
+}
+
+int colorDistance(uint32_t a, uint32_t b) {
+    int dr = channel(a, 16) - channel(b, 16);
+    int dg = channel(a, 8) - channel(b, 8);
+    int db = channel(a, 0) - channel(b, 0);
+    return dr * dr + dg * dg + db * db;
+}
+
+/**
+ * @brief Fits the color endpoints of a tile and returns its color block words
+ * @param included Texels that take part in the fit; the others are left at selector 3
+ * @param fourColors Four-color mode, which needs the first endpoint greater; otherwise three colors and transparency
+ */
+void compressColors(const uint32_t texels[16], const bool included[16], bool fourColors, uint32_t words[2]) {
+    int low[3] = { 255, 255, 255 }, high[3] = { 0, 0, 0 };
+    int count = 0;
+    for (int i = 0; i < 16; ++i) {
+        if (!included[i]) {
+            continue;
+        }
+        for (int c = 0; c < 3; ++c) {
+            int value = channel(texels[i], 16 - 8 * c);
+            low[c] = std::min(low[c], value);
+            high[c] = std::max(high[c], value);
+        }
+        ++count;
+    }
+    if (count == 0) {
+        words[0] = 0;
+        words[1] = 0xFFFFFFFF;  // Every texel transparent
+        return;
+    }
+
+    // The channel with the widest range leads; channels falling while it rises run the other way along the box diagonal
+    int lead = 0;
+    for (int c = 1; c < 3; ++c) {
+        if (high[c] - low[c] > high[lead] - low[lead]) {
+            lead = c;
+        }
+    }
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; ++i) {
+        if (included[i]) {
+            for (int c = 0; c < 3; ++c) {
+                mean[c] += static_cast<float>(channel(texels[i], 16 - 8 * c)) / static_cast<float>(count);
+            }
+        }
+    }
+    int start[3], end[3];
+    for (int c = 0; c < 3; ++c) {
+        float covariance = 0.0f;
+        for (int i = 0; i < 16; ++i) {
+            if (included[i]) {
+                covariance += (static_cast<float>(channel(texels[i], 16 - 8 * lead)) - mean[lead]) *
+                              (static_cast<float>(channel(texels[i], 16 - 8 * c)) - mean[c]);
+            }
+        }
+        // Insetting by a sixteenth of the range moves the endpoints onto the colors a four-color palette represents best
+        int inset = (high[c] - low[c]) / 16;
+        start[c] = high[c] - inset;
+        end[c] = low[c] + inset;
+        if (covariance < 0.0f) {
+            std::swap(start[c], end[c]);
+        }
+    }
+
+    uint32_t c0 = packRGB565(static_cast<uint32_t>(start[0]), static_cast<uint32_t>(start[1]), static_cast<uint32_t>(start[2]));
+    uint32_t c1 = packRGB565(static_cast<uint32_t>(end[0]), static_cast<uint32_t>(end[1]), static_cast<uint32_t>(end[2]));
+    if (fourColors ? c0 < c1 : c0 > c1) {
+        std::swap(c0, c1);
+    }
+    words[0] = c0 | (c1 << 16);
+
+    // Each texel takes the closest color of the palette the decoder builds
+    uint32_t palette[4];
+    for (uint32_t s = 0; s < 4; ++s) {
+        palette[s] = decodeBC1Color(words[0], s, fourColors);
+    }
+    int choices = c0 == c1 ? 1 : (fourColors ? 4 : 3);
+    words[1] = 0;
+    for (int i = 0; i < 16; ++i) {
+        uint32_t selector = 3;
+        if (included[i]) {
+            selector = 0;
+            for (int s = 1; s < choices; ++s) {
+                if (colorDistance(texels[i], palette[s]) < colorDistance(texels[i], palette[selector])) {
+                    selector = static_cast<uint32_t>(s);
+                }
+            }
+        }
+        words[1] |= selector << (2 * i);
+    }
+}
+
+} // namespace
+
+void compressBC1Block(const uint32_t texels[16], uint8_t* block) {
+    bool included[16];
+    bool transparent = false;
+    for (int i = 0; i < 16; ++i) {
+        included[i] = (texels[i] >> 24) >= 128;
+        transparent = transparent || !included[i];
+    }
+    uint32_t words[2];
+    compressColors(texels, included, !transparent, words);
+    std::memcpy(block, words, sizeof(words));
+}
+
+void compressBC3Block(const uint32_t texels[16], uint8_t* block) {
+    uint32_t a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; ++i) {
+        a0 = std::max(a0, texels[i] >> 24);
+        a1 = std::min(a1, texels[i] >> 24);
+    }
+    uint64_t alphaBlock = a0 | (a1 << 8);
+    if (a0 > a1) {
+        for (int i = 0; i < 16; ++i) {
+            uint32_t alpha = texels[i] >> 24;
+            uint64_t best = 0;
+            for (uint32_t s = 1; s < 8; ++s) {
+                if (std::abs(static_cast<int>(decodeBC3Alpha(a0, a1, s)) - static_cast<int>(alpha)) <
+                    std::abs(static_cast<int>(decodeBC3Alpha(a0, a1, static_cast<uint32_t>(best))) - static_cast<int>(alpha))) {
+                    best = s;
+                }
+            }
+            alphaBlock |= best << (16 + 3 * i);
+        }
+    }
+    std::memcpy(block, &alphaBlock, sizeof(alphaBlock));
+
+    bool included[16];
+    std::fill(included, included + 16, true);
+    uint32_t words[2];
+    compressColors(texels, included, true, words);
+    std::memcpy(block + 8, words, sizeof(words));
+}
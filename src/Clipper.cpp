@@ -0,0 +1,124 @@
+#include "Clipper.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * @brief Signed distance of a vertex to a clip plane, non-negative inside
+     */
+    float planeDistance(const ClipVertex& vertex, Clipper::Plane plane) {
+        switch (plane) {
+            case Clipper::NEAR:         return vertex.z + vertex.w;
+            case Clipper::GUARD_LEFT:   return Clipper::GUARD_BAND * vertex.w + vertex.x;
+            case Clipper::GUARD_RIGHT:  return Clipper::GUARD_BAND * vertex.w - vertex.x;
+            case Clipper::GUARD_BOTTOM: return Clipper::GUARD_BAND * vertex.w + vertex.y;
+            case Clipper::GUARD_TOP:    return Clipper::GUARD_BAND * vertex.w - vertex.y;
+            default:                    return 0.0f;
+        }
+    }
+
+    /**
+     * @brief Linear interpolation of all vertex components (valid in homogeneous space)
+     */
+    ClipVertex lerp(const ClipVertex& a, const ClipVertex& b, float t) {
+        ClipVertex result;
+        result.x = a.x + (b.x - a.x) * t;
+        result.y = a.y + (b.y - a.y) * t;
+        result.z = a.z + (b.z - a.z) * t;
+        result.w = a.w + (b.w - a.w) * t;
+        result.u = a.u + (b.u - a.u) * t;
+        result.v = a.v + (b.v - a.v) * t;
+        result.intensity = a.intensity + (b.intensity - a.intensity) * t;
+        for (int i = 0; i < 3; ++i) {
+            result.light[i] = a.light[i] + (b.light[i] - a.light[i]) * t;
+        }
+        return result;
+    }
+
+    const Clipper::Plane CLIP_PLANE_LIST[] = {
+        Clipper::NEAR, Clipper::GUARD_LEFT, Clipper::GUARD_RIGHT, Clipper::GUARD_BOTTOM, Clipper::GUARD_TOP
+    };
+}
+
+uint16_t Clipper::computeOutcode(float x, float y, float z, float w) {
+    uint16_t code = 0;
+    if (z < -w) code |= NEAR;
+    if (x < -GUARD_BAND * w) code |= GUARD_LEFT;
+    if (x > GUARD_BAND * w) code |= GUARD_RIGHT;
+    if (y < -GUARD_BAND * w) code |= GUARD_BOTTOM;
+    if (y > GUARD_BAND * w) code |= GUARD_TOP;
+    if (z > w) code |= FAR;
+    if (x < -w) code |= LEFT;
+    if (x > w) code |= RIGHT;
+    if (y < -w) code |= BOTTOM;
+    if (y > w) code |= TOP;
+    return code;
+}
+
+int Clipper::clipPolygon(ClipVertex* vertices, int count, uint16_t planes) {
+    ClipVertex scratch[MAX_POLYGON_VERTICES];
+
+    for (Plane plane : CLIP_PLANE_LIST) {
+        if (!(planes & plane)) {
+            continue;
+        }
+
+        // Clip every edge of the current polygon against this plane
+        int outCount = 0;
+        for (int i = 0; i < count; ++i) {
+            const ClipVertex& current = vertices[i];
+            const ClipVertex& next = vertices[(i + 1) % count];
+            float dCurrent = planeDistance(current, plane);
+            float dNext = planeDistance(next, plane);
+
+            if (dCurrent >= 0.0f) {
+                scratch[outCount++] = current;
+            }
+            if ((dCurrent >= 0.0f) != (dNext >= 0.0f)) {
+                scratch[outCount++] = lerp(current, next, dCurrent / (dCurrent - dNext));
+            }
+        }
+
+        count = outCount;
+        for (int i = 0; i < count; ++i) {
+            vertices[i] = scratch[i];
+        }
+        if (count < 3) {
+            return 0;
+        }
+    }
+
+    return count;
+}
+
+bool Clipper::clipLine(ClipVertex& a, ClipVertex& b, uint16_t planes) {
+    // Liang-Barsky style: shrink the parametric range [tMin, tMax] plane by plane
+    float tMin = 0.0f;
+    float tMax = 1.0f;
+
+    for (Plane plane : CLIP_PLANE_LIST) {
+        if (!(planes & plane)) {
+            continue;
+        }
+
+        float dA = planeDistance(a, plane);
+        float dB = planeDistance(b, plane);
+        if (dA < 0.0f && dB < 0.0f) {
+            return false;
+        }
+        if (dA < 0.0f) {
+            tMin = std::max(tMin, dA / (dA - dB));
+        } else if (dB < 0.0f) {
+            tMax = std::min(tMax, dA / (dA - dB));
+        }
+    }
+
+    if (tMin > tMax) {
+        return false;
+    }
+
+    ClipVertex start = lerp(a, b, tMin);
+    ClipVertex end = lerp(a, b, tMax);
+    a = start;
+    b = end;
+    return true;
+}
@@ -16,14 +16,32 @@ void CommandLineParser::printUsage(const std::string& programName) {
     std::cout << "  --help                   Display this help message" << std::endl;
     std::cout << "  --input <obj_file>       Input OBJ model file (required unless --generate-test-textures is used)" << std::endl;
     std::cout << "  --texture <tga_file>     Input TGA texture file" << std::endl;
+    std::cout << "  --normal-map <tga_file>  Input TGA normal map for the normalmapped mode" << std::endl;
+    std::cout << "  --normal-space <space>   Space of the normal map's normals (default: tangent)" << std::endl;
+    std::cout << "                           Spaces: tangent, object" << std::endl;
     std::cout << "  --output <tga_file>      Output TGA image file (default: output.tga)" << std::endl;
     std::cout << "  --width <pixels>         Width of the output image (default: 800)" << std::endl;
     std::cout << "  --height <pixels>        Height of the output image (default: 600)" << std::endl;
     std::cout << "  --mode <mode>            Rendering mode (default: wireframe)" << std::endl;
-    std::cout << "                           Modes: wireframe, solid, textured, shaded" << std::endl;
+    std::cout << "                           Modes: wireframe, solid, textured, shaded, colorful, normalmapped" << std::endl;
     std::cout << "  --camera-x <value>       Camera X position (default: 0)" << std::endl;
     std::cout << "  --camera-y <value>       Camera Y position (default: 0)" << std::endl;
     std::cout << "  --camera-z <value>       Camera Z position (default: 5)" << std::endl;
+    std::cout << "  --raster <backend>       Triangle rasterizer (default: scanline)" << std::endl;
+    std::cout << "                           Backends: scanline, edge, visibility" << std::endl;
+    std::cout << "  --filter <filter>        Texture filter of the textured modes (default: nearest)" << std::endl;
+    std::cout << "                           Filters: nearest, bilinear, mipmap, trilinear" << std::endl;
+    std::cout << "  --wrap <mode>            Texture wrap mode of the textured modes (default: repeat)" << std::endl;
+    std::cout << "                           Modes: repeat, clamp, mirror" << std::endl;
+    std::cout << "  --texture-format <fmt>   Storage of the texture (default: rgba8, r8 for grayscale files)" << std::endl;
+    std::cout << "                           Formats: rgba8, rgb565, rg8, r8, bc1, bc3" << std::endl;
+    std::cout << "  --texture-cache <MiB>    Memory budget of the shared texture cache (default: 256)" << std::endl;
+    std::cout << "  --no-mesh-cache          Parse the model file, without reading or writing its .srmesh cache" << std::endl;
+    std::cout << "  --cull <mode>            Triangle facing to cull (default: back)" << std::endl;
+    std::cout << "                           Modes: none, back, front" << std::endl;
+    std::cout << "  --shader <look>          Render with a shader program instead of --mode" << std::endl;
+    std::cout << "                           Looks: toon, normals, ao" << std::endl;
+    std::cout << "  --threads <count>        Number of rendering threads (default: 0 = all cores)" << std::endl;
     std::cout << "  --generate-test-textures Generate test textures in the examples directory" << std::endl;
 }
 
@@ -68,11 +86,92 @@ std::optional<RenderMode> CommandLineParser::parseRenderModeArg(const std::strin
         if (*value == "textured") return RenderMode::TEXTURED;
         if (*value == "shaded") return RenderMode::TEXTURED_SHADED;
         if (*value == "colorful") return RenderMode::COLORFUL;
+        if (*value == "normalmapped") return RenderMode::NORMAL_MAPPED;
         throw std::runtime_error("Unknown rendering mode: " + *value);
     }
     return std::nullopt;
 }
 
+std::optional<RasterBackend> CommandLineParser::parseRasterBackendArg(const std::string& argName) {
+    auto value = parseStringArg(argName);
+    if (value) {
+        if (*value == "scanline") return RasterBackend::SCANLINE;
+        if (*value == "edge") return RasterBackend::EDGE;
+        if (*value == "visibility") return RasterBackend::VISIBILITY;
+        throw std::runtime_error("Unknown rasterizer backend: " + *value);
+    }
+    return std::nullopt;
+}
+
+std::optional<TextureFilter> CommandLineParser::parseTextureFilterArg(const std::string& argName) {
+    auto value = parseStringArg(argName);
+    if (value) {
+        if (*value == "nearest") return TextureFilter::NEAREST;
+        if (*value == "bilinear") return TextureFilter::BILINEAR;
+        if (*value == "mipmap") return TextureFilter::NEAREST_MIPMAP;
+        if (*value == "trilinear") return TextureFilter::TRILINEAR;
+        throw std::runtime_error("Unknown texture filter: " + *value);
+    }
+    return std::nullopt;
+}
+
+std::optional<TextureWrap> CommandLineParser::parseTextureWrapArg(const std::string& argName) {
+    auto value = parseStringArg(argName);
+    if (value) {
+        if (*value == "repeat") return TextureWrap::REPEAT;
+        if (*value == "clamp") return TextureWrap::CLAMP;
+        if (*value == "mirror") return TextureWrap::MIRROR;
+        throw std::runtime_error("Unknown texture wrap mode: " + *value);
+    }
+    return std::nullopt;
+}
+
+std::optional<TextureFormat> CommandLineParser::parseTextureFormatArg(const std::string& argName) {
+    auto value = parseStringArg(argName);
+    if (value) {
+        if (*value == "rgba8") return TextureFormat::RGBA8;
+        if (*value == "rgb565") return TextureFormat::RGB565;
+        if (*value == "rg8") return TextureFormat::RG8;
+        if (*value == "r8") return TextureFormat::R8;
+        if (*value == "bc1") return TextureFormat::BC1;
+        if (*value == "bc3") return TextureFormat::BC3;
+        throw std::runtime_error("Unknown texture format: " + *value);
+    }
+    return std::nullopt;
+}
+
+std::optional<NormalSpace> CommandLineParser::parseNormalSpaceArg(const std::string& argName) {
+    auto value = parseStringArg(argName);
+    if (value) {
+        if (*value == "tangent") return NormalSpace::TANGENT;
+        if (*value == "object") return NormalSpace::OBJECT;
+        throw std::runtime_error("Unknown normal space: " + *value);
+    }
+    return std::nullopt;
+}
+
+std::optional<CullMode> CommandLineParser::parseCullModeArg(const std::string& argName) {
+    auto value = parseStringArg(argName);
+    if (value) {
+        if (*value == "none") return CullMode::NONE;
+        if (*value == "back") return CullMode::BACK;
+        if (*value == "front") return CullMode::FRONT;
+        throw std::runtime_error("Unknown cull mode: " + *value);
+    }
+    return std::nullopt;
+}
+
+std::optional<ShaderLook> CommandLineParser::parseShaderLookArg(const std::string& argName) {
+    auto value = parseStringArg(argName);
+    if (value) {
+        if (*value == "toon") return ShaderLook::TOON;
+        if (*value == "normals") return ShaderLook::NORMALS;
+        if (*value == "ao") return ShaderLook::AMBIENT_OCCLUSION;
+        throw std::runtime_error("Unknown shader look: " + *value);
+    }
+    return std::nullopt;
+}
+
 bool CommandLineParser::parseBoolArg(const std::string& argName) {
     for (const auto& arg : args) {
         if (arg == argName) {
@@ -94,16 +193,34 @@ RendererConfig CommandLineParser::parse() {
     // Parse all arguments
     if (auto input = parseStringArg("--input")) config.inputFile = *input;
     if (auto texture = parseStringArg("--texture")) config.textureFile = *texture;
+    if (auto normalMap = parseStringArg("--normal-map")) config.normalMapFile = *normalMap;
+    if (auto space = parseNormalSpaceArg("--normal-space")) config.normalSpace = *space;
     if (auto output = parseStringArg("--output")) config.outputFile = *output;
     if (auto width = parseIntArg("--width")) config.width = *width;
     if (auto height = parseIntArg("--height")) config.height = *height;
     if (auto mode = parseRenderModeArg("--mode")) config.renderMode = *mode;
+    if (auto backend = parseRasterBackendArg("--raster")) config.rasterBackend = *backend;
+    if (auto filter = parseTextureFilterArg("--filter")) config.textureFilter = *filter;
+    if (auto wrap = parseTextureWrapArg("--wrap")) config.textureWrap = *wrap;
+    if (auto format = parseTextureFormatArg("--texture-format")) config.textureFormat = *format;
+    if (auto cache = parseIntArg("--texture-cache")) config.textureCacheMiB = *cache;
+    if (auto cull = parseCullModeArg("--cull")) config.cullMode = *cull;
+    if (auto look = parseShaderLookArg("--shader")) config.shaderLook = *look;
     if (auto x = parseFloatArg("--camera-x")) config.cameraX = *x;
     if (auto y = parseFloatArg("--camera-y")) config.cameraY = *y;
     if (auto z = parseFloatArg("--camera-z")) config.cameraZ = *z;
+    if (auto threads = parseIntArg("--threads")) config.threads = *threads;
+    config.meshCache = !parseBoolArg("--no-mesh-cache");
     config.generateTestTextures = parseBoolArg("--generate-test-textures");
     
     // Validate required arguments
+    if (config.threads < 0) {
+        throw std::runtime_error("Thread count must not be negative");
+    }
+    if (config.textureCacheMiB && *config.textureCacheMiB < 0) {
+        throw std::runtime_error("Texture cache budget must not be negative");
+    }
+    
     if (config.inputFile.empty() && !config.generateTestTextures) {
         throw std::runtime_error("Input file is required unless --generate-test-textures is used");
     }
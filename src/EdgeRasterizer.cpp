@@ -0,0 +1,348 @@
+#include "EdgeRasterizer.h"
+#include "PixelShading.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int LANES = 8;    // Pixels processed per step
+
+/**
+ * @brief Bound for the integer edge functions at the start of a row
+ *
+ * Along one row inside a tile an edge function changes by at most
+ * |a| * SUBPIXEL_SCALE * (TILE_SIZE + LANES), which stays well below this
+ * bound for positions inside the guard band of targets up to 8K. Clamping the
+ * row start therefore keeps the sign of every pixel in the row, while the
+ * stepping fits in 32 bits.
+ */
+constexpr int64_t ROW_START_LIMIT = int64_t(1) << 30;
+
+/**
+ * @brief Builds the edge function of the edge running from (xa, ya) to (xb, yb)
+ */
+EdgeFunction makeEdge(int32_t xa, int32_t ya, int32_t xb, int32_t yb) {
+    return { ya - yb, xb - xa, int64_t(yb - ya) * xa - int64_t(xb - xa) * ya, 0 };
+}
+
+/**
+ * @brief Converts a screen coordinate to 28.4 fixed point
+ */
+int32_t toFixed(float value) {
+    return static_cast<int32_t>(std::lround(value * EdgeRasterizer::SUBPIXEL_SCALE));
+}
+
+/**
+ * @brief Edge function value at the start of a row, clamped for 32-bit stepping (see ROW_START_LIMIT)
+ */
+int32_t rowStart(const EdgeFunction& e, int64_t x, int64_t y) {
+    return static_cast<int32_t>(std::clamp(e.evaluate(x, y) + e.bias, -ROW_START_LIMIT, ROW_START_LIMIT));
+}
+
+/**
+ * @brief Division rounding towards negative infinity
+ */
+int64_t floorDivide(int64_t numerator, int64_t denominator) {
+    int64_t quotient = numerator / denominator;
+    return (numerator % denominator != 0 && (numerator < 0) != (denominator < 0)) ? quotient - 1 : quotient;
+}
+
+} // namespace
+
+bool TriangleEdges::setup(const ScreenTriangle& t) {
+    constexpr int SUBPIXEL_BITS = EdgeRasterizer::SUBPIXEL_BITS;
+    constexpr int SUBPIXEL_SCALE = EdgeRasterizer::SUBPIXEL_SCALE;
+
+    // Non-finite positions cannot be converted to fixed point
+    for (int k = 0; k < 3; ++k) {
+        if (!std::isfinite(t.x[k]) || !std::isfinite(t.y[k])) {
+            return false;
+        }
+    }
+
+    // Snap the corners to the 28.4 subpixel grid; all coverage decisions below are exact integer math
+    int32_t fx[3], fy[3];
+    for (int k = 0; k < 3; ++k) {
+        fx[k] = toFixed(t.x[k]);
+        fy[k] = toFixed(t.y[k]);
+    }
+
+    // Signed area (24.8); degenerate triangles cover no pixels
+    int64_t area = int64_t(fx[1] - fx[0]) * (fy[2] - fy[0]) - int64_t(fx[2] - fx[0]) * (fy[1] - fy[0]);
+    if (area == 0) {
+        return false;
+    }
+
+    edges[0] = makeEdge(fx[1], fy[1], fx[2], fy[2]);
+    edges[1] = makeEdge(fx[2], fy[2], fx[0], fy[0]);
+    edges[2] = makeEdge(fx[0], fy[0], fx[1], fy[1]);
+
+    // Orient the edges so that the inside is positive for either winding
+    if (area < 0) {
+        for (EdgeFunction& e : edges) {
+            e.a = -e.a;
+            e.b = -e.b;
+            e.c = -e.c;
+        }
+    }
+
+    // Top-left fill rule: samples exactly on an edge only belong to the triangle that has the edge on
+    // its left side (inside to the right, a > 0) or on its top side (horizontal, inside below; y points
+    // up in the saved image, so b < 0). A shared edge is thereby drawn by exactly one of its triangles.
+    for (EdgeFunction& e : edges) {
+        e.bias = (e.a > 0 || (e.a == 0 && e.b < 0)) ? 0 : -1;
+    }
+
+    // Bounding box in whole pixels (pixels are sampled at integer coordinates)
+    minX = (std::min({fx[0], fx[1], fx[2]}) + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS;
+    minY = (std::min({fy[0], fy[1], fy[2]}) + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS;
+    maxX = std::max({fx[0], fx[1], fx[2]}) >> SUBPIXEL_BITS;
+    maxY = std::max({fy[0], fy[1], fy[2]}) >> SUBPIXEL_BITS;
+    return true;
+}
+
+bool TriangleEdges::rowSpan(int y, int& xStart, int& xEnd) const {
+    constexpr int64_t SUBPIXEL_SCALE = EdgeRasterizer::SUBPIXEL_SCALE;
+    xStart = minX;
+    xEnd = maxX;
+
+    // Solve a * x * SUBPIXEL_SCALE + rest >= 0 for each edge, where rest holds the row's part of the biased function
+    for (const EdgeFunction& e : edges) {
+        int64_t rest = e.evaluate(0, int64_t(y) * SUBPIXEL_SCALE) + e.bias;
+        if (e.a > 0) {
+            xStart = static_cast<int>(std::max<int64_t>(xStart, -floorDivide(rest, e.a * SUBPIXEL_SCALE)));
+        } else if (e.a < 0) {
+            xEnd = static_cast<int>(std::min<int64_t>(xEnd, floorDivide(rest, -e.a * SUBPIXEL_SCALE)));
+        } else if (rest < 0) {
+            return false;
+        }
+    }
+    return xStart <= xEnd;
+}
+
+EdgeRasterizer::EdgeRasterizer(std::vector<uint32_t>& frameBuffer, std::vector<float>& zBuffer, int width)
+    : frameBuffer(frameBuffer), zBuffer(zBuffer), width(width) {
+}
+
+float EdgeRasterizer::snapToSubpixel(float value) {
+    return std::round(value * SUBPIXEL_SCALE) / SUBPIXEL_SCALE;
+}
+
+void EdgeRasterizer::drawTriangle(const ScreenTriangle& triangle, const TileRect& clip) {
+    rasterize<Shading::FLAT>(triangle, nullptr, nullptr, nullptr, 0, nullptr, clip);
+}
+
+void EdgeRasterizer::drawDepthTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup, const TileRect& clip) {
+    rasterize<Shading::FLAT_DEPTH>(triangle, &setup, nullptr, nullptr, 0, nullptr, clip);
+}
+
+void EdgeRasterizer::drawTexturedTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                                          const TextureSampler& sampler, const TileRect& clip) {
+    rasterize<Shading::TEXTURED>(triangle, &setup, &sampler, nullptr, 0, nullptr, clip);
+}
+
+void EdgeRasterizer::drawShadedTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                                        const TextureSampler& sampler, const TileRect& clip) {
+    rasterize<Shading::TEXTURED_SHADED>(triangle, &setup, &sampler, nullptr, 0, nullptr, clip);
+}
+
+void EdgeRasterizer::drawNormalMappedTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                                              const TextureSampler& sampler, const TextureSampler& normalSampler,
+                                              const TileRect& clip) {
+    rasterize<Shading::NORMAL_MAPPED>(triangle, &setup, &sampler, &normalSampler, 0, nullptr, clip);
+}
+
+void EdgeRasterizer::drawVisibilityTriangle(const ScreenTriangle& triangle, const TriangleSetup& setup,
+                                            uint32_t id, VisibilityTile& tile, const TileRect& clip) {
+    rasterize<Shading::VISIBILITY>(triangle, &setup, nullptr, nullptr, id, &tile, clip);
+}
+
+template<EdgeRasterizer::Shading S>
+void EdgeRasterizer::rasterize(const ScreenTriangle& t, const TriangleSetup* setup, const TextureSampler* sampler,
+                               const TextureSampler* normalSampler, uint32_t id, VisibilityTile* tile, const TileRect& clip) {
+    constexpr bool depthTest = (S != Shading::FLAT);
+    constexpr bool textured = (S == Shading::TEXTURED || S == Shading::TEXTURED_SHADED || S == Shading::NORMAL_MAPPED);
+
+    TriangleEdges triangleEdges;
+    if (!triangleEdges.setup(t)) {
+        return;
+    }
+    const EdgeFunction& e0 = triangleEdges.edges[0];
+    const EdgeFunction& e1 = triangleEdges.edges[1];
+    const EdgeFunction& e2 = triangleEdges.edges[2];
+
+    // Bounding box scissored to the tile
+    int minX = std::max(clip.x0, triangleEdges.minX);
+    int minY = std::max(clip.y0, triangleEdges.minY);
+    int maxX = std::min(clip.x1 - 1, triangleEdges.maxX);
+    int maxY = std::min(clip.y1 - 1, triangleEdges.maxY);
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
+    const int64_t startX = int64_t(minX) * SUBPIXEL_SCALE;
+
+#ifdef __AVX2__
+    const __m256 laneOffsets = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i laneIndices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+
+    // Edge functions at the 8 lanes relative to the first one, and their 8-pixel step
+    const __m256i laneStep0 = _mm256_mullo_epi32(laneIndices, _mm256_set1_epi32(e0.a * SUBPIXEL_SCALE));
+    const __m256i laneStep1 = _mm256_mullo_epi32(laneIndices, _mm256_set1_epi32(e1.a * SUBPIXEL_SCALE));
+    const __m256i laneStep2 = _mm256_mullo_epi32(laneIndices, _mm256_set1_epi32(e2.a * SUBPIXEL_SCALE));
+    const __m256i step0 = _mm256_set1_epi32(e0.a * SUBPIXEL_SCALE * LANES);
+    const __m256i step1 = _mm256_set1_epi32(e1.a * SUBPIXEL_SCALE * LANES);
+    const __m256i step2 = _mm256_set1_epi32(e2.a * SUBPIXEL_SCALE * LANES);
+
+    for (int y = minY; y <= maxY; ++y) {
+        const int64_t sampleY = int64_t(y) * SUBPIXEL_SCALE;
+
+        // Edge functions at the first 8 pixels of the row
+        __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(rowStart(e0, startX, sampleY)), laneStep0);
+        __m256i c1 = _mm256_add_epi32(_mm256_set1_epi32(rowStart(e1, startX, sampleY)), laneStep1);
+        __m256i c2 = _mm256_add_epi32(_mm256_set1_epi32(rowStart(e2, startX, sampleY)), laneStep2);
+
+        for (int x = minX; x <= maxX; x += LANES,
+             c0 = _mm256_add_epi32(c0, step0), c1 = _mm256_add_epi32(c1, step1), c2 = _mm256_add_epi32(c2, step2)) {
+            // Coverage: no biased edge function negative (sign bit clear in their OR), not past the end of the span
+            __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(maxX - x + 1), laneIndices);
+            __m256i inside = _mm256_cmpgt_epi32(_mm256_or_si256(_mm256_or_si256(c0, c1), c2), minusOne);
+            mask = _mm256_and_si256(mask, inside);
+            if (_mm256_testz_si256(mask, mask)) {
+                continue;
+            }
+
+            int index = y * width + x;
+
+            // Depth test against the z-buffer
+            __m256 dx, dy, z;
+            if constexpr (depthTest) {
+                dx = _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneOffsets),
+                                   _mm256_set1_ps(setup->originX));
+                dy = _mm256_sub_ps(_mm256_set1_ps(static_cast<float>(y)), _mm256_set1_ps(setup->originY));
+                z = evaluatePlane(_mm256_set1_ps(setup->depth.a), _mm256_set1_ps(setup->depth.b),
+                                  _mm256_set1_ps(setup->depth.c), dx, dy);
+                __m256 stored = _mm256_maskload_ps(&zBuffer[index], mask);
+                mask = _mm256_and_si256(mask, _mm256_castps_si256(_mm256_cmp_ps(z, stored, _CMP_LT_OQ)));
+                if (_mm256_testz_si256(mask, mask)) {
+                    continue;
+                }
+            }
+
+            // The visibility pass stores the triangle id and leaves shading for later
+            if constexpr (S == Shading::VISIBILITY) {
+                int tileIndex = (y - clip.y0) * VisibilityTile::STRIDE + (x - clip.x0);
+                _mm256_maskstore_epi32(reinterpret_cast<int*>(&tile->triangleIds[tileIndex]), mask,
+                                       _mm256_set1_epi32(static_cast<int>(id)));
+                _mm256_maskstore_ps(&zBuffer[index], mask, z);
+                continue;
+            }
+
+            // Shade the covered lanes
+            __m256i color;
+            if constexpr (textured) {
+                auto evaluate = [&](const AttributePlane& plane) {
+                    return evaluatePlane(_mm256_set1_ps(plane.a), _mm256_set1_ps(plane.b), _mm256_set1_ps(plane.c), dx, dy);
+                };
+                __m256 w = _mm256_div_ps(_mm256_set1_ps(1.0f), evaluate(setup->inverseW));
+                __m256 u = _mm256_mul_ps(evaluate(setup->uOverW), w);
+                __m256 v = _mm256_mul_ps(evaluate(setup->vOverW), w);
+                __m256 intensity = _mm256_set1_ps(t.intensity[0]);
+                if constexpr (S == Shading::TEXTURED_SHADED) {
+                    intensity = _mm256_mul_ps(evaluate(setup->intensityOverW), w);
+                }
+                const __m256 uA = _mm256_set1_ps(setup->uOverW.a), uB = _mm256_set1_ps(setup->uOverW.b);
+                const __m256 vA = _mm256_set1_ps(setup->vOverW.a), vB = _mm256_set1_ps(setup->vOverW.b);
+                const __m256 wA = _mm256_set1_ps(setup->inverseW.a), wB = _mm256_set1_ps(setup->inverseW.b);
+                __m256i texel = sampleTexture(*sampler, uA, uB, vA, vB, wA, wB, w, u, v, mask);
+                if constexpr (S == Shading::NORMAL_MAPPED) {
+                    __m256i normal = sampleTexture(*normalSampler, uA, uB, vA, vB, wA, wB, w, u, v, mask);
+                    intensity = normalMapIntensity(normal, _mm256_mul_ps(evaluate(setup->lightXOverW), w),
+                                                   _mm256_mul_ps(evaluate(setup->lightYOverW), w),
+                                                   _mm256_mul_ps(evaluate(setup->lightZOverW), w));
+                }
+                color = applyLighting(texel, intensity);
+            } else {
+                color = _mm256_set1_epi32(static_cast<int>(t.color));
+            }
+
+            // Write the covered lanes
+            _mm256_maskstore_epi32(reinterpret_cast<int*>(&frameBuffer[index]), mask, color);
+            if constexpr (depthTest) {
+                _mm256_maskstore_ps(&zBuffer[index], mask, z);
+            }
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; ++y) {
+        const int64_t sampleY = int64_t(y) * SUBPIXEL_SCALE;
+
+        // Edge functions at the first pixel of the row
+        int32_t rowC0 = rowStart(e0, startX, sampleY);
+        int32_t rowC1 = rowStart(e1, startX, sampleY);
+        int32_t rowC2 = rowStart(e2, startX, sampleY);
+
+        for (int x = minX; x <= maxX; x += LANES,
+             rowC0 += e0.a * SUBPIXEL_SCALE * LANES, rowC1 += e1.a * SUBPIXEL_SCALE * LANES,
+             rowC2 += e2.a * SUBPIXEL_SCALE * LANES) {
+            int lanes = std::min(LANES, maxX - x + 1);
+            for (int lane = 0; lane < lanes; ++lane) {
+                if ((rowC0 + e0.a * SUBPIXEL_SCALE * lane) < 0 ||
+                    (rowC1 + e1.a * SUBPIXEL_SCALE * lane) < 0 ||
+                    (rowC2 + e2.a * SUBPIXEL_SCALE * lane) < 0) {
+                    continue;
+                }
+
+                int index = y * width + x + lane;
+
+                // Depth test against the z-buffer
+                float dx = 0.0f, dy = 0.0f, z = 0.0f;
+                if constexpr (depthTest) {
+                    dx = static_cast<float>(x + lane) - setup->originX;
+                    dy = static_cast<float>(y) - setup->originY;
+                    z = setup->depth.at(dx, dy);
+                    if (!(z < zBuffer[index])) {
+                        continue;
+                    }
+                }
+
+                // The visibility pass stores the triangle id and leaves shading for later
+                if constexpr (S == Shading::VISIBILITY) {
+                    int tileIndex = (y - clip.y0) * VisibilityTile::STRIDE + (x + lane - clip.x0);
+                    tile->triangleIds[tileIndex] = id;
+                    zBuffer[index] = z;
+                    continue;
+                }
+
+                // Shade and write the pixel
+                uint32_t color = t.color;
+                if constexpr (textured) {
+                    float w = 1.0f / setup->inverseW.at(dx, dy);
+                    float u = setup->uOverW.at(dx, dy) * w;
+                    float v = setup->vOverW.at(dx, dy) * w;
+                    float intensity = t.intensity[0];
+                    if constexpr (S == Shading::TEXTURED_SHADED) {
+                        intensity = setup->intensityOverW.at(dx, dy) * w;
+                    }
+                    if constexpr (S == Shading::NORMAL_MAPPED) {
+                        uint32_t normal = sampleTexture(*normalSampler, setup->uOverW, setup->vOverW, setup->inverseW, w, u, v);
+                        intensity = normalMapIntensity(normal, setup->lightXOverW.at(dx, dy) * w,
+                                                       setup->lightYOverW.at(dx, dy) * w, setup->lightZOverW.at(dx, dy) * w);
+                    }
+                    color = applyLighting(sampleTexture(*sampler, setup->uOverW, setup->vOverW, setup->inverseW, w, u, v),
+                                          intensity);
+                }
+
+                frameBuffer[index] = color;
+                if constexpr (depthTest) {
+                    zBuffer[index] = z;
+                }
+            }
+        }
+    }
+#endif
+}
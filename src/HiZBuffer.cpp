@@ -0,0 +1,68 @@
+#include "HiZBuffer.h"
+#include <algorithm>
+#include <limits>
+
+HiZBuffer::HiZBuffer(const std::vector<float>& zBuffer, int width, int height)
+    : zBuffer(zBuffer), width(width), height(height),
+      blocksX((width + BLOCK_SIZE - 1) / BLOCK_SIZE),
+      blocksY((height + BLOCK_SIZE - 1) / BLOCK_SIZE),
+      maxDepth(blocksX * blocksY, std::numeric_limits<float>::infinity()),
+      dirty(blocksX * blocksY, 0) {
+}
+
+void HiZBuffer::clear() {
+    std::fill(maxDepth.begin(), maxDepth.end(), std::numeric_limits<float>::infinity());
+    std::fill(dirty.begin(), dirty.end(), 0);
+}
+
+bool HiZBuffer::isOccluded(int x0, int y0, int x1, int y1, float minDepth) {
+    int bx0 = x0 / BLOCK_SIZE, by0 = y0 / BLOCK_SIZE;
+    int bx1 = x1 / BLOCK_SIZE, by1 = y1 / BLOCK_SIZE;
+
+    for (int by = by0; by <= by1; ++by) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+            int block = by * blocksX + bx;
+
+            // The stored maximum is an upper bound, so it can prove occlusion even when stale
+            if (minDepth >= maxDepth[block]) {
+                continue;
+            }
+            if (!dirty[block]) {
+                return false;
+            }
+
+            refreshBlock(bx, by);
+            if (!(minDepth >= maxDepth[block])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void HiZBuffer::markDirty(int x0, int y0, int x1, int y1) {
+    for (int by = y0 / BLOCK_SIZE; by <= y1 / BLOCK_SIZE; ++by) {
+        for (int bx = x0 / BLOCK_SIZE; bx <= x1 / BLOCK_SIZE; ++bx) {
+            dirty[by * blocksX + bx] = 1;
+        }
+    }
+}
+
+void HiZBuffer::refreshBlock(int bx, int by) {
+    int x0 = bx * BLOCK_SIZE;
+    int y0 = by * BLOCK_SIZE;
+    int x1 = std::min(width, x0 + BLOCK_SIZE);
+    int y1 = std::min(height, y0 + BLOCK_SIZE);
+
+    float blockMax = -std::numeric_limits<float>::infinity();
+    for (int y = y0; y < y1; ++y) {
+        const float* row = &zBuffer[y * width];
+        for (int x = x0; x < x1; ++x) {
+            blockMax = std::max(blockMax, row[x]);
+        }
+    }
+
+    int block = by * blocksX + bx;
+    maxDepth[block] = blockMax;
+    dirty[block] = 0;
+}
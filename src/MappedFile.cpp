@@ -0,0 +1,130 @@
+#include "MappedFile.h"
+#include <spdlog/spdlog.h>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+#ifdef _WIN32
+        mapping = std::exchange(other.mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        spdlog::error("Could not open file: {}", filename);
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        spdlog::error("Could not get the size of file: {}", filename);
+        CloseHandle(file);
+        return false;
+    }
+    if (fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return true;
+    }
+
+    // The mapping keeps the file open, so the handle can be closed right away
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        spdlog::error("Could not map file: {}", filename);
+        return false;
+    }
+    bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes) {
+        spdlog::error("Could not map file: {}", filename);
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) {
+        UnmapViewOfFile(bytes);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    bytes = nullptr;
+    length = 0;
+    mapping = nullptr;
+}
+#else
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        spdlog::error("Could not open file: {}", filename);
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        spdlog::error("Could not get the size of file: {}", filename);
+        ::close(fd);
+        return false;
+    }
+    if (status.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    // The mapping keeps the file open, so the descriptor can be closed right away
+    void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        spdlog::error("Could not map file: {}", filename);
+        return false;
+    }
+
+    // Parsers read front to back
+    madvise(address, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+    bytes = static_cast<const char*>(address);
+    length = static_cast<size_t>(status.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes) {
+        munmap(const_cast<char*>(bytes), length);
+    }
+    bytes = nullptr;
+    length = 0;
+}
+#endif
@@ -1,120 +1,266 @@
 #include "Model.h"
+#include "OBJParser.h"
 #include "Texture.h"
 #include <spdlog/spdlog.h>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <string>
 #include <memory>
 #include <stdexcept>
 #include <iostream>
 
-Model::Model(const std::string& filename) {
-    if (!loadFromOBJ(filename)) {
-        throw std::runtime_error("Failed to load model from " + filename);
+namespace {
+
+// Result of checking a polygon's indices into one attribute array
+enum class IndexCheck {
+    VALID,      // Every corner has an index in range
+    ABSENT,     // Some corner has none (-1), so the polygon goes without the attribute
+    INVALID     // Some index is out of range
+};
+
+IndexCheck checkIndices(const int* indices, uint32_t count, size_t size) {
+    bool absent = false;
+    for (uint32_t k = 0; k < count; ++k) {
+        if (indices[k] == -1) {
+            absent = true;
+        } else if (indices[k] < 0 || static_cast<size_t>(indices[k]) >= size) {
+            return IndexCheck::INVALID;
+        }
     }
+    return absent ? IndexCheck::ABSENT : IndexCheck::VALID;
 }
 
-bool Model::loadFromOBJ(const std::string& filename) {
-    spdlog::info("Loading model from OBJ file: {}", filename);
-    
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        spdlog::error("Could not open OBJ file: {}", filename);
-        return false;
+/**
+ * @brief Cuts a polygon into triangles, given as corner numbers of the polygon
+ *
+ * The corners are projected onto the coordinate plane facing the polygon's
+ * Newell normal. Convex polygons become a fan around corner 0; others are
+ * ear-clipped, and whatever is left when no ear can be found (degenerate or
+ * self-intersecting outlines) is fanned as well. Triangles keep the winding
+ * of the polygon.
+ *
+ * @param vertices Vertex positions
+ * @param indices Vertex indices of the corners, all valid
+ * @param count Number of corners, at least 3
+ * @param triangles Receives the triangles
+ */
+void triangulatePolygon(const std::vector<Eigen::Vector3f>& vertices, const int* indices, uint32_t count,
+                        std::vector<std::array<uint32_t, 3>>& triangles) {
+    if (count == 3) {
+        triangles.push_back({0, 1, 2});
+        return;
     }
     
-    // Clear existing data
-    vertices.clear();
-    textureCoords.clear();
-    normals.clear();
-    faces.clear();
+    Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+    for (uint32_t k = 0; k < count; ++k) {
+        const Eigen::Vector3f& a = vertices[indices[k]];
+        const Eigen::Vector3f& b = vertices[indices[(k + 1) % count]];
+        normal += Eigen::Vector3f((a.y() - b.y()) * (a.z() + b.z()),
+                                  (a.z() - b.z()) * (a.x() + b.x()),
+                                  (a.x() - b.x()) * (a.y() + b.y()));
+    }
     
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
-        
-        if (prefix == "v") {
-            parseVertex(iss);
-        } 
-        else if (prefix == "vt") {
-            parseTextureCoord(iss);
-        } 
-        else if (prefix == "vn") {
-            parseNormal(iss);
-        } 
-        else if (prefix == "f") {
-            parseFace(iss);
-        }
+    // Drop the dominant axis, keeping the others in cyclic order so that the
+    // winding in the plane follows the normal; flip it to counter-clockwise
+    int axis = 0;
+    normal.cwiseAbs().maxCoeff(&axis);
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    const float orientation = normal[axis] < 0.0f ? -1.0f : 1.0f;
+    std::vector<Eigen::Vector2f> points(count);
+    for (uint32_t k = 0; k < count; ++k) {
+        const Eigen::Vector3f& p = vertices[indices[k]];
+        points[k] = Eigen::Vector2f(p[u], p[v] * orientation);
     }
+    auto turn = [&](uint32_t a, uint32_t b, uint32_t c) {
+        Eigen::Vector2f ab = points[b] - points[a];
+        Eigen::Vector2f bc = points[c] - points[b];
+        return ab.x() * bc.y() - ab.y() * bc.x();
+    };
     
-    file.close();
+    bool convex = normal[axis] != 0.0f;
+    for (uint32_t k = 0; convex && k < count; ++k) {
+        convex = turn(k, (k + 1) % count, (k + 2) % count) >= 0.0f;
+    }
     
-    spdlog::info("Model loaded successfully. Vertices: {}, Texture coords: {}, Normals: {}, Faces: {}", 
-        vertices.size(), textureCoords.size(), normals.size(), faces.size());
+    std::vector<uint32_t> remaining(count);
+    for (uint32_t k = 0; k < count; ++k) {
+        remaining[k] = k;
+    }
+    if (!convex && normal[axis] != 0.0f) {
+        // Clip ears: convex corners whose triangle contains no other remaining corner
+        size_t i = 0;
+        size_t tried = 0;
+        while (remaining.size() > 3 && tried < remaining.size()) {
+            size_t size = remaining.size();
+            i %= size;
+            uint32_t a = remaining[(i + size - 1) % size];
+            uint32_t b = remaining[i];
+            uint32_t c = remaining[(i + 1) % size];
+            bool ear = turn(a, b, c) > 0.0f;
+            for (size_t j = 0; ear && j < size; ++j) {
+                uint32_t k = remaining[j];
+                if (k != a && k != b && k != c &&
+                    turn(a, b, k) >= 0.0f && turn(b, c, k) >= 0.0f && turn(c, a, k) >= 0.0f) {
+                    ear = false;
+                }
+            }
+            if (ear) {
+                triangles.push_back({a, b, c});
+                remaining.erase(remaining.begin() + i);
+                tried = 0;
+            } else {
+                ++i;
+                ++tried;
+            }
+        }
+    }
     
-    return !vertices.empty() && !faces.empty();
-}
-
-void Model::parseVertex(std::istringstream& iss) {
-    float x, y, z;
-    iss >> x >> y >> z;
-    vertices.emplace_back(x, y, z);
+    for (size_t k = 1; k + 1 < remaining.size(); ++k) {
+        triangles.push_back({remaining[0], remaining[k], remaining[k + 1]});
+    }
 }
 
-void Model::parseTextureCoord(std::istringstream& iss) {
-    float u, v;
-    iss >> u >> v;
-    textureCoords.emplace_back(u, v);
-}
+} // namespace
 
-void Model::parseNormal(std::istringstream& iss) {
-    float x, y, z;
-    iss >> x >> y >> z;
-    normals.emplace_back(x, y, z);
+Model::Model(const std::string& filename) {
+    if (!loadFromOBJ(filename)) {
+        throw std::runtime_error("Failed to load model from " + filename);
+    }
 }
 
-void Model::parseFace(std::istringstream& iss) {
-    Face face;
-    std::string vertexData;
+bool Model::loadFromOBJ(const std::string& filename) {
+    spdlog::info("Loading model from OBJ file: {}", filename);
     
-    while (iss >> vertexData) {
-        parseFaceVertex(vertexData, face);
+    if (!OBJParser::loadFile(filename, *this)) {
+        spdlog::error("Could not open OBJ file: {}", filename);
+        return false;
     }
     
-    // Only add faces with at least 3 vertices
-    if (face.vertexIndices.size() >= 3) {
-        faces.push_back(face);
-    }
+    spdlog::info("Model loaded successfully. Vertices: {}, Texture coords: {}, Normals: {}, Triangles: {}", 
+        vertices.size(), textureCoords.size(), normals.size(), triangles.size());
+    
+    buildMeshlets();
+    buildTangentFrames();
+    
+    return !vertices.empty() && !triangles.empty();
 }
 
-void Model::parseFaceVertex(const std::string& vertexData, Face& face) {
-    std::istringstream viss(vertexData);
-    std::string indexStr;
+void Model::setPolygons(const Polygons& polygons) {
+    const size_t polygonCount = polygons.starts.size() - 1;
+    const size_t cornerCount = polygons.starts.back();
+    triangles.clear();
+    triangleFlags.clear();
+    if (cornerCount > 2 * polygonCount) {
+        triangles.reserve(cornerCount - 2 * polygonCount);
+        triangleFlags.reserve(cornerCount - 2 * polygonCount);
+    }
+    meshletsDirty = true;
+    tangentsDirty = true;
     
-    // Parse vertex index
-    std::getline(viss, indexStr, '/');
-    if (!indexStr.empty()) {
-        face.vertexIndices.push_back(parseIndex(indexStr));
+    // Welded vertices made from the same position are chained, so that a corner's combination
+    // is looked up among the few variants of its position instead of in a hash table
+    const uint32_t NONE = UINT32_MAX;
+    std::vector<uint32_t> firstVariant(vertices.size(), NONE);  // Latest vertex made from each position
+    std::vector<uint32_t> positionId(vertices.size(), NONE);    // Id of each position, once used
+    std::vector<uint32_t> nextVariant;                          // Per vertex, the previous one made from its position
+    std::vector<uint32_t> sourcePositions, sourceTextureCoords, sourceNormals;  // Per vertex, its combination
+    std::vector<uint32_t> ids;
+    uint32_t positionCount = 0;
+    bool anyTextureCoords = false;
+    bool anyNormals = false;
+    auto weld = [&](uint32_t position, uint32_t textureCoord, uint32_t normal) {
+        for (uint32_t v = firstVariant[position]; v != NONE; v = nextVariant[v]) {
+            if (sourceTextureCoords[v] == textureCoord && sourceNormals[v] == normal) {
+                return v;
+            }
+        }
+        uint32_t v = static_cast<uint32_t>(sourcePositions.size());
+        nextVariant.push_back(firstVariant[position]);
+        firstVariant[position] = v;
+        sourcePositions.push_back(position);
+        sourceTextureCoords.push_back(textureCoord);
+        sourceNormals.push_back(normal);
+        if (positionId[position] == NONE) {
+            positionId[position] = positionCount++;
+        }
+        ids.push_back(positionId[position]);
+        return v;
+    };
+    
+    std::vector<std::array<uint32_t, 3>> corners;
+    size_t dropped = 0;
+    for (size_t p = 0; p < polygonCount; ++p) {
+        const uint32_t begin = polygons.starts[p];
+        const uint32_t count = polygons.starts[p + 1] - begin;
+        if (count < 3) {
+            ++dropped;
+            continue;
+        }
+        const int* vertexIndices = polygons.vertexIndices.data() + begin;
+        const int* textureIndices = polygons.textureIndices.data() + begin;
+        const int* normalIndices = polygons.normalIndices.data() + begin;
+        IndexCheck textures = checkIndices(textureIndices, count, textureCoords.size());
+        IndexCheck normalCheck = checkIndices(normalIndices, count, normals.size());
+        if (checkIndices(vertexIndices, count, vertices.size()) != IndexCheck::VALID ||
+            textures == IndexCheck::INVALID || normalCheck == IndexCheck::INVALID) {
+            ++dropped;
+            continue;
+        }
+        uint8_t attributes = 0;
+        if (textures == IndexCheck::VALID) {
+            attributes |= HAS_TEXTURE_COORDS;
+            anyTextureCoords = true;
+        }
+        if (normalCheck == IndexCheck::VALID) {
+            attributes |= HAS_NORMALS;
+            anyNormals = true;
+        }
+        
+        corners.clear();
+        triangulatePolygon(vertices, vertexIndices, count, corners);
+        for (const auto& corner : corners) {
+            Triangle triangle;
+            uint8_t flags = attributes;
+            for (int k = 0; k < 3; ++k) {
+                uint32_t c = corner[k];
+                triangle.vertexIndices[k] = weld(static_cast<uint32_t>(vertexIndices[c]),
+                                                 textures == IndexCheck::VALID ? static_cast<uint32_t>(textureIndices[c]) : NONE,
+                                                 normalCheck == IndexCheck::VALID ? static_cast<uint32_t>(normalIndices[c]) : NONE);
+                if (corner[(k + 1) % 3] == (c + 1) % count) {
+                    flags |= 1 << k;
+                }
+            }
+            triangles.push_back(triangle);
+            triangleFlags.push_back(flags);
+        }
     }
     
-    // Parse texture coordinate index
-    std::getline(viss, indexStr, '/');
-    if (!indexStr.empty()) {
-        face.textureIndices.push_back(parseIndex(indexStr));
+    if (dropped > 0) {
+        spdlog::warn("Dropped {} polygons with fewer than three corners or indices out of range", dropped);
     }
     
-    // Parse normal vector index
-    std::getline(viss, indexStr, '/');
-    if (!indexStr.empty()) {
-        face.normalIndices.push_back(parseIndex(indexStr));
+    // Gather the vertex stream; vertices lacking an attribute the others have get zeros
+    const size_t vertexCount = sourcePositions.size();
+    std::vector<Eigen::Vector3f> weldedVertices(vertexCount);
+    std::vector<Eigen::Vector2f> weldedTextureCoords(anyTextureCoords ? vertexCount : 0, Eigen::Vector2f::Zero());
+    std::vector<Eigen::Vector3f> weldedNormals(anyNormals ? vertexCount : 0, Eigen::Vector3f::Zero());
+    for (size_t v = 0; v < vertexCount; ++v) {
+        weldedVertices[v] = vertices[sourcePositions[v]];
+        if (anyTextureCoords && sourceTextureCoords[v] != NONE) {
+            weldedTextureCoords[v] = textureCoords[sourceTextureCoords[v]];
+        }
+        if (anyNormals && sourceNormals[v] != NONE) {
+            weldedNormals[v] = normals[sourceNormals[v]];
+        }
     }
-}
-
-int Model::parseIndex(const std::string& indexStr) {
-    // OBJ indices are 1-based, convert to 0-based
-    return std::stoi(indexStr) - 1;
+    spdlog::info("Welded {} positions, {} texture coordinates and {} normals into {} vertices",
+                 vertices.size(), textureCoords.size(), normals.size(), vertexCount);
+    vertices = std::move(weldedVertices);
+    textureCoords = std::move(weldedTextureCoords);
+    normals = std::move(weldedNormals);
+    positionIds = std::move(ids);
 }
 
 void Model::setTexture(const std::string& texturePath) {
@@ -123,21 +269,16 @@ void Model::setTexture(const std::string& texturePath) {
         texture = std::make_shared<Texture>(texturePath);
         
         // Basic validation of texture coordinates
-        if (textureCoords.empty() && !faces.empty()) {
-            spdlog::warn("Model has faces but no texture coordinates. Texture mapping may not work correctly.");
+        if (textureCoords.empty() && !triangles.empty()) {
+            spdlog::warn("Model has triangles but no texture coordinates. Texture mapping may not work correctly.");
         }
         
-        // Check if any face has texture indices
-        bool hasTextureIndices = false;
-        for (const auto& face : faces) {
-            if (!face.textureIndices.empty()) {
-                hasTextureIndices = true;
-                break;
-            }
-        }
+        // Check if any triangle has texture indices
+        bool hasTextureIndices = std::any_of(triangleFlags.begin(), triangleFlags.end(),
+                                             [](uint8_t flags) { return (flags & HAS_TEXTURE_COORDS) != 0; });
         
         if (!hasTextureIndices) {
-            spdlog::warn("Model has no texture indices in faces. Texture mapping may not work correctly.");
+            spdlog::warn("Model has no texture indices in triangles. Texture mapping may not work correctly.");
         }
         
         spdlog::info("Texture loaded successfully: {}x{}", texture->getWidth(), texture->getHeight());
@@ -145,4 +286,225 @@ void Model::setTexture(const std::string& texturePath) {
         spdlog::error("Failed to load texture: {}", e.what());
         throw;
     }
-} 
\ No newline at end of file
+}
+
+const std::vector<Model::Meshlet>& Model::getMeshlets() const {
+    if (meshletsDirty) {
+        buildMeshlets();
+    }
+    return meshlets;
+}
+
+void Model::buildMeshlets() const {
+    meshlets.clear();
+    meshletTriangles.clear();
+    meshletVertices.clear();
+    meshletsDirty = false;
+    
+    // Position to triangle adjacency in compressed form, so that meshlets also grow across texture seams
+    const bool hasPositionIds = positionIds.size() == vertices.size();
+    auto positionOf = [&](uint32_t vertex) { return hasPositionIds ? positionIds[vertex] : vertex; };
+    std::vector<uint32_t> adjacencyOffsets(vertices.size() + 1, 0);
+    for (const auto& triangle : triangles) {
+        for (uint32_t index : triangle.vertexIndices) {
+            ++adjacencyOffsets[positionOf(index) + 1];
+        }
+    }
+    for (size_t v = 1; v < adjacencyOffsets.size(); ++v) {
+        adjacencyOffsets[v] += adjacencyOffsets[v - 1];
+    }
+    std::vector<uint32_t> adjacentTriangles(adjacencyOffsets.back());
+    std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (uint32_t t = 0; t < triangles.size(); ++t) {
+        for (uint32_t index : triangles[t].vertexIndices) {
+            adjacentTriangles[cursor[positionOf(index)]++] = t;
+        }
+    }
+    
+    // Greedily grow meshlets from the first unassigned triangle over neighbouring triangles
+    const uint32_t NONE = UINT32_MAX;
+    std::vector<uint32_t> triangleMeshlet(triangles.size(), NONE); // Meshlet a triangle was assigned to
+    std::vector<uint32_t> triangleQueued(triangles.size(), NONE);  // Meshlet whose queue holds a triangle
+    std::vector<uint32_t> vertexMeshlet(vertices.size(), NONE);    // Meshlet that last used a vertex
+    std::vector<uint32_t> queue;
+    
+    for (uint32_t seed = 0; seed < triangles.size(); ++seed) {
+        if (triangleMeshlet[seed] != NONE) {
+            continue;
+        }
+        
+        uint32_t id = static_cast<uint32_t>(meshlets.size());
+        Meshlet meshlet{};
+        meshlet.firstTriangle = static_cast<uint32_t>(meshletTriangles.size());
+        meshlet.firstVertex = static_cast<uint32_t>(meshletVertices.size());
+        
+        queue.clear();
+        queue.push_back(seed);
+        triangleQueued[seed] = id;
+        
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint32_t t = queue[head];
+            const auto& indices = triangles[t].vertexIndices;
+            
+            // Check that the triangle still fits (a single triangle always does)
+            uint32_t newVertices = 0;
+            for (uint32_t index : indices) {
+                if (vertexMeshlet[index] != id) {
+                    ++newVertices;
+                }
+            }
+            if (meshlet.triangleCount > 0 &&
+                (meshlet.vertexCount + newVertices > MAX_MESHLET_VERTICES ||
+                 meshlet.triangleCount + 1 > MAX_MESHLET_TRIANGLES)) {
+                continue;
+            }
+            
+            // Add the triangle and its new vertices
+            triangleMeshlet[t] = id;
+            meshletTriangles.push_back(t);
+            ++meshlet.triangleCount;
+            for (uint32_t index : indices) {
+                if (vertexMeshlet[index] != id) {
+                    vertexMeshlet[index] = id;
+                    meshletVertices.push_back(index);
+                    ++meshlet.vertexCount;
+                }
+            }
+            
+            // Queue the unassigned neighbours
+            for (uint32_t index : indices) {
+                uint32_t position = positionOf(index);
+                for (uint32_t a = adjacencyOffsets[position]; a < adjacencyOffsets[position + 1]; ++a) {
+                    uint32_t neighbour = adjacentTriangles[a];
+                    if (triangleMeshlet[neighbour] == NONE && triangleQueued[neighbour] != id) {
+                        triangleQueued[neighbour] = id;
+                        queue.push_back(neighbour);
+                    }
+                }
+            }
+        }
+        
+        // Bounding sphere around the center of the bounding box
+        Eigen::Vector3f minCorner = vertices[meshletVertices[meshlet.firstVertex]];
+        Eigen::Vector3f maxCorner = minCorner;
+        for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+            const Eigen::Vector3f& p = vertices[meshletVertices[meshlet.firstVertex + i]];
+            minCorner = minCorner.cwiseMin(p);
+            maxCorner = maxCorner.cwiseMax(p);
+        }
+        meshlet.center = (minCorner + maxCorner) * 0.5f;
+        meshlet.radius = 0.0f;
+        for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+            const Eigen::Vector3f& p = vertices[meshletVertices[meshlet.firstVertex + i]];
+            meshlet.radius = std::max(meshlet.radius, (p - meshlet.center).norm());
+        }
+        
+        // Normal cone around the average triangle normal (in Newell's form)
+        std::vector<Eigen::Vector3f> triangleNormals;
+        triangleNormals.reserve(meshlet.triangleCount);
+        Eigen::Vector3f axis = Eigen::Vector3f::Zero();
+        for (uint32_t i = 0; i < meshlet.triangleCount; ++i) {
+            const auto& indices = triangles[meshletTriangles[meshlet.firstTriangle + i]].vertexIndices;
+            Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+            for (size_t k = 0; k < 3; ++k) {
+                const Eigen::Vector3f& a = vertices[indices[k]];
+                const Eigen::Vector3f& b = vertices[indices[(k + 1) % 3]];
+                normal += Eigen::Vector3f((a.y() - b.y()) * (a.z() + b.z()),
+                                          (a.z() - b.z()) * (a.x() + b.x()),
+                                          (a.x() - b.x()) * (a.y() + b.y()));
+            }
+            // Degenerate triangles have no facing and are rejected later anyway
+            if (normal.norm() > 0.0f) {
+                triangleNormals.push_back(normal.normalized());
+                axis += triangleNormals.back();
+            }
+        }
+        
+        meshlet.coneAxis = Eigen::Vector3f::UnitZ();
+        meshlet.coneCos = -1.0f;
+        meshlet.coneSin = 0.0f;
+        if (axis.norm() > 0.0f) {
+            meshlet.coneAxis = axis.normalized();
+            float minDot = 1.0f;
+            for (const auto& normal : triangleNormals) {
+                minDot = std::min(minDot, meshlet.coneAxis.dot(normal));
+            }
+            // Cones wider than a hemisphere can never be completely back-facing
+            if (minDot > 0.0f) {
+                meshlet.coneCos = minDot;
+                meshlet.coneSin = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+            }
+        }
+        
+        meshlets.push_back(meshlet);
+    }
+    
+    spdlog::info("Built {} meshlets for {} triangles", meshlets.size(), triangles.size());
+}
+
+const Model::TangentFrames& Model::getTangentFrames() const {
+    if (tangentsDirty) {
+        buildTangentFrames();
+    }
+    return tangentFrames;
+}
+
+void Model::buildTangentFrames() const {
+    tangentsDirty = false;
+    
+    size_t count = textureCoords.size();
+    std::vector<Eigen::Vector3f> tangents(count, Eigen::Vector3f::Zero());
+    std::vector<Eigen::Vector3f> bitangents(count, Eigen::Vector3f::Zero());
+    
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        if (!(triangleFlags[t] & HAS_TEXTURE_COORDS)) {
+            continue;
+        }
+        const auto& indices = triangles[t].vertexIndices;
+        
+        const Eigen::Vector3f& p0 = vertices[indices[0]];
+        const Eigen::Vector2f& t0 = textureCoords[indices[0]];
+        Eigen::Vector3f edge1 = vertices[indices[1]] - p0;
+        Eigen::Vector3f edge2 = vertices[indices[2]] - p0;
+        Eigen::Vector2f delta1 = textureCoords[indices[1]] - t0;
+        Eigen::Vector2f delta2 = textureCoords[indices[2]] - t0;
+        
+        // Solve edge = du * tangent + dv * bitangent for both edges
+        float determinant = delta1.x() * delta2.y() - delta2.x() * delta1.y();
+        if (determinant == 0.0f) {
+            continue;
+        }
+        Eigen::Vector3f tangent = (edge1 * delta2.y() - edge2 * delta1.y()) / determinant;
+        Eigen::Vector3f bitangent = (edge2 * delta1.x() - edge1 * delta2.x()) / determinant;
+        if (tangent.norm() == 0.0f || bitangent.norm() == 0.0f) {
+            continue;
+        }
+        
+        // Larger triangles weigh more
+        float area = edge1.cross(edge2).norm();
+        tangent = tangent.normalized() * area;
+        bitangent = bitangent.normalized() * area;
+        for (uint32_t index : indices) {
+            tangents[index] += tangent;
+            bitangents[index] += bitangent;
+        }
+    }
+    
+    TangentFrames& frames = tangentFrames;
+    for (auto* component : {&frames.tangentX, &frames.tangentY, &frames.tangentZ,
+                            &frames.bitangentX, &frames.bitangentY, &frames.bitangentZ}) {
+        component->resize(count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        Eigen::Vector3f tangent = tangents[i].norm() > 0.0f ? tangents[i].normalized() : Eigen::Vector3f::Zero();
+        Eigen::Vector3f bitangent = bitangents[i].norm() > 0.0f ? bitangents[i].normalized() : Eigen::Vector3f::Zero();
+        frames.tangentX[i] = tangent.x();
+        frames.tangentY[i] = tangent.y();
+        frames.tangentZ[i] = tangent.z();
+        frames.bitangentX[i] = bitangent.x();
+        frames.bitangentY[i] = bitangent.y();
+        frames.bitangentZ[i] = bitangent.z();
+    }
+    
+    spdlog::info("Built tangent frames for {} texture coordinates", count);
+}
@@ -1,8 +1,13 @@
 #include "ModelLoaderFactory.h"
 #include "OBJModelLoader.h"
+#include "SRMeshModelLoader.h"
 #include <spdlog/spdlog.h>
+#include <filesystem>
+
+namespace fs = std::filesystem;
 
 std::unordered_map<std::string, std::shared_ptr<IModelLoader>> ModelLoaderFactory::loaders;
+bool ModelLoaderFactory::meshCacheEnabled = true;
 
 std::shared_ptr<IModelLoader> ModelLoaderFactory::createLoader(const std::string& fileExtension) {
     auto it = loaders.find(fileExtension);
@@ -19,11 +24,33 @@ void ModelLoaderFactory::registerLoader(const std::string& extension, std::share
     spdlog::info("Registered model loader for extension: {}", extension);
 }
 
+std::shared_ptr<Model> ModelLoaderFactory::loadModel(const std::string& filename) {
+    std::string extension = fs::path(filename).extension().string();
+    auto loader = createLoader(extension.empty() ? extension : extension.substr(1)); // Remove the dot
+    if (!loader) {
+        return nullptr;
+    }
+    if (!meshCacheEnabled || std::dynamic_pointer_cast<SRMeshModelLoader>(loader)) {
+        return loader->loadModel(filename);
+    }
+
+    const std::string cacheFile = getCachePath(filename);
+    if (auto model = SRMeshModelLoader::loadCache(cacheFile, filename)) {
+        return model;
+    }
+    auto model = loader->loadModel(filename);
+    if (model) {
+        SRMeshModelLoader::saveModel(*model, cacheFile, filename);
+    }
+    return model;
+}
+
 // Register default loaders
 namespace {
     struct DefaultLoaderRegistration {
         DefaultLoaderRegistration() {
             ModelLoaderFactory::registerLoader("obj", std::make_shared<OBJModelLoader>());
+            ModelLoaderFactory::registerLoader("srmesh", std::make_shared<SRMeshModelLoader>());
         }
     } defaultLoaderRegistration;
 } 
\ No newline at end of file
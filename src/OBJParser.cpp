@@ -0,0 +1,390 @@
+#include "OBJParser.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t MIN_CHUNK_BYTES = size_t(1) << 20;  // Smaller texts are not worth splitting further
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+/**
+ * @brief Kind of statement an OBJ line starts with
+ */
+enum class Statement { VERTEX, TEXTURE_COORD, NORMAL, FACE, OTHER };
+constexpr int STATEMENT_KINDS = 4;  // Statements that are counted, all but OTHER
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * @brief Classifies a line by its keyword and moves the cursor past it
+ */
+Statement classify(const char*& p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+    if (end - p < 2) {
+        return Statement::OTHER;
+    }
+    Statement statement = Statement::OTHER;
+    int length = 1;
+    if (p[0] == 'v') {
+        if (isSpace(p[1])) {
+            statement = Statement::VERTEX;
+        } else if (end - p >= 3 && isSpace(p[2])) {
+            length = 2;
+            statement = p[1] == 't' ? Statement::TEXTURE_COORD : p[1] == 'n' ? Statement::NORMAL : Statement::OTHER;
+        }
+    } else if (p[0] == 'f' && isSpace(p[1])) {
+        statement = Statement::FACE;
+    }
+    if (statement != Statement::OTHER) {
+        p += length;
+    }
+    return statement;
+}
+
+/**
+ * @brief End of the line starting at p: the next newline or the end of the text
+ */
+const char* findLineEnd(const char* p, const char* end) {
+    const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+/**
+ * @brief Reads a number after optional blanks, advancing the cursor past it
+ * @return False if no number starts there (end of line, comment or garbage)
+ */
+template<typename T>
+bool parseNumber(const char*& p, const char* end, T& value) {
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+    if (p < end && *p == '+') {
+        ++p;
+    }
+    auto [next, error] = std::from_chars(p, end, value);
+    if (error != std::errc()) {
+        return false;
+    }
+    p = next;
+    return true;
+}
+
+/**
+ * @brief Reads the vertex, texture and normal indices of one face corner as written in the file
+ *
+ * Missing components are reported as false in the has flags, like "1//3"
+ * which has no texture index.
+ *
+ * @return False if the corner does not start with a vertex index
+ */
+bool parseCorner(const char*& p, const char* end, int indices[3], bool has[3]) {
+    has[0] = has[1] = has[2] = false;
+    for (int component = 0; component < 3; ++component) {
+        if (p < end && *p != '/' && !isSpace(*p)) {
+            auto [next, error] = std::from_chars(p, end, indices[component]);
+            if (error != std::errc()) {
+                return false;
+            }
+            p = next;
+            has[component] = true;
+        }
+        if (p >= end || *p != '/') {
+            break;
+        }
+        ++p;
+    }
+    return has[0];
+}
+
+/**
+ * @brief Converts an OBJ index to a 0-based one
+ *
+ * Positive indices are 1-based from the start of the file, negative ones
+ * count back from the last element defined before the face (-1 is the
+ * latest). 0 and indices counting back past the first element are not
+ * valid; they become INT_MAX, which Model::setPolygons rejects as out of
+ * range (-1 is taken: it marks a missing index).
+ *
+ * @param index Index as written in the file
+ * @param defined Number of elements of its kind defined before the face
+ */
+int resolveIndex(int index, size_t defined) {
+    if (index > 0) {
+        return index - 1;
+    }
+    int resolved = static_cast<int>(defined) + index;
+    return index < 0 && resolved >= 0 ? resolved : INT_MAX;
+}
+
+/**
+ * @brief Byte range of the text parsed by one task, starting and ending at line boundaries
+ */
+struct Chunk {
+    const char* begin;
+    const char* end;
+    size_t counts[STATEMENT_KINDS] = {};    // Statements of each kind in the chunk
+    size_t first[STATEMENT_KINDS] = {};     // Statements of each kind in the chunks before, where this one's elements go
+    size_t corners = 0;                     // Face corners in the chunk, an upper bound counting every word of the f lines
+    size_t firstCorner = 0;                 // Corners counted in the chunks before, where this one's corners go
+    size_t keptFaces = 0;                   // Faces stored, from first[FACE] on (malformed and degenerate ones are dropped)
+    size_t keptCorners = 0;                 // Corners of the stored faces, from firstCorner on
+    size_t malformed = 0;                   // Malformed lines
+};
+
+/**
+ * @brief Geometry arrays allocated at their final size and filled concurrently, each chunk in its own range
+ */
+struct Geometry {
+    std::vector<Eigen::Vector3f> vertices;
+    std::vector<Eigen::Vector2f> textureCoords;
+    std::vector<Eigen::Vector3f> normals;
+    Model::Polygons faces;
+};
+
+/**
+ * @brief Counts the statements of each kind in a chunk, and the words of its faces
+ */
+void countStatements(Chunk& chunk) {
+    for (const char* line = chunk.begin; line < chunk.end; ) {
+        const char* lineEnd = findLineEnd(line, chunk.end);
+        const char* p = line;
+        Statement statement = classify(p, lineEnd);
+        if (statement != Statement::OTHER) {
+            ++chunk.counts[static_cast<int>(statement)];
+        }
+        if (statement == Statement::FACE) {
+            while (true) {
+                while (p < lineEnd && isSpace(*p)) {
+                    ++p;
+                }
+                if (p >= lineEnd || *p == '#') {
+                    break;
+                }
+                ++chunk.corners;
+                while (p < lineEnd && !isSpace(*p)) {
+                    ++p;
+                }
+            }
+        }
+        line = lineEnd + 1;
+    }
+}
+
+/**
+ * @brief Parses the statements of a chunk into its ranges of the geometry arrays
+ *
+ * A malformed v, vt or vn line still takes its slot, as a zero vector, so
+ * that the indices of later faces refer to the same elements however the
+ * text was split. Faces are stored as polygons, in the chunk's ranges of
+ * the polygon and corner arrays.
+ */
+void parseChunk(Chunk& chunk, Geometry& geometry) {
+    size_t vertexCount = chunk.first[static_cast<int>(Statement::VERTEX)];
+    size_t textureCoordCount = chunk.first[static_cast<int>(Statement::TEXTURE_COORD)];
+    size_t normalCount = chunk.first[static_cast<int>(Statement::NORMAL)];
+    uint32_t* starts = geometry.faces.starts.data() + chunk.first[static_cast<int>(Statement::FACE)];
+    int* lists[3] = {geometry.faces.vertexIndices.data() + chunk.firstCorner,
+                     geometry.faces.textureIndices.data() + chunk.firstCorner,
+                     geometry.faces.normalIndices.data() + chunk.firstCorner};
+
+    for (const char* line = chunk.begin; line < chunk.end; ) {
+        const char* lineEnd = findLineEnd(line, chunk.end);
+        const char* p = line;
+        line = lineEnd + 1;
+
+        switch (classify(p, lineEnd)) {
+            case Statement::VERTEX: {
+                float x, y, z;
+                Eigen::Vector3f& vertex = geometry.vertices[vertexCount++];
+                if (parseNumber(p, lineEnd, x) && parseNumber(p, lineEnd, y) && parseNumber(p, lineEnd, z)) {
+                    vertex = Eigen::Vector3f(x, y, z);
+                } else {
+                    vertex.setZero();
+                    ++chunk.malformed;
+                }
+                break;
+            }
+            case Statement::TEXTURE_COORD: {
+                float u, v = 0.0f;
+                Eigen::Vector2f& textureCoord = geometry.textureCoords[textureCoordCount++];
+                if (parseNumber(p, lineEnd, u)) {
+                    parseNumber(p, lineEnd, v);
+                    textureCoord = Eigen::Vector2f(u, v);
+                } else {
+                    textureCoord.setZero();
+                    ++chunk.malformed;
+                }
+                break;
+            }
+            case Statement::NORMAL: {
+                float x, y, z;
+                Eigen::Vector3f& normal = geometry.normals[normalCount++];
+                if (parseNumber(p, lineEnd, x) && parseNumber(p, lineEnd, y) && parseNumber(p, lineEnd, z)) {
+                    normal = Eigen::Vector3f(x, y, z);
+                } else {
+                    normal.setZero();
+                    ++chunk.malformed;
+                }
+                break;
+            }
+            case Statement::FACE: {
+                // Corners go straight to the end of the chunk's corner range and are taken back if the face is dropped
+                const size_t defined[3] = {vertexCount, textureCoordCount, normalCount};
+                size_t corner = chunk.keptCorners;
+                bool valid = true;
+                while (true) {
+                    while (p < lineEnd && isSpace(*p)) {
+                        ++p;
+                    }
+                    if (p >= lineEnd || *p == '#') {
+                        break;
+                    }
+                    int indices[3];
+                    bool has[3];
+                    if (!parseCorner(p, lineEnd, indices, has) || (p < lineEnd && !isSpace(*p))) {
+                        valid = false;
+                        break;
+                    }
+                    for (int component = 0; component < 3; ++component) {
+                        lists[component][corner] = has[component] ? resolveIndex(indices[component], defined[component]) : -1;
+                    }
+                    ++corner;
+                }
+                if (!valid) {
+                    ++chunk.malformed;
+                    break;
+                }
+
+                // Only add faces with at least 3 vertices
+                if (corner - chunk.keptCorners >= 3) {
+                    starts[chunk.keptFaces++] = static_cast<uint32_t>(chunk.firstCorner + chunk.keptCorners);
+                    chunk.keptCorners = corner;
+                }
+                break;
+            }
+            case Statement::OTHER:
+                break;
+        }
+    }
+}
+
+} // namespace
+
+bool OBJParser::loadFile(const std::string& filename, Model& model, unsigned int threadCount) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+    parse(file.data(), file.size(), model, threadCount);
+    return true;
+}
+
+void OBJParser::parse(const char* data, size_t size, Model& model, unsigned int threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Split the text at line boundaries, into a few chunks per thread so that threads finishing early pick up more
+    size_t chunkCount = std::clamp<size_t>(size / MIN_CHUNK_BYTES, 1, size_t(threadCount) * CHUNKS_PER_THREAD);
+    std::vector<Chunk> chunks;
+    chunks.reserve(chunkCount);
+    const char* end = data + size;
+    const char* begin = data;
+    for (size_t i = 1; i <= chunkCount && begin < end; ++i) {
+        const char* split = i == chunkCount ? end : std::max(begin, data + size / chunkCount * i);
+        if (split < end) {
+            split = findLineEnd(split, end);
+            split = split < end ? split + 1 : end;
+        }
+        chunks.push_back({begin, split});
+        begin = split;
+    }
+
+    std::unique_ptr<ThreadPool> threadPool;
+    if (chunks.size() > 1 && threadCount > 1) {
+        threadPool = std::make_unique<ThreadPool>(static_cast<unsigned int>(std::min<size_t>(threadCount, chunks.size())));
+    }
+    auto forEachChunk = [&](const std::function<void(size_t)>& task) {
+        if (threadPool) {
+            threadPool->parallelFor(chunks.size(), task);
+        } else {
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                task(i);
+            }
+        }
+    };
+
+    // First pass: count the statements of every chunk; their prefix sums place each chunk's elements and
+    // give the number of elements defined before each face, which relative indices count back from
+    forEachChunk([&](size_t i) { countStatements(chunks[i]); });
+    size_t totals[STATEMENT_KINDS] = {};
+    size_t totalCorners = 0;
+    for (Chunk& chunk : chunks) {
+        for (int kind = 0; kind < STATEMENT_KINDS; ++kind) {
+            chunk.first[kind] = totals[kind];
+            totals[kind] += chunk.counts[kind];
+        }
+        chunk.firstCorner = totalCorners;
+        totalCorners += chunk.corners;
+    }
+
+    // Second pass: parse every chunk into its ranges of the arrays, allocated once at their final size
+    Geometry geometry;
+    geometry.vertices.resize(totals[static_cast<int>(Statement::VERTEX)]);
+    geometry.textureCoords.resize(totals[static_cast<int>(Statement::TEXTURE_COORD)]);
+    geometry.normals.resize(totals[static_cast<int>(Statement::NORMAL)]);
+    Model::Polygons& faces = geometry.faces;
+    faces.starts.resize(totals[static_cast<int>(Statement::FACE)] + 1);
+    faces.vertexIndices.resize(totalCorners);
+    faces.textureIndices.resize(totalCorners);
+    faces.normalIndices.resize(totalCorners);
+    forEachChunk([&](size_t i) { parseChunk(chunks[i], geometry); });
+
+    // Close the gaps left by dropped faces and unused corner slots, keeping the file order
+    size_t faceCount = 0;
+    size_t cornerCount = 0;
+    size_t malformed = 0;
+    for (const Chunk& chunk : chunks) {
+        size_t first = chunk.first[static_cast<int>(Statement::FACE)];
+        if (faceCount != first || cornerCount != chunk.firstCorner) {
+            const uint32_t shift = static_cast<uint32_t>(chunk.firstCorner - cornerCount);
+            for (size_t f = 0; f < chunk.keptFaces; ++f) {
+                faces.starts[faceCount + f] = faces.starts[first + f] - shift;
+            }
+            for (auto* list : {&faces.vertexIndices, &faces.textureIndices, &faces.normalIndices}) {
+                std::copy(list->begin() + chunk.firstCorner, list->begin() + chunk.firstCorner + chunk.keptCorners,
+                          list->begin() + cornerCount);
+            }
+        }
+        faceCount += chunk.keptFaces;
+        cornerCount += chunk.keptCorners;
+        malformed += chunk.malformed;
+    }
+    faces.starts.resize(faceCount + 1);
+    faces.starts[faceCount] = static_cast<uint32_t>(cornerCount);
+    for (auto* list : {&faces.vertexIndices, &faces.textureIndices, &faces.normalIndices}) {
+        list->resize(cornerCount);
+    }
+
+    if (malformed > 0) {
+        spdlog::warn("{} malformed OBJ lines: vertex data replaced by zeros, faces skipped", malformed);
+    }
+
+    model.setVertices(std::move(geometry.vertices));
+    model.setTextureCoords(std::move(geometry.textureCoords));
+    model.setNormals(std::move(geometry.normals));
+    model.setPolygons(faces);
+}
@@ -1,6 +1,8 @@
 #include "Renderer.h"
+#include "Clipper.h"
 #include <spdlog/spdlog.h>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <stdexcept>
 #include <stdio.h>
@@ -10,7 +12,11 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-Renderer::Renderer(int width, int height) : width(width), height(height), renderMode(RenderMode::WIREFRAME) {
+Renderer::Renderer(int width, int height)
+    : width(width), height(height), renderMode(RenderMode::WIREFRAME), rasterBackend(RasterBackend::SCANLINE),
+      cullMode(CullMode::BACK),
+      threadCount(0), binner(width, height),
+      scanlineRasterizer(frameBuffer, zBuffer, width), edgeRasterizer(frameBuffer, zBuffer, width), hiZBuffer(zBuffer, width, height) {
     spdlog::info("Initializing Renderer with width={}, height={}", width, height);
     
     frameBuffer.resize(width * height, 0);
@@ -79,9 +85,420 @@ void Renderer::setRenderMode(RenderMode mode) {
     renderMode = mode;
 }
 
+void Renderer::setThreadCount(unsigned int threadCount) {
+    this->threadCount = threadCount;
+    threadPool.reset();
+}
+
+ThreadPool& Renderer::getThreadPool() {
+    // Started on first use, so that a thread count set after construction does not start a default pool first
+    if (!threadPool) {
+        threadPool = std::make_unique<ThreadPool>(threadCount);
+    }
+    return *threadPool;
+}
+
+void Renderer::setRasterBackend(RasterBackend backend) {
+    if (backend == RasterBackend::VISIBILITY && !visibilityBuffer) {
+        visibilityBuffer = std::make_unique<VisibilityBuffer>(frameBuffer, width);
+    }
+    rasterBackend = backend;
+}
+
+void Renderer::setTextureFilter(std::optional<TextureFilter> filter) {
+    textureFilter = filter;
+}
+
+void Renderer::setTextureWrap(std::optional<TextureWrap> wrap) {
+    textureWrap = wrap;
+}
+
+TextureSampler Renderer::bindSampler(const Texture* texture) const {
+    TextureSampler sampler(texture);
+    if (textureFilter) {
+        sampler.setFilter(*textureFilter);
+    }
+    if (textureWrap) {
+        sampler.setWrap(*textureWrap);
+    }
+    return sampler;
+}
+
+void Renderer::setCullMode(CullMode mode) {
+    cullMode = mode;
+}
+
+void Renderer::cullMeshlets(const Model& model, const Eigen::Matrix4f& mvp, bool coneCulling) {
+    const auto& meshlets = model.getMeshlets();
+    const auto& meshletTriangles = model.getMeshletTriangles();
+    const auto& meshletVertices = model.getMeshletVertices();
+    
+    // Frustum planes in model space (Gribb-Hartmann), normalized so that sphere radii can be compared
+    Eigen::Vector4f planes[6] = {
+        mvp.row(3) + mvp.row(0), mvp.row(3) - mvp.row(0),
+        mvp.row(3) + mvp.row(1), mvp.row(3) - mvp.row(1),
+        mvp.row(3) + mvp.row(2), mvp.row(3) - mvp.row(2)
+    };
+    for (auto& plane : planes) {
+        plane /= plane.head<3>().norm();
+    }
+    
+    // Camera position in model space for the normal cone test
+    Eigen::Vector4f camera = (viewMatrix * modelMatrix).inverse() * Eigen::Vector4f(0.0f, 0.0f, 0.0f, 1.0f);
+    Eigen::Vector3f cameraPos = camera.head<3>() / camera.w();
+    
+    visibleTriangles.clear();
+    vertexMask.assign(model.getVertices().size(), 0);
+    cullStats.meshlets = meshlets.size();
+    
+    for (const auto& meshlet : meshlets) {
+        // Bounding sphere against the view frustum
+        bool outside = false;
+        for (const auto& plane : planes) {
+            if (plane.head<3>().dot(meshlet.center) + plane.w() < -meshlet.radius) {
+                outside = true;
+                break;
+            }
+        }
+        if (outside) {
+            ++cullStats.meshletFrustum;
+            continue;
+        }
+        
+        // Normal cone: every triangle is back-facing if, for every point of the bounding sphere,
+        // the view direction makes an angle of less than 90 degrees with every normal of the cone
+        if (coneCulling && cullMode != CullMode::NONE && meshlet.coneCos > 0.0f) {
+            Eigen::Vector3f axis = cullMode == CullMode::BACK ? meshlet.coneAxis : -meshlet.coneAxis;
+            Eigen::Vector3f toCenter = meshlet.center - cameraPos;
+            float along = toCenter.dot(axis);
+            float across = std::sqrt(std::max(0.0f, toCenter.squaredNorm() - along * along));
+            if (along * meshlet.coneCos - across * meshlet.coneSin > meshlet.radius) {
+                ++cullStats.meshletBackface;
+                continue;
+            }
+        }
+        
+        visibleTriangles.insert(visibleTriangles.end(),
+                                meshletTriangles.begin() + meshlet.firstTriangle,
+                                meshletTriangles.begin() + meshlet.firstTriangle + meshlet.triangleCount);
+        for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+            vertexMask[meshletVertices[meshlet.firstVertex + i]] = 1;
+        }
+    }
+}
+
+void Renderer::submitTriangle(size_t chunk, int i0, int i1, int i2, ScreenTriangle triangle) {
+    CullStats& stats = chunkCullStats[chunk];
+    ++stats.triangles;
+    
+    const auto& outcodes = vertexProcessor.getOutcodes();
+    uint16_t code0 = outcodes[i0];
+    uint16_t code1 = outcodes[i1];
+    uint16_t code2 = outcodes[i2];
+    
+    // Frustum culling: reject triangles that lie completely outside one of the frustum planes
+    if (code0 & code1 & code2 & Clipper::FRUSTUM_PLANES) {
+        ++stats.frustum;
+        return;
+    }
+    
+    const int indices[3] = {i0, i1, i2};
+    Eigen::Vector4f p[3];
+    for (int k = 0; k < 3; ++k) {
+        p[k] = vertexProcessor.getClipPosition(indices[k]);
+    }
+    
+    // Backface culling on the homogeneous determinant |x y w|, which has the sign of the
+    // screen-space signed area but stays valid for vertices behind the camera
+    float determinant = p[0].x() * (p[1].y() * p[2].w() - p[2].y() * p[1].w())
+                      - p[1].x() * (p[0].y() * p[2].w() - p[2].y() * p[0].w())
+                      + p[2].x() * (p[0].y() * p[1].w() - p[1].y() * p[0].w());
+    if (determinant == 0.0f) {
+        ++stats.zeroArea;
+        return;
+    }
+    if ((cullMode == CullMode::BACK && determinant < 0.0f) ||
+        (cullMode == CullMode::FRONT && determinant > 0.0f)) {
+        ++stats.backface;
+        return;
+    }
+    
+    auto emit = [&](ScreenTriangle& t) {
+        // Every rasterizer works on the 28.4 subpixel grid
+        for (int k = 0; k < 3; ++k) {
+            t.x[k] = EdgeRasterizer::snapToSubpixel(t.x[k]);
+            t.y[k] = EdgeRasterizer::snapToSubpixel(t.y[k]);
+        }
+        
+        // Zero-area culling: triangles that collapsed in screen space cover no pixels
+        float signedArea = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.x[2] - t.x[0]) * (t.y[1] - t.y[0]);
+        if (signedArea == 0.0f) {
+            ++stats.zeroArea;
+            return;
+        }
+        
+        binTriangle(chunk, t);
+    };
+    
+    // Guard-band trivial accept: the cached screen positions can be used as they are
+    if (((code0 | code1 | code2) & Clipper::CLIP_PLANES) == 0) {
+        const auto& screenX = vertexProcessor.getScreenX();
+        const auto& screenY = vertexProcessor.getScreenY();
+        const auto& depth = vertexProcessor.getDepth();
+        for (int k = 0; k < 3; ++k) {
+            triangle.x[k] = screenX[indices[k]];
+            triangle.y[k] = screenY[indices[k]];
+            triangle.z[k] = depth[indices[k]];
+            triangle.invW[k] = 1.0f / p[k].w();
+        }
+        emit(triangle);
+        return;
+    }
+    
+    // Clip in homogeneous space, carrying the attributes along
+    ClipVertex polygon[Clipper::MAX_POLYGON_VERTICES];
+    for (int k = 0; k < 3; ++k) {
+        polygon[k] = ClipVertex{p[k].x(), p[k].y(), p[k].z(), p[k].w(), triangle.u[k], triangle.v[k], triangle.intensity[k],
+                                {triangle.lightX[k], triangle.lightY[k], triangle.lightZ[k]}};
+    }
+    int count = Clipper::clipPolygon(polygon, 3, code0 | code1 | code2);
+    
+    // Perspective division and viewport transformation of the clipped vertices
+    auto setCorner = [&](ScreenTriangle& t, int corner, const ClipVertex& v) {
+        t.x[corner] = (v.x / v.w + 1.0f) * 0.5f * width;
+        t.y[corner] = (v.y / v.w + 1.0f) * 0.5f * height;
+        t.z[corner] = v.z / v.w;
+        t.invW[corner] = 1.0f / v.w;
+        t.u[corner] = v.u;
+        t.v[corner] = v.v;
+        t.intensity[corner] = v.intensity;
+        t.lightX[corner] = v.light[0];
+        t.lightY[corner] = v.light[1];
+        t.lightZ[corner] = v.light[2];
+    };
+    
+    // Record the clipped polygon as a triangle fan
+    for (int k = 1; k + 1 < count; ++k) {
+        ScreenTriangle piece = triangle;
+        setCorner(piece, 0, polygon[0]);
+        setCorner(piece, 1, polygon[k]);
+        setCorner(piece, 2, polygon[k + 1]);
+        emit(piece);
+    }
+}
+
+void Renderer::submitLine(size_t chunk, int i0, int i1, uint32_t color) {
+    const auto& outcodes = vertexProcessor.getOutcodes();
+    uint16_t code0 = outcodes[i0];
+    uint16_t code1 = outcodes[i1];
+    
+    // Frustum culling: reject lines that lie completely outside one of the frustum planes
+    if (code0 & code1 & Clipper::FRUSTUM_PLANES) {
+        return;
+    }
+    
+    ScreenLine line;
+    line.color = color;
+    
+    if (((code0 | code1) & Clipper::CLIP_PLANES) == 0) {
+        // Guard-band trivial accept
+        const auto& screenX = vertexProcessor.getScreenX();
+        const auto& screenY = vertexProcessor.getScreenY();
+        line.x0 = static_cast<int>(screenX[i0]);
+        line.y0 = static_cast<int>(screenY[i0]);
+        line.x1 = static_cast<int>(screenX[i1]);
+        line.y1 = static_cast<int>(screenY[i1]);
+    } else {
+        // Clip in homogeneous space
+        Eigen::Vector4f p0 = vertexProcessor.getClipPosition(i0);
+        Eigen::Vector4f p1 = vertexProcessor.getClipPosition(i1);
+        ClipVertex a{p0.x(), p0.y(), p0.z(), p0.w(), 0.0f, 0.0f, 0.0f, {}};
+        ClipVertex b{p1.x(), p1.y(), p1.z(), p1.w(), 0.0f, 0.0f, 0.0f, {}};
+        if (!Clipper::clipLine(a, b, code0 | code1)) {
+            return;
+        }
+        
+        line.x0 = static_cast<int>((a.x / a.w + 1.0f) * 0.5f * width);
+        line.y0 = static_cast<int>((a.y / a.w + 1.0f) * 0.5f * height);
+        line.x1 = static_cast<int>((b.x / b.w + 1.0f) * 0.5f * width);
+        line.y1 = static_cast<int>((b.y / b.w + 1.0f) * 0.5f * height);
+    }
+    
+    binLine(chunk, line);
+}
+
+void Renderer::binTriangle(size_t chunk, const ScreenTriangle& triangle) {
+    float minX = std::min({triangle.x[0], triangle.x[1], triangle.x[2]});
+    float minY = std::min({triangle.y[0], triangle.y[1], triangle.y[2]});
+    float maxX = std::max({triangle.x[0], triangle.x[1], triangle.x[2]});
+    float maxY = std::max({triangle.y[0], triangle.y[1], triangle.y[2]});
+    
+    if (binner.addPrimitive(chunk, minX, minY, maxX, maxY)) {
+        binnedTriangles[chunk].push_back(triangle);
+        binnedSetups[chunk].emplace_back(triangle);
+    }
+}
+
+void Renderer::binLine(size_t chunk, const ScreenLine& line) {
+    float minX = static_cast<float>(std::min(line.x0, line.x1));
+    float minY = static_cast<float>(std::min(line.y0, line.y1));
+    float maxX = static_cast<float>(std::max(line.x0, line.x1));
+    float maxY = static_cast<float>(std::max(line.y0, line.y1));
+    
+    if (binner.addPrimitive(chunk, minX, minY, maxX, maxY)) {
+        binnedLines[chunk].push_back(line);
+    }
+}
+
+void Renderer::rasterizeTiles(RenderMode mode, const Texture* texture, const Texture* normalMap) {
+    // Solid mode draws without depth test, so the hierarchical z-buffer does not apply
+    const bool depthTested = mode == RenderMode::TEXTURED || mode == RenderMode::TEXTURED_SHADED ||
+                             mode == RenderMode::COLORFUL || mode == RenderMode::NORMAL_MAPPED;
+    tileOccluded.assign(binner.getTileCount(), 0);
+    const TextureSampler sampler = bindSampler(texture);
+    const TextureSampler normalSampler = bindSampler(normalMap);
+    const NormalMappedSamplers normalMappedSamplers{ sampler, normalSampler };
+    
+    // The visibility backend defers texturing and lighting; it needs a global id for every triangle
+    const bool deferred = rasterBackend == RasterBackend::VISIBILITY &&
+                          (mode == RenderMode::TEXTURED || mode == RenderMode::TEXTURED_SHADED ||
+                           mode == RenderMode::NORMAL_MAPPED);
+    if (deferred) {
+        VisibilityBuffer::Shading shading = mode == RenderMode::TEXTURED ? VisibilityBuffer::Shading::TEXTURED
+                                          : mode == RenderMode::TEXTURED_SHADED ? VisibilityBuffer::Shading::TEXTURED_SHADED
+                                          : VisibilityBuffer::Shading::NORMAL_MAPPED;
+        visibilityBuffer->setTriangles(binnedTriangles, binnedSetups, getThreadPool().getThreadCount(), shading);
+    }
+    
+    // Tiles own disjoint pixels, so they can be rasterized concurrently
+    getThreadPool().parallelFor(binner.getTileCount(), [&](size_t tile) {
+        TileRect clip = binner.getTileRect(static_cast<int>(tile));
+        VisibilityTile* visibilityTile = deferred ? &visibilityBuffer->getTile() : nullptr;
+        
+        binner.forEachPrimitive(static_cast<int>(tile), [&](size_t chunk, uint32_t index) {
+            if (mode == RenderMode::WIREFRAME) {
+                const ScreenLine& line = binnedLines[chunk][index];
+                drawLine(line.x0, line.y0, line.x1, line.y1, line.color, clip);
+                return;
+            }
+            
+            const ScreenTriangle& t = binnedTriangles[chunk][index];
+            const TriangleSetup& setup = binnedSetups[chunk][index];
+            
+            if (depthTested && isOccludedInTile(tile, t, clip)) {
+                return;
+            }
+            
+            if (deferred) {
+                edgeRasterizer.drawVisibilityTriangle(t, setup, visibilityBuffer->getTriangleId(chunk, index), *visibilityTile, clip);
+                return;
+            }
+            
+            if (rasterBackend != RasterBackend::SCANLINE) {
+                switch (mode) {
+                    case RenderMode::SOLID:
+                        edgeRasterizer.drawTriangle(t, clip);
+                        break;
+                    case RenderMode::TEXTURED:
+                        edgeRasterizer.drawTexturedTriangle(t, setup, sampler, clip);
+                        break;
+                    case RenderMode::TEXTURED_SHADED:
+                        edgeRasterizer.drawShadedTriangle(t, setup, sampler, clip);
+                        break;
+                    case RenderMode::NORMAL_MAPPED:
+                        edgeRasterizer.drawNormalMappedTriangle(t, setup, sampler, normalSampler, clip);
+                        break;
+                    case RenderMode::COLORFUL:
+                        edgeRasterizer.drawDepthTriangle(t, setup, clip);
+                        break;
+                    case RenderMode::WIREFRAME:
+                        break;
+                }
+                return;
+            }
+            
+            switch (mode) {
+                case RenderMode::SOLID:
+                    scanlineRasterizer.drawTriangle<FlatVaryings>(t, setup, sampler, clip);
+                    break;
+                case RenderMode::TEXTURED:
+                    scanlineRasterizer.drawTriangle<TexturedVaryings>(t, setup, sampler, clip);
+                    break;
+                case RenderMode::TEXTURED_SHADED:
+                    scanlineRasterizer.drawTriangle<ShadedVaryings>(t, setup, sampler, clip);
+                    break;
+                case RenderMode::NORMAL_MAPPED:
+                    scanlineRasterizer.drawTriangle<NormalMappedVaryings>(t, setup, normalMappedSamplers, clip);
+                    break;
+                case RenderMode::COLORFUL:
+                    scanlineRasterizer.drawTriangle<DepthVaryings>(t, setup, sampler, clip);
+                    break;
+                case RenderMode::WIREFRAME:
+                    break;
+            }
+        });
+        
+        // Second pass: texture and light every visible pixel of the tile exactly once
+        if (deferred) {
+            visibilityBuffer->shade(*visibilityTile, clip, sampler, &normalSampler);
+        }
+    });
+    
+    for (size_t occluded : tileOccluded) {
+        cullStats.occluded += occluded;
+    }
+}
+
+bool Renderer::isOccludedInTile(size_t tile, const ScreenTriangle& t, const TileRect& clip) {
+    // Pixels of the triangle's bounding box inside this tile
+    int x0 = std::max(clip.x0, static_cast<int>(std::floor(std::min({t.x[0], t.x[1], t.x[2]}))));
+    int y0 = std::max(clip.y0, static_cast<int>(std::floor(std::min({t.y[0], t.y[1], t.y[2]}))));
+    int x1 = std::min(clip.x1 - 1, static_cast<int>(std::ceil(std::max({t.x[0], t.x[1], t.x[2]}))));
+    int y1 = std::min(clip.y1 - 1, static_cast<int>(std::ceil(std::max({t.y[0], t.y[1], t.y[2]}))));
+    
+    // Coarse occlusion: skip the triangle if it lies behind every 8x8 block it touches here
+    float minDepth = std::min({t.z[0], t.z[1], t.z[2]});
+    if (hiZBuffer.isOccluded(x0, y0, x1, y1, minDepth)) {
+        ++tileOccluded[tile];
+        return true;
+    }
+    hiZBuffer.markDirty(x0, y0, x1, y1);
+    return false;
+}
+
+void Renderer::prepareFrame(const Model& model, bool coneCulling) {
+    // Reject whole meshlets first
+    Eigen::Matrix4f mvp = projectionMatrix * viewMatrix * modelMatrix;
+    cullStats = CullStats();
+    cullMeshlets(model, mvp, coneCulling);
+    
+    // Transform every vertex of the visible meshlets once; the face setup only reads the cached results
+    vertexProcessor.process(model.getVertices(), vertexMask, mvp, width, height, getThreadPool());
+}
+
+void Renderer::logFrame(std::chrono::steady_clock::time_point startTime) const {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    spdlog::info("Frame rendered in {:.2f} ms", elapsed.count());
+    
+    spdlog::info("Culled {} of {} meshlets (frustum: {}, backface: {})",
+                 cullStats.meshletFrustum + cullStats.meshletBackface, cullStats.meshlets,
+                 cullStats.meshletFrustum, cullStats.meshletBackface);
+    if (cullStats.triangles > 0) {
+        spdlog::info("Culled {} of {} triangles (frustum: {}, backface: {}, zero area: {}), "
+                     "{} triangle-tile pairs rejected by hierarchical z",
+                     cullStats.frustum + cullStats.backface + cullStats.zeroArea, cullStats.triangles,
+                     cullStats.frustum, cullStats.backface, cullStats.zeroArea, cullStats.occluded);
+    }
+}
+
 void Renderer::render(const Model& model) {
     spdlog::info("Rendering model with {} mode", static_cast<int>(renderMode));
     
+    auto startTime = std::chrono::steady_clock::now();
+    
+    // Wireframe shows hidden edges, so it only uses the frustum test
+    prepareFrame(model, renderMode != RenderMode::WIREFRAME);
+    
     switch (renderMode) {
         case RenderMode::WIREFRAME:
             renderWireframe(model);
@@ -98,112 +515,66 @@ void Renderer::render(const Model& model) {
         case RenderMode::COLORFUL:
             renderColorful(model);
             break;
+        case RenderMode::NORMAL_MAPPED:
+            renderNormalMapped(model);
+            break;
     }
+    
+    logFrame(startTime);
 }
 
 void Renderer::renderWireframe(const Model& model) {
-    const auto& vertices = model.getVertices();
-    const auto& faces = model.getFaces();
-    
-    // Model-view-projection matrix
-    Eigen::Matrix4f mvp = projectionMatrix * viewMatrix * modelMatrix;
+    const auto& triangles = model.getTriangles();
+    const auto& triangleFlags = model.getTriangleFlags();
     
-    // Draw each face as a wireframe
-    for (const auto& face : faces) {
-        const auto& vertexIndices = face.vertexIndices;
+    // Set up each triangle as a set of wireframe edges
+    binTriangles([&](size_t chunk, size_t triangleIndex) {
+        const auto& vertexIndices = triangles[triangleIndex].vertexIndices;
         
-        // Draw edges of the face
-        for (size_t i = 0; i < vertexIndices.size(); ++i) {
-            size_t j = (i + 1) % vertexIndices.size(); // Next vertex (wrap around for the last one)
-            
-            // Get 3D vertices
-            Eigen::Vector3f v0 = vertices[vertexIndices[i]];
-            Eigen::Vector3f v1 = vertices[vertexIndices[j]];
-            
-            // Convert to homogeneous coordinates
-            Eigen::Vector4f v0h(v0.x(), v0.y(), v0.z(), 1.0f);
-            Eigen::Vector4f v1h(v1.x(), v1.y(), v1.z(), 1.0f);
-            
-            // Apply MVP transformation
-            Eigen::Vector4f p0 = mvp * v0h;
-            Eigen::Vector4f p1 = mvp * v1h;
-            
-            // Perspective division
-            p0 /= p0.w();
-            p1 /= p1.w();
-            
-            // Viewport transformation - FIXED: invert Y coordinate to fix upside-down rendering
-            int x0 = static_cast<int>((p0.x() + 1.0f) * 0.5f * width);
-            int y0 = static_cast<int>((p0.y() + 1.0f) * 0.5f * height); // Changed from (1.0f - p0.y())
-            int x1 = static_cast<int>((p1.x() + 1.0f) * 0.5f * width);
-            int y1 = static_cast<int>((p1.y() + 1.0f) * 0.5f * height); // Changed from (1.0f - p1.y())
-            
-            // Draw the line
-            drawLine(x0, y0, x1, y1, 0xFFFFFFFF); // White color
+        // Draw the edges of the original polygon, not the diagonals added by triangulation
+        for (int i = 0; i < 3; ++i) {
+            if (triangleFlags[triangleIndex] & (1 << i)) {
+                submitLine(chunk, vertexIndices[i], vertexIndices[(i + 1) % 3], 0xFFFFFFFF); // White color
+            }
         }
-    }
+    });
+    
+    rasterizeTiles(RenderMode::WIREFRAME, nullptr);
 }
 
 void Renderer::renderSolid(const Model& model) {
     const auto& vertices = model.getVertices();
-    const auto& faces = model.getFaces();
+    const auto& triangles = model.getTriangles();
     const auto& normals = model.getNormals();
-    
-    // Model-view-projection matrix
-    Eigen::Matrix4f mvp = projectionMatrix * viewMatrix * modelMatrix;
+    const auto& triangleFlags = model.getTriangleFlags();
     
     // Direction to light source (for simple diffuse lighting)
     Eigen::Vector3f lightDir = (Eigen::Vector3f(1, 1, 1)).normalized();
     
-    // Draw each face as a filled triangle
-    for (const auto& face : faces) {
+    // Set up each triangle with a flat diffuse shade
+    binTriangles([&](size_t chunk, size_t triangleIndex) {
+        const auto& face = triangles[triangleIndex];
         const auto& vertexIndices = face.vertexIndices;
-        const auto& normalIndices = face.normalIndices;
-        
-        // Skip faces that are not triangles
-        if (vertexIndices.size() != 3) {
-            continue;
-        }
+        const bool hasNormals = triangleFlags[triangleIndex] & Model::HAS_NORMALS;
         
         // Get vertices
         Eigen::Vector3f v0 = vertices[vertexIndices[0]];
         Eigen::Vector3f v1 = vertices[vertexIndices[1]];
         Eigen::Vector3f v2 = vertices[vertexIndices[2]];
         
-        // Convert to homogeneous coordinates
-        Eigen::Vector4f v0h(v0.x(), v0.y(), v0.z(), 1.0f);
-        Eigen::Vector4f v1h(v1.x(), v1.y(), v1.z(), 1.0f);
-        Eigen::Vector4f v2h(v2.x(), v2.y(), v2.z(), 1.0f);
-        
-        // Apply MVP transformation
-        Eigen::Vector4f p0 = mvp * v0h;
-        Eigen::Vector4f p1 = mvp * v1h;
-        Eigen::Vector4f p2 = mvp * v2h;
-        
-        // Perspective division
-        p0 /= p0.w();
-        p1 /= p1.w();
-        p2 /= p2.w();
-        
-        // Viewport transformation - FIXED: invert Y coordinate to fix upside-down rendering
-        int x0 = static_cast<int>((p0.x() + 1.0f) * 0.5f * width);
-        int y0 = static_cast<int>((p0.y() + 1.0f) * 0.5f * height); // Changed from (1.0f - p0.y())
-        int x1 = static_cast<int>((p1.x() + 1.0f) * 0.5f * width);
-        int y1 = static_cast<int>((p1.y() + 1.0f) * 0.5f * height); // Changed from (1.0f - p1.y())
-        int x2 = static_cast<int>((p2.x() + 1.0f) * 0.5f * width);
-        int y2 = static_cast<int>((p2.y() + 1.0f) * 0.5f * height); // Changed from (1.0f - p2.y())
+        ScreenTriangle triangle{};
         
         // Calculate face normal for shading if no vertex normals are provided
         Eigen::Vector3f normal;
-        if (normalIndices.empty()) {
+        if (!hasNormals) {
             Eigen::Vector3f edge1 = v1 - v0;
             Eigen::Vector3f edge2 = v2 - v0;
             normal = edge1.cross(edge2).normalized();
         } else {
             // Use average of vertex normals for simple shading
-            normal = (normals[normalIndices[0]] + 
-                     normals[normalIndices[1]] + 
-                     normals[normalIndices[2]]).normalized();
+            normal = (normals[vertexIndices[0]] + 
+                     normals[vertexIndices[1]] + 
+                     normals[vertexIndices[2]]).normalized();
         }
         
         // Simple diffuse lighting
@@ -213,19 +584,21 @@ void Renderer::renderSolid(const Model& model) {
         uint8_t r = static_cast<uint8_t>(255 * intensity);
         uint8_t g = static_cast<uint8_t>(255 * intensity);
         uint8_t b = static_cast<uint8_t>(255 * intensity);
-        uint32_t color = (0xFF << 24) | (r << 16) | (g << 8) | b;
+        triangle.color = (0xFF << 24) | (r << 16) | (g << 8) | b;
         
-        // Draw the triangle
-        drawTriangle(x0, y0, x1, y1, x2, y2, color);
-    }
+        submitTriangle(chunk, vertexIndices[0], vertexIndices[1], vertexIndices[2], triangle);
+    });
+    
+    rasterizeTiles(RenderMode::SOLID, nullptr);
 }
 
 void Renderer::renderTextured(const Model& model) {
     const auto& vertices = model.getVertices();
-    const auto& faces = model.getFaces();
+    const auto& triangles = model.getTriangles();
     const auto& textureCoords = model.getTextureCoords();
     const auto& normals = model.getNormals();
-    std::shared_ptr<Texture> texture = model.getTexture();
+    const auto& triangleFlags = model.getTriangleFlags();
+    std::shared_ptr<const Texture> texture = model.getTexture();
     
     // Check if texture is available
     if (!texture) {
@@ -234,21 +607,18 @@ void Renderer::renderTextured(const Model& model) {
         return;
     }
     
-    // Model-view-projection matrix
-    Eigen::Matrix4f mvp = projectionMatrix * viewMatrix * modelMatrix;
-    
     // Direction to light source (for simple diffuse lighting)
     Eigen::Vector3f lightDir = (Eigen::Vector3f(1, 1, 1)).normalized();
     
-    // Draw each face as a textured triangle
-    for (const auto& face : faces) {
+    // Set up each triangle with its texture coordinates
+    binTriangles([&](size_t chunk, size_t triangleIndex) {
+        const auto& face = triangles[triangleIndex];
         const auto& vertexIndices = face.vertexIndices;
-        const auto& textureIndices = face.textureIndices;
-        const auto& normalIndices = face.normalIndices;
+        const bool hasNormals = triangleFlags[triangleIndex] & Model::HAS_NORMALS;
         
-        // Skip faces that are not triangles
-        if (vertexIndices.size() != 3 || textureIndices.size() != 3) {
-            continue;
+        // Skip triangles without texture coordinates
+        if (!(triangleFlags[triangleIndex] & Model::HAS_TEXTURE_COORDS)) {
+            return;
         }
         
         // Get vertices
@@ -257,130 +627,64 @@ void Renderer::renderTextured(const Model& model) {
         Eigen::Vector3f v2 = vertices[vertexIndices[2]];
         
         // Get texture coordinates
-        Eigen::Vector2f t0 = textureCoords[textureIndices[0]];
-        Eigen::Vector2f t1 = textureCoords[textureIndices[1]];
-        Eigen::Vector2f t2 = textureCoords[textureIndices[2]];
+        Eigen::Vector2f t0 = textureCoords[vertexIndices[0]];
+        Eigen::Vector2f t1 = textureCoords[vertexIndices[1]];
+        Eigen::Vector2f t2 = textureCoords[vertexIndices[2]];
         
-        // Convert to homogeneous coordinates
-        Eigen::Vector4f v0h(v0.x(), v0.y(), v0.z(), 1.0f);
-        Eigen::Vector4f v1h(v1.x(), v1.y(), v1.z(), 1.0f);
-        Eigen::Vector4f v2h(v2.x(), v2.y(), v2.z(), 1.0f);
+        ScreenTriangle triangle;
         
-        // Apply MVP transformation
-        Eigen::Vector4f p0 = mvp * v0h;
-        Eigen::Vector4f p1 = mvp * v1h;
-        Eigen::Vector4f p2 = mvp * v2h;
-        
-        // Store z-values for depth testing
-        float z0 = p0.z() / p0.w();
-        float z1 = p1.z() / p1.w();
-        float z2 = p2.z() / p2.w();
-        
-        // Perspective division
-        p0 /= p0.w();
-        p1 /= p1.w();
-        p2 /= p2.w();
-        
-        // Viewport transformation - FIXED: invert Y coordinate to fix upside-down rendering
-        int x0 = static_cast<int>((p0.x() + 1.0f) * 0.5f * width);
-        int y0 = static_cast<int>((p0.y() + 1.0f) * 0.5f * height); // Changed from (1.0f - p0.y())
-        int x1 = static_cast<int>((p1.x() + 1.0f) * 0.5f * width);
-        int y1 = static_cast<int>((p1.y() + 1.0f) * 0.5f * height); // Changed from (1.0f - p1.y())
-        int x2 = static_cast<int>((p2.x() + 1.0f) * 0.5f * width);
-        int y2 = static_cast<int>((p2.y() + 1.0f) * 0.5f * height); // Changed from (1.0f - p2.y())
+        // Flip V coordinate
+        triangle.u[0] = t0.x(); triangle.v[0] = 1.0f - t0.y();
+        triangle.u[1] = t1.x(); triangle.v[1] = 1.0f - t1.y();
+        triangle.u[2] = t2.x(); triangle.v[2] = 1.0f - t2.y();
         
         // Calculate face normal for simple lighting
         Eigen::Vector3f normal;
-        if (normalIndices.empty()) {
+        if (!hasNormals) {
             Eigen::Vector3f edge1 = v1 - v0;
             Eigen::Vector3f edge2 = v2 - v0;
             normal = edge1.cross(edge2).normalized();
         } else {
             // Use average of vertex normals
-            normal = (normals[normalIndices[0]] + 
-                    normals[normalIndices[1]] + 
-                    normals[normalIndices[2]]).normalized();
+            normal = (normals[vertexIndices[0]] + 
+                    normals[vertexIndices[1]] + 
+                    normals[vertexIndices[2]]).normalized();
         }
         
         // Enhanced lighting: increase ambient component for better visibility
         float intensity = std::max(0.4f, normal.dot(lightDir) * 0.8f);
+        triangle.intensity[0] = triangle.intensity[1] = triangle.intensity[2] = intensity;
         
-        // Draw the textured triangle
-        renderTexturedTriangle(
-            x0, y0, z0, t0.x(), 1.0f - t0.y(), // Flip V coordinate
-            x1, y1, z1, t1.x(), 1.0f - t1.y(), // Flip V coordinate
-            x2, y2, z2, t2.x(), 1.0f - t2.y(), // Flip V coordinate
-            intensity, *texture);
-    }
+        submitTriangle(chunk, vertexIndices[0], vertexIndices[1], vertexIndices[2], triangle);
+    });
+    
+    rasterizeTiles(RenderMode::TEXTURED, texture.get());
 }
 
 void Renderer::renderColorful(const Model& model) {
-    const auto& vertices = model.getVertices();
-    const auto& faces = model.getFaces();
+    const auto& triangles = model.getTriangles();
     
     // Clear z-buffer
     std::fill(zBuffer.begin(), zBuffer.end(), std::numeric_limits<float>::infinity());
+    hiZBuffer.clear();
     
-    // Model-view-projection matrix
-    Eigen::Matrix4f mvp = projectionMatrix * viewMatrix * modelMatrix;
+    // Pick the random triangle colors up front, rand() must not be called from the worker threads
+    std::vector<uint32_t> triangleColors(triangles.size());
+    for (auto& color : triangleColors) {
+        color = generateRandomColor();
+    }
     
-    // Draw each triangular face with a random color
-    for (const auto& face : faces) {
-        // Skip faces that are not triangles
-        if (face.vertexIndices.size() != 3) {
-            continue;
-        }
-        
-        // Process vertices
-        Eigen::Vector3f v0 = vertices[face.vertexIndices[0]];
-        Eigen::Vector3f v1 = vertices[face.vertexIndices[1]];
-        Eigen::Vector3f v2 = vertices[face.vertexIndices[2]];
-        
-        // Convert to homogeneous coordinates
-        Eigen::Vector4f v0h(v0.x(), v0.y(), v0.z(), 1.0f);
-        Eigen::Vector4f v1h(v1.x(), v1.y(), v1.z(), 1.0f);
-        Eigen::Vector4f v2h(v2.x(), v2.y(), v2.z(), 1.0f);
-        
-        // Apply MVP transformation
-        Eigen::Vector4f p0 = mvp * v0h;
-        Eigen::Vector4f p1 = mvp * v1h;
-        Eigen::Vector4f p2 = mvp * v2h;
+    // Set up each triangle with its random color
+    binTriangles([&](size_t chunk, size_t triangleIndex) {
+        const auto& face = triangles[triangleIndex];
         
-        // Store z-values for depth testing
-        float z0 = p0.z() / p0.w();
-        float z1 = p1.z() / p1.w();
-        float z2 = p2.z() / p2.w();
+        ScreenTriangle triangle{};
+        triangle.color = triangleColors[triangleIndex];
         
-        // Perspective division
-        p0 /= p0.w();
-        p1 /= p1.w();
-        p2 /= p2.w();
-        
-        // Viewport transformation
-        float x0 = (p0.x() + 1.0f) * 0.5f * width;
-        float y0 = (p0.y() + 1.0f) * 0.5f * height;
-        float x1 = (p1.x() + 1.0f) * 0.5f * width;
-        float y1 = (p1.y() + 1.0f) * 0.5f * height;
-        float x2 = (p2.x() + 1.0f) * 0.5f * width;
-        float y2 = (p2.y() + 1.0f) * 0.5f * height;
-        
-        // Create vertices with z-buffer information
-        Vertex vert0 = {x0, y0, z0};
-        Vertex vert1 = {x1, y1, z1};
-        Vertex vert2 = {x2, y2, z2};
-        
-        // Backface culling using signed area in screen space
-        float signed_area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
-        if (signed_area <= 0) {
-            continue;
-        }
-        
-        // Generate a random color for this triangle
-        uint32_t color = generateRandomColor();
-        
-        // Draw the triangle with z-buffer support
-        drawTriangle(vert0, vert1, vert2, color);
-    }
+        submitTriangle(chunk, face.vertexIndices[0], face.vertexIndices[1], face.vertexIndices[2], triangle);
+    });
+    
+    rasterizeTiles(RenderMode::COLORFUL, nullptr);
 }
 
 uint32_t Renderer::generateRandomColor() {
@@ -395,10 +699,11 @@ uint32_t Renderer::generateRandomColor() {
 
 void Renderer::renderTexturedShaded(const Model& model) {
     const auto& vertices = model.getVertices();
-    const auto& faces = model.getFaces();
+    const auto& triangles = model.getTriangles();
     const auto& textureCoords = model.getTextureCoords();
     const auto& normals = model.getNormals();
-    std::shared_ptr<Texture> texture = model.getTexture();
+    const auto& triangleFlags = model.getTriangleFlags();
+    std::shared_ptr<const Texture> texture = model.getTexture();
     
     // Check if texture is available
     if (!texture) {
@@ -407,9 +712,6 @@ void Renderer::renderTexturedShaded(const Model& model) {
         return;
     }
     
-    // Model-view-projection matrix
-    Eigen::Matrix4f mvp = projectionMatrix * viewMatrix * modelMatrix;
-    
     // View matrix for transforming normals
     Eigen::Matrix3f normalMatrix = viewMatrix.block<3,3>(0,0);
     
@@ -419,15 +721,15 @@ void Renderer::renderTexturedShaded(const Model& model) {
     // Camera position in world space for specular highlights
     Eigen::Vector3f worldCameraPos = cameraPosition;
     
-    // Draw each face
-    for (const auto& face : faces) {
+    // Set up each triangle
+    binTriangles([&](size_t chunk, size_t triangleIndex) {
+        const auto& face = triangles[triangleIndex];
         const auto& vertexIndices = face.vertexIndices;
-        const auto& textureIndices = face.textureIndices;
-        const auto& normalIndices = face.normalIndices;
+        const bool hasNormals = triangleFlags[triangleIndex] & Model::HAS_NORMALS;
         
-        // Skip faces that are not triangles
-        if (vertexIndices.size() != 3 || textureIndices.size() != 3) {
-            continue;
+        // Skip triangles without texture coordinates
+        if (!(triangleFlags[triangleIndex] & Model::HAS_TEXTURE_COORDS)) {
+            return;
         }
         
         // Get vertices
@@ -436,48 +738,27 @@ void Renderer::renderTexturedShaded(const Model& model) {
         Eigen::Vector3f v2 = vertices[vertexIndices[2]];
         
         // Get texture coordinates
-        Eigen::Vector2f t0 = textureCoords[textureIndices[0]];
-        Eigen::Vector2f t1 = textureCoords[textureIndices[1]];
-        Eigen::Vector2f t2 = textureCoords[textureIndices[2]];
+        Eigen::Vector2f t0 = textureCoords[vertexIndices[0]];
+        Eigen::Vector2f t1 = textureCoords[vertexIndices[1]];
+        Eigen::Vector2f t2 = textureCoords[vertexIndices[2]];
         
-        // Convert to homogeneous coordinates
-        Eigen::Vector4f v0h(v0.x(), v0.y(), v0.z(), 1.0f);
-        Eigen::Vector4f v1h(v1.x(), v1.y(), v1.z(), 1.0f);
-        Eigen::Vector4f v2h(v2.x(), v2.y(), v2.z(), 1.0f);
+        ScreenTriangle triangle;
         
-        // Apply MVP transformation
-        Eigen::Vector4f p0 = mvp * v0h;
-        Eigen::Vector4f p1 = mvp * v1h;
-        Eigen::Vector4f p2 = mvp * v2h;
-        
-        // Store z-values for depth testing
-        float z0 = p0.z() / p0.w();
-        float z1 = p1.z() / p1.w();
-        float z2 = p2.z() / p2.w();
-        
-        // Perspective division
-        p0 /= p0.w();
-        p1 /= p1.w();
-        p2 /= p2.w();
-        
-        // Viewport transformation
-        int x0 = static_cast<int>((p0.x() + 1.0f) * 0.5f * width);
-        int y0 = static_cast<int>((p0.y() + 1.0f) * 0.5f * height);
-        int x1 = static_cast<int>((p1.x() + 1.0f) * 0.5f * width);
-        int y1 = static_cast<int>((p1.y() + 1.0f) * 0.5f * height);
-        int x2 = static_cast<int>((p2.x() + 1.0f) * 0.5f * width);
-        int y2 = static_cast<int>((p2.y() + 1.0f) * 0.5f * height);
+        // Flip V coordinate
+        triangle.u[0] = t0.x(); triangle.v[0] = 1.0f - t0.y();
+        triangle.u[1] = t1.x(); triangle.v[1] = 1.0f - t1.y();
+        triangle.u[2] = t2.x(); triangle.v[2] = 1.0f - t2.y();
         
         // Calculate lighting for each vertex
         float i0 = 0.2f;  // Ambient base lighting
         float i1 = 0.2f;
         float i2 = 0.2f;
         
-        if (!normalIndices.empty()) {
+        if (hasNormals) {
             // Get and transform normals to view space
-            Eigen::Vector3f n0 = normalMatrix * normals[normalIndices[0]].normalized();
-            Eigen::Vector3f n1 = normalMatrix * normals[normalIndices[1]].normalized();
-            Eigen::Vector3f n2 = normalMatrix * normals[normalIndices[2]].normalized();
+            Eigen::Vector3f n0 = normalMatrix * normals[vertexIndices[0]].normalized();
+            Eigen::Vector3f n1 = normalMatrix * normals[vertexIndices[1]].normalized();
+            Eigen::Vector3f n2 = normalMatrix * normals[vertexIndices[2]].normalized();
             
             // Calculate view vectors for specular highlights
             Eigen::Vector3f view0 = (worldCameraPos - v0).normalized();
@@ -517,358 +798,110 @@ void Renderer::renderTexturedShaded(const Model& model) {
         }
         
         // Clamp lighting intensities
-        i0 = std::min(1.0f, i0);
-        i1 = std::min(1.0f, i1);
-        i2 = std::min(1.0f, i2);
+        triangle.intensity[0] = std::min(1.0f, i0);
+        triangle.intensity[1] = std::min(1.0f, i1);
+        triangle.intensity[2] = std::min(1.0f, i2);
         
-        // Render the triangle with per-vertex lighting
-        renderShadedTriangle(
-            x0, y0, z0, t0.x(), 1.0f - t0.y(), i0,
-            x1, y1, z1, t1.x(), 1.0f - t1.y(), i1,
-            x2, y2, z2, t2.x(), 1.0f - t2.y(), i2,
-            *texture);
-    }
-}
-
-void Renderer::renderTexturedTriangle(
-    int x0, int y0, float z0, float u0, float v0,
-    int x1, int y1, float z1, float u1, float v1,
-    int x2, int y2, float z2, float u2, float v2,
-    float lightIntensity, const Texture& texture) {
-    
-    // Sort vertices by y-coordinate
-    if (y0 > y1) {
-        std::swap(x0, x1);
-        std::swap(y0, y1);
-        std::swap(z0, z1);
-        std::swap(u0, u1);
-        std::swap(v0, v1);
-    }
-    if (y0 > y2) {
-        std::swap(x0, x2);
-        std::swap(y0, y2);
-        std::swap(z0, z2);
-        std::swap(u0, u2);
-        std::swap(v0, v2);
-    }
-    if (y1 > y2) {
-        std::swap(x1, x2);
-        std::swap(y1, y2);
-        std::swap(z1, z2);
-        std::swap(u1, u2);
-        std::swap(v1, v2);
-    }
+        submitTriangle(chunk, vertexIndices[0], vertexIndices[1], vertexIndices[2], triangle);
+    });
     
-    // Calculate slopes and interpolation values
-    float dy1 = y1 - y0;
-    float dy2 = y2 - y0;
-    float dy3 = y2 - y1;
-    
-    // Handle special cases for vertical edges
-    float dx1 = (dy1 != 0) ? (x1 - x0) / dy1 : 0;
-    float dx2 = (dy2 != 0) ? (x2 - x0) / dy2 : 0;
-    float dx3 = (dy3 != 0) ? (x2 - x1) / dy3 : 0;
-    
-    // Z interpolation
-    float dz1 = (dy1 != 0) ? (z1 - z0) / dy1 : 0;
-    float dz2 = (dy2 != 0) ? (z2 - z0) / dy2 : 0;
-    float dz3 = (dy3 != 0) ? (z2 - z1) / dy3 : 0;
-    
-    // Texture coordinate interpolation
-    float du1 = (dy1 != 0) ? (u1 - u0) / dy1 : 0;
-    float du2 = (dy2 != 0) ? (u2 - u0) / dy2 : 0;
-    float du3 = (dy3 != 0) ? (u2 - u1) / dy3 : 0;
-    
-    float dv1 = (dy1 != 0) ? (v1 - v0) / dy1 : 0;
-    float dv2 = (dy2 != 0) ? (v2 - v0) / dy2 : 0;
-    float dv3 = (dy3 != 0) ? (v2 - v1) / dy3 : 0;
-    
-    // Draw the upper part of the triangle
-    if (dy1 > 0) {
-        drawTexturedScanlines(
-            y0, y1,
-            x0, dx1, x0, dx2,
-            z0, dz1, z0, dz2,
-            u0, du1, u0, du2,
-            v0, dv1, v0, dv2,
-            lightIntensity, texture);
-    }
-    
-    // Draw the lower part of the triangle
-    if (dy3 > 0) {
-        drawTexturedScanlines(
-            y1, y2,
-            x1, dx3, x0 + dx2 * dy1, dx2,
-            z1, dz3, z0 + dz2 * dy1, dz2,
-            u1, du3, u0 + du2 * dy1, du2,
-            v1, dv3, v0 + dv2 * dy1, dv2,
-            lightIntensity, texture);
-    }
-}
-
-void Renderer::drawTexturedScanlines(
-    int yStart, int yEnd,
-    float xLeft, float dxLeft, float xRight, float dxRight,
-    float zLeft, float dzLeft, float zRight, float dzRight,
-    float uLeft, float duLeft, float uRight, float duRight,
-    float vLeft, float dvLeft, float vRight, float dvRight,
-    float lightIntensity, const Texture& texture) {
-    
-    for (int y = yStart; y < yEnd; y++) {
-        float xL = xLeft;
-        float xR = xRight;
-        float zL = zLeft;
-        float zR = zRight;
-        float uL = uLeft;
-        float vL = vLeft;
-        float uR = uRight;
-        float vR = vRight;
-        
-        // Swap if needed to ensure left to right
-        if (xL > xR) {
-            std::swap(xL, xR);
-            std::swap(zL, zR);
-            std::swap(uL, uR);
-            std::swap(vL, vR);
-        }
-        
-        // Get starting and ending x-coordinates
-        int xStart = static_cast<int>(std::ceil(xL));
-        int xEnd = static_cast<int>(std::ceil(xR));
-        
-        // Calculate interpolation steps along the scanline
-        float dx = xR - xL;
-        float dz = (dx != 0) ? (zR - zL) / dx : 0;
-        float du = (dx != 0) ? (uR - uL) / dx : 0;
-        float dv = (dx != 0) ? (vR - vL) / dx : 0;
-        
-        // Adjust for the first pixel
-        float xOffset = xStart - xL;
-        float z = zL + dz * xOffset;
-        float u = uL + du * xOffset;
-        float v = vL + dv * xOffset;
-        
-        // Draw the scanline
-        for (int x = xStart; x < xEnd; x++) {
-            // Check if this pixel is in front (using z-buffer)
-            int index = y * width + x;
-            if (x >= 0 && x < width && y >= 0 && y < height && z < zBuffer[index]) {
-                // Get texel color
-                uint32_t color = texture.getColorAt(u, v);
-                
-                // Apply lighting
-                uint8_t r = static_cast<uint8_t>(((color >> 16) & 0xFF) * lightIntensity);
-                uint8_t g = static_cast<uint8_t>(((color >> 8) & 0xFF) * lightIntensity);
-                uint8_t b = static_cast<uint8_t>((color & 0xFF) * lightIntensity);
-                uint8_t a = static_cast<uint8_t>((color >> 24) & 0xFF);
-                
-                uint32_t shadedColor = (a << 24) | (r << 16) | (g << 8) | b;
-                
-                // Update frame buffer and z-buffer
-                frameBuffer[index] = shadedColor;
-                zBuffer[index] = z;
-            }
-            
-            // Increment for the next pixel
-            z += dz;
-            u += du;
-            v += dv;
-        }
-        
-        // Update for the next scanline
-        xLeft += dxLeft;
-        xRight += dxRight;
-        zLeft += dzLeft;
-        zRight += dzRight;
-        uLeft += duLeft;
-        uRight += duRight;
-        vLeft += dvLeft;
-        vRight += dvRight;
-    }
+    // Render the triangles with per-vertex lighting
+    rasterizeTiles(RenderMode::TEXTURED_SHADED, texture.get());
 }
 
-void Renderer::renderShadedTriangle(
-    int x0, int y0, float z0, float u0, float v0, float i0,
-    int x1, int y1, float z1, float u1, float v1, float i1,
-    int x2, int y2, float z2, float u2, float v2, float i2,
-    const Texture& texture) {
-    
-    // Sort vertices by y-coordinate
-    if (y0 > y1) {
-        std::swap(x0, x1);
-        std::swap(y0, y1);
-        std::swap(z0, z1);
-        std::swap(u0, u1);
-        std::swap(v0, v1);
-        std::swap(i0, i1);
-    }
-    if (y0 > y2) {
-        std::swap(x0, x2);
-        std::swap(y0, y2);
-        std::swap(z0, z2);
-        std::swap(u0, u2);
-        std::swap(v0, v2);
-        std::swap(i0, i2);
+void Renderer::renderNormalMapped(const Model& model) {
+    const auto& vertices = model.getVertices();
+    const auto& triangles = model.getTriangles();
+    const auto& textureCoords = model.getTextureCoords();
+    const auto& normals = model.getNormals();
+    const auto& triangleFlags = model.getTriangleFlags();
+    std::shared_ptr<const Texture> texture = model.getTexture();
+    std::shared_ptr<const Texture> normalMap = model.getNormalMap();
+    
+    if (!texture) {
+        spdlog::warn("No texture available, falling back to solid rendering");
+        renderSolid(model);
+        return;
     }
-    if (y1 > y2) {
-        std::swap(x1, x2);
-        std::swap(y1, y2);
-        std::swap(z1, z2);
-        std::swap(u1, u2);
-        std::swap(v1, v2);
-        std::swap(i1, i2);
+    if (!normalMap) {
+        spdlog::warn("No normal map available, falling back to textured and shaded rendering");
+        renderTexturedShaded(model);
+        return;
     }
     
-    // Calculate slopes and interpolation values
-    float dy1 = y1 - y0;
-    float dy2 = y2 - y0;
-    float dy3 = y2 - y1;
-    
-    // Handle special cases for vertical edges
-    float dx1 = (dy1 != 0) ? (x1 - x0) / dy1 : 0;
-    float dx2 = (dy2 != 0) ? (x2 - x0) / dy2 : 0;
-    float dx3 = (dy3 != 0) ? (x2 - x1) / dy3 : 0;
-    
-    // Z interpolation
-    float dz1 = (dy1 != 0) ? (z1 - z0) / dy1 : 0;
-    float dz2 = (dy2 != 0) ? (z2 - z0) / dy2 : 0;
-    float dz3 = (dy3 != 0) ? (z2 - z1) / dy3 : 0;
-    
-    // Texture coordinate interpolation
-    float du1 = (dy1 != 0) ? (u1 - u0) / dy1 : 0;
-    float du2 = (dy2 != 0) ? (u2 - u0) / dy2 : 0;
-    float du3 = (dy3 != 0) ? (u2 - u1) / dy3 : 0;
-    
-    float dv1 = (dy1 != 0) ? (v1 - v0) / dy1 : 0;
-    float dv2 = (dy2 != 0) ? (v2 - v0) / dy2 : 0;
-    float dv3 = (dy3 != 0) ? (v2 - v1) / dy3 : 0;
-    
-    // Lighting intensity interpolation
-    float di1 = (dy1 != 0) ? (i1 - i0) / dy1 : 0;
-    float di2 = (dy2 != 0) ? (i2 - i0) / dy2 : 0;
-    float di3 = (dy3 != 0) ? (i2 - i1) / dy3 : 0;
-    
-    // Draw the upper part of the triangle
-    if (dy1 > 0) {
-        drawShadedScanlines(
-            y0, y1,
-            x0, dx1, x0, dx2,
-            z0, dz1, z0, dz2,
-            u0, du1, u0, du2,
-            v0, dv1, v0, dv2,
-            i0, di1, i0, di2,
-            texture);
-    }
+    // Same light as the shaded mode, given in view space, brought into model space once per frame
+    Eigen::Vector3f lightDir = (Eigen::Vector3f(1, 1, 1)).normalized();
+    Eigen::Matrix3f modelView = (viewMatrix * modelMatrix).block<3,3>(0,0);
+    Eigen::Vector3f modelLight = (modelView.inverse() * lightDir).normalized();
     
-    // Draw the lower part of the triangle
-    if (dy3 > 0) {
-        drawShadedScanlines(
-            y1, y2,
-            x1, dx3, x0 + dx2 * dy1, dx2,
-            z1, dz3, z0 + dz2 * dy1, dz2,
-            u1, du3, u0 + du2 * dy1, du2,
-            v1, dv3, v0 + dv2 * dy1, dv2,
-            i1, di3, i0 + di2 * dy1, di2,
-            texture);
-    }
-}
-
-void Renderer::drawShadedScanlines(
-    int yStart, int yEnd,
-    float xLeft, float dxLeft, float xRight, float dxRight,
-    float zLeft, float dzLeft, float zRight, float dzRight,
-    float uLeft, float duLeft, float uRight, float duRight,
-    float vLeft, float dvLeft, float vRight, float dvRight,
-    float iLeft, float diLeft, float iRight, float diRight,
-    const Texture& texture) {
-    
-    for (int y = yStart; y < yEnd; y++) {
-        float xL = xLeft;
-        float xR = xRight;
-        float zL = zLeft;
-        float zR = zRight;
-        float uL = uLeft;
-        float vL = vLeft;
-        float uR = uRight;
-        float vR = vRight;
-        float iL = iLeft;
-        float iR = iRight;
+    const bool tangentSpace = model.getNormalSpace() == NormalSpace::TANGENT;
+    const Model::TangentFrames& frames = model.getTangentFrames();
+    
+    binTriangles([&](size_t chunk, size_t triangleIndex) {
+        const auto& face = triangles[triangleIndex];
+        const auto& vertexIndices = face.vertexIndices;
+        const bool hasNormals = triangleFlags[triangleIndex] & Model::HAS_NORMALS;
         
-        // Swap if needed to ensure left to right
-        if (xL > xR) {
-            std::swap(xL, xR);
-            std::swap(zL, zR);
-            std::swap(uL, uR);
-            std::swap(vL, vR);
-            std::swap(iL, iR);
+        // Skip triangles without texture coordinates
+        if (!(triangleFlags[triangleIndex] & Model::HAS_TEXTURE_COORDS)) {
+            return;
         }
         
-        // Get starting and ending x-coordinates
-        int xStart = static_cast<int>(std::ceil(xL));
-        int xEnd = static_cast<int>(std::ceil(xR));
-        
-        // Calculate interpolation steps along the scanline
-        float dx = xR - xL;
+        ScreenTriangle triangle;
+        for (int k = 0; k < 3; ++k) {
+            const Eigen::Vector2f& t = textureCoords[vertexIndices[k]];
+            triangle.u[k] = t.x();
+            triangle.v[k] = 1.0f - t.y();
+            triangle.intensity[k] = 1.0f;
+        }
         
-        if (dx > 0) {
-            float dz = (zR - zL) / dx;
-            float du = (uR - uL) / dx;
-            float dv = (vR - vL) / dx;
-            float di = (iR - iL) / dx;
-            
-            // Adjust for the first pixel
-            float xOffset = xStart - xL;
-            float z = zL + dz * xOffset;
-            float u = uL + du * xOffset;
-            float v = vL + dv * xOffset;
-            float intensity = iL + di * xOffset;
+        if (!tangentSpace) {
+            for (int k = 0; k < 3; ++k) {
+                triangle.lightX[k] = modelLight.x();
+                triangle.lightY[k] = modelLight.y();
+                triangle.lightZ[k] = modelLight.z();
+            }
+        } else {
+            Eigen::Vector3f faceNormal = Eigen::Vector3f::Zero();
+            if (!hasNormals) {
+                const Eigen::Vector3f& v0 = vertices[vertexIndices[0]];
+                faceNormal = (vertices[vertexIndices[1]] - v0).cross(vertices[vertexIndices[2]] - v0).normalized();
+            }
             
-            // Draw the scanline
-            for (int x = xStart; x < xEnd; x++) {
-                // Check if this pixel is in front (using z-buffer)
-                int index = y * width + x;
-                if (x >= 0 && x < width && y >= 0 && y < height && z < zBuffer[index]) {
-                    // Get texel color
-                    uint32_t color = texture.getColorAt(u, v);
-                    
-                    // Apply per-pixel lighting
-                    uint8_t r = static_cast<uint8_t>(std::min(255.0f, ((color >> 16) & 0xFF) * intensity));
-                    uint8_t g = static_cast<uint8_t>(std::min(255.0f, ((color >> 8) & 0xFF) * intensity));
-                    uint8_t b = static_cast<uint8_t>(std::min(255.0f, (color & 0xFF) * intensity));
-                    uint8_t a = static_cast<uint8_t>((color >> 24) & 0xFF);
-                    
-                    uint32_t shadedColor = (a << 24) | (r << 16) | (g << 8) | b;
-                    
-                    // Update frame buffer and z-buffer
-                    frameBuffer[index] = shadedColor;
-                    zBuffer[index] = z;
+            for (int k = 0; k < 3; ++k) {
+                Eigen::Vector3f normal = hasNormals ? normals[vertexIndices[k]].normalized() : faceNormal;
+                uint32_t index = vertexIndices[k];
+                Eigen::Vector3f tangent(frames.tangentX[index], frames.tangentY[index], frames.tangentZ[index]);
+                Eigen::Vector3f bitangent(frames.bitangentX[index], frames.bitangentY[index], frames.bitangentZ[index]);
+                
+                // Orthonormalize the frame against the corner normal (Gram-Schmidt), keeping the handedness
+                tangent -= normal * normal.dot(tangent);
+                if (tangent.norm() < 1e-6f) {
+                    tangent = normal.unitOrthogonal();
                 }
+                tangent.normalize();
+                bitangent -= normal * normal.dot(bitangent) + tangent * tangent.dot(bitangent);
+                if (bitangent.norm() < 1e-6f) {
+                    bitangent = normal.cross(tangent);
+                }
+                bitangent.normalize();
                 
-                // Increment for the next pixel
-                z += dz;
-                u += du;
-                v += dv;
-                intensity += di;
+                triangle.lightX[k] = tangent.dot(modelLight);
+                triangle.lightY[k] = bitangent.dot(modelLight);
+                triangle.lightZ[k] = normal.dot(modelLight);
             }
         }
         
-        // Update for the next scanline
-        xLeft += dxLeft;
-        xRight += dxRight;
-        zLeft += dzLeft;
-        zRight += dzRight;
-        uLeft += duLeft;
-        uRight += duRight;
-        vLeft += dvLeft;
-        vRight += dvRight;
-        iLeft += diLeft;
-        iRight += diRight;
-    }
+        submitTriangle(chunk, vertexIndices[0], vertexIndices[1], vertexIndices[2], triangle);
+    });
+    
+    rasterizeTiles(RenderMode::NORMAL_MAPPED, texture.get(), normalMap.get());
 }
 
 void Renderer::clearBuffer(uint32_t color) {
     std::fill(frameBuffer.begin(), frameBuffer.end(), color);
     std::fill(zBuffer.begin(), zBuffer.end(), std::numeric_limits<float>::infinity());
+    hiZBuffer.clear();
 }
 
 bool Renderer::saveImage(const std::string& filename) const {
@@ -884,7 +917,7 @@ bool Renderer::saveImage(const std::string& filename) const {
     return texture.saveToTGA(filename);
 }
 
-void Renderer::drawLine(int x0, int y0, int x1, int y1, uint32_t color) {
+void Renderer::drawLine(int x0, int y0, int x1, int y1, uint32_t color, const TileRect& clip) {
     // Bresenham's line algorithm
     bool steep = false;
     
@@ -904,15 +937,27 @@ void Renderer::drawLine(int x0, int y0, int x1, int y1, uint32_t color) {
     int dx = x1 - x0;
     int dy = y1 - y0;
     int derror2 = std::abs(dy) * 2;
-    int error2 = 0;
-    int y = y0;
     
-    for (int x = x0; x <= x1; x++) {
+    // A line is binned to every tile it crosses, so walk only the columns (rows
+    // if steep) of this tile, starting from the error and y that stepping from
+    // x0 would have reached there: after k steps y has moved by
+    // ceil((k * derror2 - dx) / (2 * dx)) pixels
+    int xStart = std::max(x0, steep ? clip.y0 : clip.x0);
+    int xEnd = std::min(x1, (steep ? clip.y1 : clip.x1) - 1);
+    if (xStart > xEnd) {
+        return;
+    }
+    int64_t k = xStart - x0;
+    int64_t moved = dx > 0 ? (k * derror2 + dx - 1) / (2 * int64_t(dx)) : 0;
+    int error2 = static_cast<int>(k * derror2 - moved * 2 * dx);
+    int y = y0 + static_cast<int>(y1 > y0 ? moved : -moved);
+    
+    for (int x = xStart; x <= xEnd; x++) {
         if (steep) {
             // If the line is steep, de-transpose
-            setPixel(y, x, color);
+            setPixel(y, x, color, clip);
         } else {
-            setPixel(x, y, color);
+            setPixel(x, y, color, clip);
         }
         
         error2 += derror2;
@@ -923,174 +968,9 @@ void Renderer::drawLine(int x0, int y0, int x1, int y1, uint32_t color) {
     }
 }
 
-void Renderer::drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint32_t color) {
-    // Sort vertices by y-coordinate
-    if (y0 > y1) {
-        std::swap(x0, x1);
-        std::swap(y0, y1);
-    }
-    if (y0 > y2) {
-        std::swap(x0, x2);
-        std::swap(y0, y2);
-    }
-    if (y1 > y2) {
-        std::swap(x1, x2);
-        std::swap(y1, y2);
-    }
-    
-    // Compute slopes for the three edges
-    float dx1 = (x1 - x0) / static_cast<float>(y1 - y0);
-    float dx2 = (x2 - x0) / static_cast<float>(y2 - y0);
-    float dx3 = (x2 - x1) / static_cast<float>(y2 - y1);
-    
-    // Handle special case where y1 == y0
-    if (y1 == y0) {
-        dx1 = 0;
-    }
-    
-    // Handle special case where y2 == y0
-    if (y2 == y0) {
-        dx2 = 0;
-    }
-    
-    // Handle special case where y2 == y1
-    if (y2 == y1) {
-        dx3 = 0;
-    }
-    
-    float x_left, x_right;
-    
-    // Draw the upper part of the triangle
-    if (y1 > y0) {
-        for (int y = y0; y < y1; y++) {
-            x_left = x0 + (y - y0) * dx1;
-            x_right = x0 + (y - y0) * dx2;
-            
-            if (x_left > x_right) {
-                std::swap(x_left, x_right);
-            }
-            
-            for (int x = static_cast<int>(x_left); x <= static_cast<int>(x_right); x++) {
-                setPixel(x, y, color);
-            }
-        }
-    }
-    
-    // Draw the lower part of the triangle
-    if (y2 > y1) {
-        for (int y = y1; y <= y2; y++) {
-            x_left = x1 + (y - y1) * dx3;
-            x_right = x0 + (y - y0) * dx2;
-            
-            if (x_left > x_right) {
-                std::swap(x_left, x_right);
-            }
-            
-            for (int x = static_cast<int>(x_left); x <= static_cast<int>(x_right); x++) {
-                setPixel(x, y, color);
-            }
-        }
-    }
-}
-
-void Renderer::setPixel(int x, int y, uint32_t color) {
-    // Check if the pixel is within bounds
-    if (x >= 0 && x < width && y >= 0 && y < height) {
+void Renderer::setPixel(int x, int y, uint32_t color, const TileRect& clip) {
+    // Check if the pixel is within the tile (which always lies inside the frame buffer)
+    if (x >= clip.x0 && x < clip.x1 && y >= clip.y0 && y < clip.y1) {
         frameBuffer[y * width + x] = color;
     }
 }
-
-void Renderer::drawTriangle(Vertex v0, Vertex v1, Vertex v2, uint32_t color) {
-    // Sort vertices by y-coordinate
-    if (v0.y > v1.y) { std::swap(v0, v1); }
-    if (v0.y > v2.y) { std::swap(v0, v2); }
-    if (v1.y > v2.y) { std::swap(v1, v2); }
-    
-    // Compute slopes for the three edges
-    int y0 = static_cast<int>(v0.y);
-    int y1 = static_cast<int>(v1.y);
-    int y2 = static_cast<int>(v2.y);
-    
-    float dy1 = v1.y - v0.y;
-    float dy2 = v2.y - v0.y;
-    float dy3 = v2.y - v1.y;
-    
-    // Handle special cases for vertical edges
-    float dx1 = (dy1 != 0) ? (v1.x - v0.x) / dy1 : 0;
-    float dx2 = (dy2 != 0) ? (v2.x - v0.x) / dy2 : 0;
-    float dx3 = (dy3 != 0) ? (v2.x - v1.x) / dy3 : 0;
-    
-    // Z interpolation
-    float dz1 = (dy1 != 0) ? (v1.z - v0.z) / dy1 : 0;
-    float dz2 = (dy2 != 0) ? (v2.z - v0.z) / dy2 : 0;
-    float dz3 = (dy3 != 0) ? (v2.z - v1.z) / dy3 : 0;
-    
-    // Draw the upper part of the triangle
-    if (dy1 > 0) {
-        drawScanline(
-            y0, y1,
-            v0.x, dx1, v0.x, dx2,
-            v0.z, dz1, v0.z, dz2,
-            color);
-    }
-    
-    // Draw the lower part of the triangle
-    if (dy3 > 0) {
-        drawScanline(
-            y1, y2,
-            v1.x, dx3, v0.x + dx2 * dy1, dx2,
-            v1.z, dz3, v0.z + dz2 * dy1, dz2,
-            color);
-    }
-}
-
-void Renderer::drawScanline(
-    int yStart, int yEnd,
-    float xLeft, float dxLeft, float xRight, float dxRight,
-    float zLeft, float dzLeft, float zRight, float dzRight,
-    uint32_t color) {
-    
-    for (int y = yStart; y < yEnd; y++) {
-        float xL = xLeft;
-        float xR = xRight;
-        float zL = zLeft;
-        float zR = zRight;
-        
-        // Swap if needed to ensure left to right
-        if (xL > xR) {
-            std::swap(xL, xR);
-            std::swap(zL, zR);
-        }
-        
-        // Get starting and ending x-coordinates
-        int xStart = static_cast<int>(std::ceil(xL));
-        int xEnd = static_cast<int>(std::ceil(xR));
-        
-        // Calculate interpolation steps along the scanline
-        float dx = xR - xL;
-        float dz = (dx != 0) ? (zR - zL) / dx : 0;
-        
-        // Adjust for the first pixel
-        float xOffset = xStart - xL;
-        float z = zL + dz * xOffset;
-        
-        // Draw the scanline
-        for (int x = xStart; x < xEnd; x++) {
-            // Check if this pixel is in front (using z-buffer)
-            int index = y * width + x;
-            if (x >= 0 && x < width && y >= 0 && y < height && z < zBuffer[index]) {
-                frameBuffer[index] = color;
-                zBuffer[index] = z;
-            }
-            
-            // Increment for the next pixel
-            z += dz;
-        }
-        
-        // Update for the next scanline
-        xLeft += dxLeft;
-        xRight += dxRight;
-        zLeft += dzLeft;
-        zRight += dzRight;
-    }
-} 
\ No newline at end of file
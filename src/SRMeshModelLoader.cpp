@@ -0,0 +1,431 @@
+#include "SRMeshModelLoader.h"
+#include "MappedFile.h"
+#include <spdlog/spdlog.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char MAGIC[8] = {'S', 'R', 'M', 'E', 'S', 'H', '\0', '\0'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;    // Reads back differently on a machine of the other byte order
+constexpr uint64_t SECTION_ALIGNMENT = 64;          // Sections start on cache lines
+
+/**
+ * @brief Sections of a .srmesh file, in file order
+ */
+enum Section : uint32_t {
+    POSITIONS,
+    TEXTURE_COORDS,
+    NORMALS,
+    POSITION_IDS,
+    TRIANGLES,
+    TRIANGLE_FLAGS,
+    MESHLETS,
+    MESHLET_TRIANGLES,
+    MESHLET_VERTICES,
+    TANGENT_FRAMES,
+    SECTION_COUNT
+};
+
+struct SectionEntry {
+    uint64_t offset;    // From the start of the file, a multiple of SECTION_ALIGNMENT
+    uint64_t bytes;
+};
+
+/**
+ * @brief Identifies the contents of the source file a cache was made from
+ */
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t modified = 0;   // std::filesystem::file_time_type ticks
+    uint64_t hash = 0;      // hashBytes of the whole file
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    SourceStamp source;
+    SectionEntry sections[SECTION_COUNT];
+};
+
+/**
+ * @brief Model::Meshlet with plain arrays in place of the Eigen vectors
+ */
+struct MeshletRecord {
+    uint32_t firstTriangle;
+    uint32_t triangleCount;
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    float center[3];
+    float radius;
+    float coneAxis[3];
+    float coneCos;
+    float coneSin;
+};
+
+static_assert(sizeof(Eigen::Vector3f) == 3 * sizeof(float) && sizeof(Eigen::Vector2f) == 2 * sizeof(float),
+              "Eigen vectors must be stored as plain floats");
+static_assert(sizeof(Model::Triangle) == 3 * sizeof(uint32_t), "Triangles must be stored as plain indices");
+static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<MeshletRecord> &&
+              std::is_trivially_copyable_v<Model::Triangle>);
+
+/**
+ * @brief FNV-1a over 64-bit words, folding the high half back in after every step so that all bits of a word count
+ */
+uint64_t hashBytes(const char* data, size_t size) {
+    constexpr uint64_t PRIME = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * PRIME;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Reads the size and modification time of a file
+ */
+bool readStamp(const std::string& filename, SourceStamp& stamp) {
+    std::error_code error;
+    stamp.size = fs::file_size(filename, error);
+    if (error) {
+        return false;
+    }
+    stamp.modified = fs::last_write_time(filename, error).time_since_epoch().count();
+    return !error;
+}
+
+bool hashFile(const std::string& filename, uint64_t& hash) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+    hash = hashBytes(file.data(), file.size());
+    return true;
+}
+
+/**
+ * @brief Copies the header out of a mapped file and checks that it describes a readable .srmesh file
+ */
+bool readHeader(const MappedFile& file, const std::string& filename, FileHeader& header) {
+    if (file.size() < sizeof(FileHeader)) {
+        spdlog::warn("{} is too short to be a mesh file", filename);
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(FileHeader));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        spdlog::warn("{} is not a mesh file", filename);
+        return false;
+    }
+    if (header.byteOrder != BYTE_ORDER_MARK) {
+        spdlog::warn("{} was written on a machine of another byte order", filename);
+        return false;
+    }
+    if (header.version != SRMeshModelLoader::FORMAT_VERSION) {
+        spdlog::info("{} has format version {}, expected {}", filename, header.version, SRMeshModelLoader::FORMAT_VERSION);
+        return false;
+    }
+    for (const SectionEntry& section : header.sections) {
+        if (section.offset % SECTION_ALIGNMENT != 0 || section.offset > file.size() ||
+            section.bytes > file.size() - section.offset) {
+            spdlog::warn("{} has a section outside the file", filename);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Gets a section as an array of T
+ * @return False if its size is not a whole number of elements
+ */
+template<typename T>
+bool getSection(const MappedFile& file, const FileHeader& header, Section section, const T*& data, size_t& count) {
+    const SectionEntry& entry = header.sections[section];
+    if (entry.bytes % sizeof(T) != 0) {
+        return false;
+    }
+    data = reinterpret_cast<const T*>(file.data() + entry.offset);  // Aligned, since mappings start on a page
+    count = static_cast<size_t>(entry.bytes / sizeof(T));
+    return true;
+}
+
+/**
+ * @brief Builds a model from the sections of a mapped .srmesh file whose header passed readHeader
+ * @return The model, or nullptr if the sections are inconsistent
+ */
+std::shared_ptr<Model> readModel(const MappedFile& file, const FileHeader& header, const std::string& filename) {
+    const Eigen::Vector3f* positions = nullptr;
+    const Eigen::Vector2f* textureCoords = nullptr;
+    const Eigen::Vector3f* normals = nullptr;
+    const uint32_t* positionIds = nullptr;
+    const Model::Triangle* triangles = nullptr;
+    const uint8_t* triangleFlags = nullptr;
+    const MeshletRecord* meshlets = nullptr;
+    const uint32_t* meshletTriangles = nullptr;
+    const uint32_t* meshletVertices = nullptr;
+    const float* tangentFrames = nullptr;
+    size_t vertexCount = 0, textureCoordCount = 0, normalCount = 0, positionIdCount = 0, triangleCount = 0, flagCount = 0;
+    size_t meshletCount = 0, meshletTriangleCount = 0, meshletVertexCount = 0, tangentFrameCount = 0;
+
+    bool valid = getSection(file, header, POSITIONS, positions, vertexCount) &&
+                 getSection(file, header, TEXTURE_COORDS, textureCoords, textureCoordCount) &&
+                 getSection(file, header, NORMALS, normals, normalCount) &&
+                 getSection(file, header, POSITION_IDS, positionIds, positionIdCount) &&
+                 getSection(file, header, TRIANGLES, triangles, triangleCount) &&
+                 getSection(file, header, TRIANGLE_FLAGS, triangleFlags, flagCount) &&
+                 getSection(file, header, MESHLETS, meshlets, meshletCount) &&
+                 getSection(file, header, MESHLET_TRIANGLES, meshletTriangles, meshletTriangleCount) &&
+                 getSection(file, header, MESHLET_VERTICES, meshletVertices, meshletVertexCount) &&
+                 getSection(file, header, TANGENT_FRAMES, tangentFrames, tangentFrameCount) &&
+                 (textureCoordCount == 0 || textureCoordCount == vertexCount) &&
+                 (normalCount == 0 || normalCount == vertexCount) &&
+                 positionIdCount == vertexCount &&
+                 flagCount == triangleCount &&
+                 tangentFrameCount == 6 * textureCoordCount;
+
+    // Renderers index without bounds checks, so the triangles must be as valid as freshly welded ones
+    for (size_t i = 0; i < triangleCount && valid; ++i) {
+        const uint32_t* indices = triangles[i].vertexIndices;
+        valid = indices[0] < vertexCount && indices[1] < vertexCount && indices[2] < vertexCount &&
+                (!(triangleFlags[i] & Model::HAS_TEXTURE_COORDS) || textureCoordCount > 0) &&
+                (!(triangleFlags[i] & Model::HAS_NORMALS) || normalCount > 0);
+    }
+    for (size_t i = 0; i < positionIdCount && valid; ++i) {
+        valid = positionIds[i] < vertexCount;
+    }
+
+    // Meshlets index the triangles and vertices directly, so they must stay in range
+    for (size_t i = 0; i < meshletCount && valid; ++i) {
+        valid = uint64_t(meshlets[i].firstTriangle) + meshlets[i].triangleCount <= meshletTriangleCount &&
+                uint64_t(meshlets[i].firstVertex) + meshlets[i].vertexCount <= meshletVertexCount;
+    }
+    for (size_t i = 0; i < meshletTriangleCount && valid; ++i) {
+        valid = meshletTriangles[i] < triangleCount;
+    }
+    for (size_t i = 0; i < meshletVertexCount && valid; ++i) {
+        valid = meshletVertices[i] < vertexCount;
+    }
+    if (!valid) {
+        spdlog::warn("{} has inconsistent sections", filename);
+        return nullptr;
+    }
+
+    // One bulk copy per section: the model owns its arrays and outlives the mapping
+    auto model = std::make_shared<Model>();
+    model->setVertices(std::vector<Eigen::Vector3f>(positions, positions + vertexCount));
+    model->setTextureCoords(std::vector<Eigen::Vector2f>(textureCoords, textureCoords + textureCoordCount));
+    model->setNormals(std::vector<Eigen::Vector3f>(normals, normals + normalCount));
+
+    model->setTriangles(std::vector<Model::Triangle>(triangles, triangles + triangleCount),
+                        std::vector<uint8_t>(triangleFlags, triangleFlags + flagCount),
+                        std::vector<uint32_t>(positionIds, positionIds + positionIdCount));
+
+    std::vector<Model::Meshlet> restoredMeshlets(meshletCount);
+    for (size_t i = 0; i < meshletCount; ++i) {
+        const MeshletRecord& record = meshlets[i];
+        restoredMeshlets[i] = {
+            record.firstTriangle, record.triangleCount, record.firstVertex, record.vertexCount,
+            Eigen::Vector3f(record.center[0], record.center[1], record.center[2]), record.radius,
+            Eigen::Vector3f(record.coneAxis[0], record.coneAxis[1], record.coneAxis[2]), record.coneCos, record.coneSin
+        };
+    }
+    model->setMeshlets(std::move(restoredMeshlets),
+                       std::vector<uint32_t>(meshletTriangles, meshletTriangles + meshletTriangleCount),
+                       std::vector<uint32_t>(meshletVertices, meshletVertices + meshletVertexCount));
+
+    Model::TangentFrames frames;
+    std::vector<float>* arrays[6] = {
+        &frames.tangentX, &frames.tangentY, &frames.tangentZ,
+        &frames.bitangentX, &frames.bitangentY, &frames.bitangentZ
+    };
+    for (int i = 0; i < 6; ++i) {
+        arrays[i]->assign(tangentFrames + i * textureCoordCount, tangentFrames + (i + 1) * textureCoordCount);
+    }
+    model->setTangentFrames(std::move(frames));
+
+    spdlog::info("Model loaded from {}. Vertices: {}, Texture coords: {}, Normals: {}, Triangles: {}",
+        filename, vertexCount, textureCoordCount, normalCount, triangleCount);
+    return model;
+}
+
+/**
+ * @brief Name for writing a mesh file next to its final name, unique to this call
+ *
+ * Processes loading the same model write its cache at the same time; each
+ * writes its own file and renames it into place, so the last rename wins
+ * with a complete file.
+ */
+std::string temporaryName(const std::string& filename) {
+    static std::mt19937_64 generator{ std::random_device{}() };
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), ".%016llx.tmp", static_cast<unsigned long long>(generator()));
+    return filename + suffix;
+}
+
+} // namespace
+
+std::shared_ptr<Model> SRMeshModelLoader::loadModel(const std::string& filename) {
+    spdlog::info("Loading model from mesh file: {}", filename);
+
+    MappedFile file;
+    if (!file.open(filename)) {
+        throw std::runtime_error("Failed to open mesh file: " + filename);
+    }
+    FileHeader header;
+    std::shared_ptr<Model> model;
+    if (readHeader(file, filename, header)) {
+        model = readModel(file, header, filename);
+    }
+    if (!model) {
+        throw std::runtime_error("Invalid mesh file: " + filename);
+    }
+    return model;
+}
+
+std::shared_ptr<Model> SRMeshModelLoader::loadCache(const std::string& cacheFile, const std::string& sourceFile) {
+    std::error_code error;
+    SourceStamp current;
+    if (!fs::exists(cacheFile, error) || !readStamp(sourceFile, current)) {
+        return nullptr;
+    }
+
+    std::shared_ptr<Model> model;
+    bool retouched = false;
+    {
+        MappedFile file;
+        FileHeader header;
+        if (!file.open(cacheFile) || !readHeader(file, cacheFile, header)) {
+            return nullptr;
+        }
+        if (header.source.size != current.size) {
+            spdlog::info("Mesh cache {} is out of date", cacheFile);
+            return nullptr;
+        }
+        if (header.source.modified != current.modified) {
+            // Touched but perhaps unchanged, as after a checkout: the contents decide
+            if (!hashFile(sourceFile, current.hash) || current.hash != header.source.hash) {
+                spdlog::info("Mesh cache {} is out of date", cacheFile);
+                return nullptr;
+            }
+            retouched = true;
+        }
+        model = readModel(file, header, cacheFile);
+    }
+
+    if (model && retouched) {
+        // Record the new time, now that the mapping is gone, so that the next load skips the hash
+        std::fstream file(cacheFile, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offsetof(FileHeader, source) + offsetof(SourceStamp, modified));
+        file.write(reinterpret_cast<const char*>(&current.modified), sizeof(current.modified));
+        if (!file) {
+            spdlog::warn("Could not update the source time in mesh cache {}", cacheFile);
+        }
+    }
+    return model;
+}
+
+bool SRMeshModelLoader::saveModel(const Model& model, const std::string& filename, const std::string& sourceFile) {
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    if (!sourceFile.empty() && (!readStamp(sourceFile, header.source) || !hashFile(sourceFile, header.source.hash))) {
+        spdlog::warn("Could not read {} to stamp mesh file {}", sourceFile, filename);
+        return false;
+    }
+
+    std::vector<MeshletRecord> meshlets;
+    meshlets.reserve(model.getMeshlets().size());
+    for (const Model::Meshlet& meshlet : model.getMeshlets()) {
+        meshlets.push_back({
+            meshlet.firstTriangle, meshlet.triangleCount, meshlet.firstVertex, meshlet.vertexCount,
+            { meshlet.center.x(), meshlet.center.y(), meshlet.center.z() }, meshlet.radius,
+            { meshlet.coneAxis.x(), meshlet.coneAxis.y(), meshlet.coneAxis.z() }, meshlet.coneCos, meshlet.coneSin
+        });
+    }
+
+    const Model::TangentFrames& frames = model.getTangentFrames();
+    std::vector<float> tangentFrames;
+    tangentFrames.reserve(6 * model.getTextureCoords().size());
+    for (const std::vector<float>* array : { &frames.tangentX, &frames.tangentY, &frames.tangentZ,
+                                             &frames.bitangentX, &frames.bitangentY, &frames.bitangentZ }) {
+        tangentFrames.insert(tangentFrames.end(), array->begin(), array->end());
+    }
+
+    struct Payload {
+        const void* data;
+        size_t bytes;
+    };
+    const Payload payloads[SECTION_COUNT] = {
+        { model.getVertices().data(), model.getVertices().size() * sizeof(Eigen::Vector3f) },
+        { model.getTextureCoords().data(), model.getTextureCoords().size() * sizeof(Eigen::Vector2f) },
+        { model.getNormals().data(), model.getNormals().size() * sizeof(Eigen::Vector3f) },
+        { model.getPositionIds().data(), model.getPositionIds().size() * sizeof(uint32_t) },
+        { model.getTriangles().data(), model.getTriangles().size() * sizeof(Model::Triangle) },
+        { model.getTriangleFlags().data(), model.getTriangleFlags().size() * sizeof(uint8_t) },
+        { meshlets.data(), meshlets.size() * sizeof(MeshletRecord) },
+        { model.getMeshletTriangles().data(), model.getMeshletTriangles().size() * sizeof(uint32_t) },
+        { model.getMeshletVertices().data(), model.getMeshletVertices().size() * sizeof(uint32_t) },
+        { tangentFrames.data(), tangentFrames.size() * sizeof(float) }
+    };
+
+    auto align = [](uint64_t offset) { return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT; };
+    uint64_t offset = align(sizeof(FileHeader));
+    for (uint32_t section = 0; section < SECTION_COUNT; ++section) {
+        header.sections[section] = { offset, payloads[section].bytes };
+        offset = align(offset + payloads[section].bytes);
+    }
+
+    const std::string temporary = temporaryName(filename);
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            spdlog::warn("Could not write mesh file {}", filename);
+            return false;
+        }
+        static const char padding[SECTION_ALIGNMENT] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        uint64_t written = sizeof(header);
+        for (uint32_t section = 0; section < SECTION_COUNT; ++section) {
+            file.write(padding, static_cast<std::streamsize>(header.sections[section].offset - written));
+            file.write(static_cast<const char*>(payloads[section].data), static_cast<std::streamsize>(payloads[section].bytes));
+            written = header.sections[section].offset + payloads[section].bytes;
+        }
+        if (!file) {
+            spdlog::warn("Could not write mesh file {}", filename);
+            file.close();
+            fs::remove(temporary);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporary, filename, error);
+    if (error) {
+        spdlog::warn("Could not write mesh file {}: {}", filename, error.message());
+        fs::remove(temporary, error);
+        return false;
+    }
+    spdlog::info("Wrote mesh file {} ({} KiB)", filename, offset / 1024);
+    return true;
+}
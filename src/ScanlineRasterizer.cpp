@@ -0,0 +1,5 @@
+#include "ScanlineRasterizer.h"
+
+ScanlineRasterizer::ScanlineRasterizer(std::vector<uint32_t>& frameBuffer, std::vector<float>& zBuffer, int width)
+    : frameBuffer(frameBuffer), zBuffer(zBuffer), width(width) {
+}
@@ -0,0 +1,69 @@
+#include "Shaders.h"
+
+namespace {
+
+constexpr float OCCLUSION_STRENGTH = 2.0f;  // Occlusion per unit of relative neighbour height
+
+} // namespace
+
+std::vector<float> computeVertexOcclusion(const Model& model) {
+    const auto& vertices = model.getVertices();
+    const auto& triangles = model.getTriangles();
+    const auto& triangleFlags = model.getTriangleFlags();
+    const auto& positionIds = model.getPositionIds();
+
+    // Vertices welded from the same position (split at seams) share one position id, so they get the same occlusion
+    const bool welded = positionIds.size() == vertices.size();
+    auto positionOf = [&](uint32_t vertex) { return welded ? positionIds[vertex] : vertex; };
+
+    std::vector<Eigen::Vector3f> normals(vertices.size(), Eigen::Vector3f::Zero());
+    std::vector<Eigen::Vector3f> neighbourSums(vertices.size(), Eigen::Vector3f::Zero());
+    std::vector<float> distanceSums(vertices.size(), 0.0f);
+    std::vector<int> neighbourCounts(vertices.size(), 0);
+    std::vector<uint32_t> positionVertex(vertices.size(), 0);
+
+    // Accumulate area-weighted normals and the neighbours along the polygon edges (not the triangulation diagonals)
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        const auto& indices = triangles[t].vertexIndices;
+
+        const Eigen::Vector3f& v0 = vertices[indices[0]];
+        Eigen::Vector3f faceNormal = (vertices[indices[1]] - v0).cross(vertices[indices[2]] - v0);
+
+        for (int k = 0; k < 3; ++k) {
+            uint32_t current = positionOf(indices[k]);
+            positionVertex[current] = indices[k];
+            normals[current] += faceNormal;
+            const int next = (k + 1) % 3;
+            const int previous = (k + 2) % 3;
+            for (int edge : { k, previous }) {
+                if (!(triangleFlags[t] & (1 << edge))) {
+                    continue;
+                }
+                uint32_t neighbour = indices[edge == k ? next : previous];
+                neighbourSums[current] += vertices[neighbour];
+                distanceSums[current] += (vertices[neighbour] - vertices[indices[k]]).norm();
+                ++neighbourCounts[current];
+            }
+        }
+    }
+
+    // Neighbours rising above the tangent plane mean the vertex lies in a crevice
+    std::vector<float> positionOcclusion(vertices.size(), 0.0f);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        if (neighbourCounts[i] == 0 || distanceSums[i] <= 0.0f || normals[i].isZero()) {
+            continue;
+        }
+
+        Eigen::Vector3f centroid = neighbourSums[i] / static_cast<float>(neighbourCounts[i]);
+        float meanDistance = distanceSums[i] / static_cast<float>(neighbourCounts[i]);
+        float height = normals[i].normalized().dot(centroid - vertices[positionVertex[i]]);
+        positionOcclusion[i] = std::clamp(height / meanDistance * OCCLUSION_STRENGTH, 0.0f, 1.0f);
+    }
+
+    std::vector<float> occlusion(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        occlusion[v] = positionOcclusion[positionOf(static_cast<uint32_t>(v))];
+    }
+
+    return occlusion;
+}
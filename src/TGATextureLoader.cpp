@@ -6,6 +6,17 @@
 std::shared_ptr<Texture> TGATextureLoader::loadTexture(const std::string& filename) {
     try {
         auto texture = std::make_shared<Texture>(filename);
+        
+        // Store power-of-two textures in Morton order, so fetches along any direction in UV space stay cache local
+        if (texture->supportsMortonLayout()) {
+            texture->setLayout(TextureLayout::MORTON);
+            spdlog::info("Texture stored in Morton order");
+        }
+        
+        // Mip levels let minified draws fetch from a level that fits their footprint
+        texture->generateMipmaps();
+        spdlog::info("Generated {} mip levels", texture->getLevelCount() - 1);
+        spdlog::info("Texture memory: {} KiB including mip levels", texture->getMemoryUsage() / 1024);
         return texture;
     } catch (const std::exception& e) {
         spdlog::error("Failed to load TGA texture: {}", e.what());
@@ -47,7 +47,7 @@ bool Texture::loadRLEData(std::ifstream& in,
                             ? (y * width + x)
                             : ((height - 1 - y) * width + x);
 
-                data[idx] = pixelColor;
+                setTexel(idx, pixelColor);
                 currentPixel++;
             }
         } else {
@@ -70,7 +70,7 @@ bool Texture::loadRLEData(std::ifstream& in,
                             ? (y * width + x)
                             : ((height - 1 - y) * width + x);
 
-                data[idx] = pixelColor;
+                setTexel(idx, pixelColor);
                 currentPixel++;
             }
         }
@@ -148,8 +148,12 @@ bool Texture::loadFromTGA(const std::string& filename) {
 
     width  = header.width;
     height = header.height;
-    data.clear();
-    data.resize(size_t(width)*height);
+    format = header.imageType == 3 ? TextureFormat::R8 : TextureFormat::RGBA8;  // Grayscale needs one byte per texel
+    layout = TextureLayout::LINEAR;
+    mortonColumns.clear();
+    mortonRows.clear();
+    mipLevels.clear();
+    allocate(size_t(width)*height);
 
     // dispatch RLE vs uncompressed
     if (header.imageType == 10) {
@@ -180,11 +184,11 @@ bool Texture::loadFromTGA(const std::string& filename) {
                              ? y
                              : (height-1 - y);
                 size_t idx = row*width + x;
-                data[idx] =
+                setTexel(idx,
                   (uint32_t(buf[3])<<24) |
                   (uint32_t(buf[2])<<16) |
                   (uint32_t(buf[1])<< 8) |
-                   uint32_t(buf[0]);
+                   uint32_t(buf[0]));
             }
         }
     }
@@ -219,7 +223,7 @@ bool Texture::saveToTGA(const std::string& filename) const {
     // Write pixel data - TGA expects BGRA format
     for (int y = height - 1; y >= 0; y--) {
         for (int x = 0; x < width; x++) {
-            uint32_t pixel = data[y * width + x];
+            uint32_t pixel = getTexel(x, y);
             uint8_t bgra[4];
             // Our framebuffer is in ARGB format (0xAARRGGBB)
             bgra[0] = pixel & 0xFF;             // B (from B in our format)
@@ -254,5 +258,166 @@ uint32_t Texture::getColorAt(float u, float v) const {
     x = std::clamp(x, 0, width - 1);
     y = std::clamp(y, 0, height - 1);
     
-    return data[y * width + x];
-} 
\ No newline at end of file
+    return getTexel(x, y);
+}
+
+bool Texture::supportsMortonLayout() const {
+    auto isPowerOfTwo = [](int n) { return n > 0 && (n & (n - 1)) == 0; };
+    return isPowerOfTwo(width) && isPowerOfTwo(height);
+}
+
+bool Texture::setLayout(TextureLayout newLayout) {
+    if (newLayout == layout) {
+        return true;
+    }
+    if (newLayout == TextureLayout::MORTON && !supportsMortonLayout()) {
+        spdlog::warn("Morton layout needs power-of-two sides, texture is {}x{}", width, height);
+        return false;
+    }
+    if (isBlockCompressed(format)) {
+        spdlog::warn("Block-compressed textures keep their blocks in rows");
+        return false;
+    }
+    
+    // The x and y bits of a Morton index do not overlap, so each axis gets a lookup table
+    std::vector<uint32_t> newColumns, newRows;
+    if (newLayout == TextureLayout::MORTON) {
+        int bits = 0;
+        while ((2 << bits) <= std::min(width, height)) {
+            ++bits;
+        }
+        newColumns.resize(width);
+        newRows.resize(height);
+        for (int x = 0; x < width; ++x) {
+            newColumns[x] = mortonIndex(static_cast<uint32_t>(x), 0, bits);
+        }
+        for (int y = 0; y < height; ++y) {
+            newRows[y] = mortonIndex(0, static_cast<uint32_t>(y), bits);
+        }
+    }
+    
+    // Move every texel from its current position to the new one
+    const size_t texelSize = getTexelSize(format);
+    std::vector<uint8_t> reordered(data.size());
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t target = (newLayout == TextureLayout::LINEAR)
+                          ? static_cast<size_t>(y) * width + x
+                          : newColumns[x] | newRows[y];
+            std::memcpy(&reordered[target * texelSize], &data[getTexelIndex(x, y) * texelSize], texelSize);
+        }
+    }
+    
+    data = std::move(reordered);
+    layout = newLayout;
+    mortonColumns = std::move(newColumns);
+    mortonRows = std::move(newRows);
+    
+    // Halving a power of two keeps a power of two, so every mip level supports the layout too
+    for (auto& level : mipLevels) {
+        level.setLayout(newLayout);
+    }
+    return true;
+}
+
+void Texture::generateMipmaps() {
+    mipLevels.clear();
+    
+    const Texture* previous = this;
+    while (previous->width > 1 || previous->height > 1) {
+        int levelWidth = std::max(1, previous->width / 2);
+        int levelHeight = std::max(1, previous->height / 2);
+        
+        Texture level;
+        level.width = levelWidth;
+        level.height = levelHeight;
+        level.format = isBlockCompressed(format) ? TextureFormat::RGBA8 : format;
+        level.allocate(static_cast<size_t>(levelWidth) * levelHeight);
+        
+        // Box filter: each texel averages a 2x2 block of the previous level, clamped at odd or unit sides
+        for (int y = 0; y < levelHeight; ++y) {
+            int y0 = std::min(2 * y, previous->height - 1);
+            int y1 = std::min(2 * y + 1, previous->height - 1);
+            for (int x = 0; x < levelWidth; ++x) {
+                int x0 = std::min(2 * x, previous->width - 1);
+                int x1 = std::min(2 * x + 1, previous->width - 1);
+                uint32_t block[4] = { previous->getTexel(x0, y0), previous->getTexel(x1, y0),
+                                      previous->getTexel(x0, y1), previous->getTexel(x1, y1) };
+                uint32_t texel = 0;
+                for (int shift = 0; shift < 32; shift += 8) {
+                    uint32_t sum = 2;   // Rounds the average to nearest
+                    for (uint32_t value : block) {
+                        sum += (value >> shift) & 0xFF;
+                    }
+                    texel |= (sum / 4) << shift;
+                }
+                level.setTexel(static_cast<size_t>(y) * levelWidth + x, texel);
+            }
+        }
+        
+        level.setLayout(layout);
+        level.setFormat(format);
+        mipLevels.push_back(std::move(level));
+        previous = &mipLevels.back();
+    }
+}
+
+void Texture::setFormat(TextureFormat newFormat) {
+    if (newFormat == format) {
+        return;
+    }
+    
+    std::vector<uint32_t> colors(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            colors[static_cast<size_t>(y) * width + x] = getTexel(x, y);
+        }
+    }
+    
+    if (isBlockCompressed(newFormat)) {
+        layout = TextureLayout::LINEAR;
+        mortonColumns.clear();
+        mortonRows.clear();
+    }
+    format = newFormat;
+    allocate(colors.size());
+    
+    if (!isBlockCompressed(format)) {
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                setTexel(getTexelIndex(x, y), colors[static_cast<size_t>(y) * width + x]);
+            }
+        }
+    } else {
+        // Tiles hanging over the right or bottom border repeat the last column or row
+        const int blocksPerRow = (width + 3) / 4;
+        uint32_t tile[16];
+        for (int blockY = 0; blockY < (height + 3) / 4; ++blockY) {
+            for (int blockX = 0; blockX < blocksPerRow; ++blockX) {
+                for (int i = 0; i < 16; ++i) {
+                    int x = std::min(blockX * 4 + (i & 3), width - 1);
+                    int y = std::min(blockY * 4 + (i >> 2), height - 1);
+                    tile[i] = colors[static_cast<size_t>(y) * width + x];
+                }
+                uint8_t* block = &data[(static_cast<size_t>(blockY) * blocksPerRow + blockX) * getTexelSize(format)];
+                if (format == TextureFormat::BC1) {
+                    compressBC1Block(tile, block);
+                } else {
+                    compressBC3Block(tile, block);
+                }
+            }
+        }
+    }
+    
+    for (auto& level : mipLevels) {
+        level.setFormat(newFormat);
+    }
+}
+
+size_t Texture::getMemoryUsage() const {
+    size_t bytes = data.size();
+    for (const auto& level : mipLevels) {
+        bytes += level.getMemoryUsage();
+    }
+    return bytes;
+}
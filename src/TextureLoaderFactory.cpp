@@ -1,7 +1,14 @@
 #include "TextureLoaderFactory.h"
 #include <spdlog/spdlog.h>
 
+namespace fs = std::filesystem;
+
 std::unordered_map<std::string, std::shared_ptr<ITextureLoader>> TextureLoaderFactory::loaders;
+std::list<TextureLoaderFactory::CacheEntry> TextureLoaderFactory::cache;
+std::unordered_map<std::string, std::list<TextureLoaderFactory::CacheEntry>::iterator> TextureLoaderFactory::cacheIndex;
+size_t TextureLoaderFactory::cacheBudget = TextureLoaderFactory::DEFAULT_CACHE_BUDGET;
+size_t TextureLoaderFactory::cacheUsage = 0;
+std::mutex TextureLoaderFactory::cacheMutex;
 
 std::shared_ptr<ITextureLoader> TextureLoaderFactory::createLoader(const std::string& fileExtension) {
     auto it = loaders.find(fileExtension);
@@ -16,4 +23,101 @@ std::shared_ptr<ITextureLoader> TextureLoaderFactory::createLoader(const std::st
 void TextureLoaderFactory::registerLoader(const std::string& extension, std::shared_ptr<ITextureLoader> loader) {
     loaders[extension] = loader;
     spdlog::info("Registered texture loader for extension: {}", extension);
-} 
\ No newline at end of file
+}
+
+std::shared_ptr<const Texture> TextureLoaderFactory::loadTexture(const std::string& filename) {
+    std::error_code error;
+    fs::path path = fs::canonical(filename, error);
+    fs::file_time_type modified = error ? fs::file_time_type() : fs::last_write_time(path, error);
+    if (error) {
+        spdlog::error("Cannot open texture {}: {}", filename, error.message());
+        return nullptr;
+    }
+    const std::string key = path.string();
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cacheIndex.find(key);
+        if (it != cacheIndex.end()) {
+            if (it->second->modified == modified) {
+                cache.splice(cache.begin(), cache, it->second);
+                spdlog::info("Texture {} found in cache", key);
+                return it->second->texture;
+            }
+            spdlog::info("Texture {} changed on disk, decoding it again", key);
+            cacheUsage -= it->second->bytes;
+            cache.erase(it->second);
+            cacheIndex.erase(it);
+        }
+    }
+
+    std::string extension = path.extension().string();
+    auto loader = createLoader(extension.empty() ? extension : extension.substr(1)); // Remove the dot
+    if (!loader) {
+        return nullptr;
+    }
+
+    // Decode outside the lock, so that loads of different files run in parallel
+    std::shared_ptr<const Texture> texture = loader->loadTexture(path.string());
+    if (!texture) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cacheIndex.find(key);
+    if (it != cacheIndex.end() && it->second->modified == modified) {
+        // Another thread decoded the same file meanwhile, share its texture
+        cache.splice(cache.begin(), cache, it->second);
+        return it->second->texture;
+    }
+    if (it != cacheIndex.end()) {
+        cacheUsage -= it->second->bytes;
+        cache.erase(it->second);
+        cacheIndex.erase(it);
+    }
+
+    size_t bytes = texture->getMemoryUsage();
+    if (bytes > cacheBudget) {
+        spdlog::info("Texture {} ({} KiB) exceeds the cache budget of {} KiB, not cached", key, bytes / 1024, cacheBudget / 1024);
+        return texture;
+    }
+    cache.push_front({ key, modified, texture, bytes });
+    cacheIndex[key] = cache.begin();
+    cacheUsage += bytes;
+    evict();
+    return texture;
+}
+
+void TextureLoaderFactory::setCacheBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheBudget = bytes;
+    evict();
+    spdlog::info("Texture cache budget set to {} KiB", bytes / 1024);
+}
+
+size_t TextureLoaderFactory::getCacheBudget() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cacheBudget;
+}
+
+size_t TextureLoaderFactory::getCacheUsage() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cacheUsage;
+}
+
+void TextureLoaderFactory::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.clear();
+    cacheIndex.clear();
+    cacheUsage = 0;
+}
+
+void TextureLoaderFactory::evict() {
+    while (cacheUsage > cacheBudget && !cache.empty()) {
+        const CacheEntry& entry = cache.back();
+        spdlog::info("Evicting texture {} ({} KiB) from the cache", entry.path, entry.bytes / 1024);
+        cacheUsage -= entry.bytes;
+        cacheIndex.erase(entry.path);
+        cache.pop_back();
+    }
+}
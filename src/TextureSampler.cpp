@@ -0,0 +1,103 @@
+#include "TextureSampler.h"
+#include <bit>
+
+namespace {
+
+const uint32_t BLACK_TEXEL = 0xFF000000;   // What empty textures sample as
+
+} // namespace
+
+TextureSampler::TextureSampler(const Texture* texture)
+    : texture(texture),
+      filter(texture ? texture->getFilter() : TextureFilter::NEAREST),
+      wrap(texture ? texture->getWrap() : TextureWrap::REPEAT),
+      levels{},
+      levelCount(1) {
+    if (!texture || texture->getData().empty() || texture->getWidth() <= 0 || texture->getHeight() <= 0) {
+        levels[0] = { reinterpret_cast<const uint8_t*>(&BLACK_TEXEL), TextureFormat::RGBA8, nullptr, nullptr,
+                      1, 1, 256.0f, 256.0f, true };
+        return;
+    }
+
+    auto isPowerOfTwo = [](int n) { return (n & (n - 1)) == 0; };
+    levelCount = std::min(texture->getLevelCount(), MAX_LEVELS);
+    for (int i = 0; i < levelCount; ++i) {
+        const Texture& level = texture->getLevel(i);
+        bool morton = level.getLayout() == TextureLayout::MORTON;
+        levels[i] = {
+            level.getData().data(), level.getFormat(),
+            morton ? level.getMortonColumns().data() : nullptr,
+            morton ? level.getMortonRows().data() : nullptr,
+            level.getWidth(), level.getHeight(),
+            static_cast<float>(level.getWidth()) * 256.0f, static_cast<float>(level.getHeight()) * 256.0f,
+            isPowerOfTwo(level.getWidth()) && isPowerOfTwo(level.getHeight())
+        };
+    }
+}
+
+uint32_t TextureSampler::sample(float u, float v, float lod) const {
+    if (!usesMipmaps()) {
+        return sample(u, v);
+    }
+    bool bilinear = filter == TextureFilter::TRILINEAR;
+    if (levelCount == 1 || !(lod > 0.0f)) {
+        return bilinear ? sampleBilinear(levels[0], u, v) : sampleNearest(levels[0], u, v);
+    }
+    
+    lod = std::min(lod, static_cast<float>(levelCount - 1));
+    if (!bilinear) {
+        return sampleNearest(levels[static_cast<int>(lod + 0.5f)], u, v);
+    }
+    
+    // Trilinear: blend the bilinear samples of the levels below and above the level of detail
+    int level = static_cast<int>(lod);
+    uint32_t weight = static_cast<uint32_t>((lod - static_cast<float>(level)) * 256.0f);
+    uint32_t lower = sampleBilinear(levels[level], u, v);
+    if (level + 1 >= levelCount) {
+        return lower;
+    }
+    return lerpTexels(lower, sampleBilinear(levels[level + 1], u, v), weight);
+}
+
+#ifdef __AVX2__
+__m256i TextureSampler::sample(__m256 u, __m256 v, __m256 lod, __m256i mask) const {
+    if (!usesMipmaps()) {
+        return sample(u, v, mask);
+    }
+    bool bilinear = filter == TextureFilter::TRILINEAR;
+    if (levelCount == 1) {
+        return bilinear ? sampleBilinear(levels[0], u, v, mask) : sampleNearest(levels[0], u, v, mask);
+    }
+    
+    // Clamping also maps NaN footprints of degenerate triangles to the full-resolution level
+    lod = _mm256_min_ps(_mm256_max_ps(lod, _mm256_setzero_ps()), _mm256_set1_ps(static_cast<float>(levelCount - 1)));
+    if (!bilinear) {
+        return sampleLevels(u, v, _mm256_cvttps_epi32(_mm256_add_ps(lod, _mm256_set1_ps(0.5f))), false, mask);
+    }
+    
+    // Trilinear: blend the bilinear samples of the levels below and above the level of detail
+    __m256i level = _mm256_cvttps_epi32(lod);
+    __m256i weight = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(lod, _mm256_cvtepi32_ps(level)), _mm256_set1_ps(256.0f)));
+    __m256i upperLevel = _mm256_min_epi32(_mm256_add_epi32(level, _mm256_set1_epi32(1)), _mm256_set1_epi32(levelCount - 1));
+    __m256i lower = sampleLevels(u, v, level, true, mask);
+    __m256i upper = sampleLevels(u, v, upperLevel, true, mask);
+    return lerpTexels(lower, upper, weight);
+}
+
+__m256i TextureSampler::sampleLevels(__m256 u, __m256 v, __m256i level, bool bilinear, __m256i mask) const {
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), level);
+    
+    __m256i color = _mm256_setzero_si256();
+    __m256i remaining = mask;
+    while (!_mm256_testz_si256(remaining, remaining)) {
+        int lane = std::countr_zero(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(remaining))));
+        __m256i sameLevel = _mm256_and_si256(remaining, _mm256_cmpeq_epi32(level, _mm256_set1_epi32(lanes[lane])));
+        const Level& state = levels[lanes[lane]];
+        color = _mm256_or_si256(color, bilinear ? sampleBilinear(state, u, v, sameLevel)
+                                                : sampleNearest(state, u, v, sameLevel));
+        remaining = _mm256_andnot_si256(sameLevel, remaining);
+    }
+    return color;
+}
+#endif
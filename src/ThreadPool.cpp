@@ -0,0 +1,101 @@
+#include "ThreadPool.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace {
+    thread_local unsigned int currentThreadIndex = 0;  // Set once by each worker
+}
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    threadCount = resolveThreadCount(threadCount);
+
+    // The calling thread always participates, so spawn one worker fewer
+    workers.reserve(threadCount - 1);
+    for (unsigned int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    spdlog::info("Thread pool started with {} threads", threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::getThreadIndex() {
+    return currentThreadIndex;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& job) {
+    if (count == 0) {
+        return;
+    }
+
+    // Small jobs and single-threaded pools run inline
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &job;
+        taskCount = count;
+        nextItem.store(0, std::memory_order_relaxed);
+        busyWorkers = static_cast<unsigned int>(workers.size());
+        ++generation;
+    }
+    jobAvailable.notify_all();
+
+    runItems();
+
+    // Wait until every worker has left the job before the task goes out of scope
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [this] { return busyWorkers == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned int index) {
+    currentThreadIndex = index;
+    size_t seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runItems();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0) {
+                jobFinished.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::runItems() {
+    while (true) {
+        size_t item = nextItem.fetch_add(1, std::memory_order_relaxed);
+        if (item >= taskCount) {
+            break;
+        }
+        (*task)(item);
+    }
+}
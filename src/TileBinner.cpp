@@ -0,0 +1,82 @@
+#include "TileBinner.h"
+#include <algorithm>
+
+TileBinner::TileBinner(int width, int height)
+    : width(width), height(height),
+      tilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+      tilesY((height + TILE_SIZE - 1) / TILE_SIZE) {
+}
+
+void TileBinner::reset(size_t chunkCount) {
+    // Keep the vectors of existing chunks so their capacity survives between frames
+    chunks.resize(chunkCount);
+    for (auto& bins : chunks) {
+        bins.ranges.clear();
+        bins.indices.clear();
+        bins.offsets.assign(getTileCount() + 1, 0);
+    }
+}
+
+bool TileBinner::addPrimitive(size_t chunk, float minX, float minY, float maxX, float maxY) {
+    // Reject primitives that lie completely outside the render target (this also catches NaNs)
+    if (!(maxX >= 0.0f && maxY >= 0.0f && minX < width && minY < height)) {
+        return false;
+    }
+
+    // Rasterizers may touch the pixel containing the maximum corner, so round outwards.
+    // Clamp in float first so that far off-screen coordinates cannot overflow the casts.
+    int x0 = static_cast<int>(std::max(0.0f, minX));
+    int y0 = static_cast<int>(std::max(0.0f, minY));
+    int x1 = static_cast<int>(std::min(maxX, static_cast<float>(width - 1)));
+    int y1 = static_cast<int>(std::min(maxY, static_cast<float>(height - 1)));
+
+    TileRange range;
+    range.x0 = static_cast<uint16_t>(x0 / TILE_SIZE);
+    range.y0 = static_cast<uint16_t>(y0 / TILE_SIZE);
+    range.x1 = static_cast<uint16_t>(x1 / TILE_SIZE);
+    range.y1 = static_cast<uint16_t>(y1 / TILE_SIZE);
+    chunks[chunk].ranges.push_back(range);
+    return true;
+}
+
+void TileBinner::finishChunk(size_t chunk) {
+    ChunkBins& bins = chunks[chunk];
+
+    // Count primitives per tile
+    for (const auto& range : bins.ranges) {
+        for (int ty = range.y0; ty <= range.y1; ++ty) {
+            for (int tx = range.x0; tx <= range.x1; ++tx) {
+                ++bins.offsets[ty * tilesX + tx + 1];
+            }
+        }
+    }
+
+    // Turn counts into start offsets
+    for (size_t t = 1; t < bins.offsets.size(); ++t) {
+        bins.offsets[t] += bins.offsets[t - 1];
+    }
+
+    // Scatter primitive indices into their tiles, keeping submission order
+    bins.indices.resize(bins.offsets.back());
+    std::vector<uint32_t> cursor(bins.offsets.begin(), bins.offsets.end() - 1);
+    for (uint32_t i = 0; i < bins.ranges.size(); ++i) {
+        const TileRange& range = bins.ranges[i];
+        for (int ty = range.y0; ty <= range.y1; ++ty) {
+            for (int tx = range.x0; tx <= range.x1; ++tx) {
+                bins.indices[cursor[ty * tilesX + tx]++] = i;
+            }
+        }
+    }
+}
+
+TileRect TileBinner::getTileRect(int tile) const {
+    int tx = tile % tilesX;
+    int ty = tile / tilesX;
+
+    TileRect rect;
+    rect.x0 = tx * TILE_SIZE;
+    rect.y0 = ty * TILE_SIZE;
+    rect.x1 = std::min(width, rect.x0 + TILE_SIZE);
+    rect.y1 = std::min(height, rect.y0 + TILE_SIZE);
+    return rect;
+}
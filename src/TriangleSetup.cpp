@@ -0,0 +1,49 @@
+#include "TriangleSetup.h"
+
+namespace {
+
+/**
+ * @brief Fits the plane through the values of an attribute at the three corners
+ */
+AttributePlane makePlane(float p0, float p1, float p2,
+                         float dx1, float dy1, float dx2, float dy2, float invArea) {
+    float dp1 = p1 - p0;
+    float dp2 = p2 - p0;
+    return { (dp1 * dy2 - dp2 * dy1) * invArea, (dp2 * dx1 - dp1 * dx2) * invArea, p0 };
+}
+
+} // namespace
+
+TriangleSetup::TriangleSetup(const ScreenTriangle& t)
+    : originX(t.x[0]), originY(t.y[0]) {
+    // Corner 1 and 2 relative to corner 0
+    float dx1 = t.x[1] - t.x[0], dy1 = t.y[1] - t.y[0];
+    float dx2 = t.x[2] - t.x[0], dy2 = t.y[2] - t.y[0];
+
+    // Degenerate triangles get flat planes (all gradients zero)
+    float area = dx1 * dy2 - dx2 * dy1;
+    float invArea = (area != 0.0f) ? 1.0f / area : 0.0f;
+
+    float u[3], v[3], intensity[3];
+    for (int k = 0; k < 3; ++k) {
+        u[k] = t.u[k] * t.invW[k];
+        v[k] = t.v[k] * t.invW[k];
+        intensity[k] = t.intensity[k] * t.invW[k];
+    }
+
+    depth = makePlane(t.z[0], t.z[1], t.z[2], dx1, dy1, dx2, dy2, invArea);
+    inverseW = makePlane(t.invW[0], t.invW[1], t.invW[2], dx1, dy1, dx2, dy2, invArea);
+    uOverW = makePlane(u[0], u[1], u[2], dx1, dy1, dx2, dy2, invArea);
+    vOverW = makePlane(v[0], v[1], v[2], dx1, dy1, dx2, dy2, invArea);
+    intensityOverW = makePlane(intensity[0], intensity[1], intensity[2], dx1, dy1, dx2, dy2, invArea);
+    
+    float lightX[3], lightY[3], lightZ[3];
+    for (int k = 0; k < 3; ++k) {
+        lightX[k] = t.lightX[k] * t.invW[k];
+        lightY[k] = t.lightY[k] * t.invW[k];
+        lightZ[k] = t.lightZ[k] * t.invW[k];
+    }
+    lightXOverW = makePlane(lightX[0], lightX[1], lightX[2], dx1, dy1, dx2, dy2, invArea);
+    lightYOverW = makePlane(lightY[0], lightY[1], lightY[2], dx1, dy1, dx2, dy2, invArea);
+    lightZOverW = makePlane(lightZ[0], lightZ[1], lightZ[2], dx1, dy1, dx2, dy2, invArea);
+}
@@ -0,0 +1,128 @@
+#include "VertexProcessor.h"
+#include "Clipper.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+void VertexProcessor::process(const std::vector<Eigen::Vector3f>& positions, const std::vector<uint8_t>& vertexMask,
+                              const Eigen::Matrix4f& mvp, int width, int height, ThreadPool& threadPool) {
+    clipX.resize(positions.size());
+    clipY.resize(positions.size());
+    clipZ.resize(positions.size());
+    clipW.resize(positions.size());
+    outcodes.resize(positions.size());
+    screenX.resize(positions.size());
+    screenY.resize(positions.size());
+    depth.resize(positions.size());
+
+    size_t taskCount = (positions.size() + VERTICES_PER_TASK - 1) / VERTICES_PER_TASK;
+    threadPool.parallelFor(taskCount, [&](size_t task) {
+        size_t begin = task * VERTICES_PER_TASK;
+        size_t end = std::min(positions.size(), begin + VERTICES_PER_TASK);
+        processRange(positions, vertexMask, mvp, width, height, begin, end);
+    });
+}
+
+void VertexProcessor::processRange(const std::vector<Eigen::Vector3f>& positions, const std::vector<uint8_t>& vertexMask,
+                                   const Eigen::Matrix4f& mvp, int width, int height, size_t begin, size_t end) {
+    const float halfWidth = 0.5f * width;
+    const float halfHeight = 0.5f * height;
+    size_t i = begin;
+
+#ifdef __AVX2__
+    // Positions are packed as x, y, z triplets; gather 8 of each component at a time
+    const float* source = positions.empty() ? nullptr : positions.data()->data();
+    const __m256i stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 halfWidthV = _mm256_set1_ps(halfWidth);
+    const __m256 halfHeightV = _mm256_set1_ps(halfHeight);
+    const __m256 guardBand = _mm256_set1_ps(Clipper::GUARD_BAND);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    __m256 m[4][4];
+    for (int row = 0; row < 4; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            m[row][col] = _mm256_set1_ps(mvp(row, col));
+        }
+    }
+
+    for (; i + 8 <= end; i += 8) {
+        // Skip batches that belong to culled meshlets only
+        uint64_t needed;
+        std::memcpy(&needed, &vertexMask[i], sizeof(needed));
+        if (needed == 0) {
+            continue;
+        }
+
+        const float* base = source + i * 3;
+        __m256 x = _mm256_i32gather_ps(base, stride, 4);
+        __m256 y = _mm256_i32gather_ps(base + 1, stride, 4);
+        __m256 z = _mm256_i32gather_ps(base + 2, stride, 4);
+
+        // Clip-space position: M * (x, y, z, 1)
+        __m256 clip[4];
+        for (int row = 0; row < 4; ++row) {
+            clip[row] = _mm256_fmadd_ps(m[row][0], x,
+                        _mm256_fmadd_ps(m[row][1], y,
+                        _mm256_fmadd_ps(m[row][2], z, m[row][3])));
+        }
+
+        _mm256_storeu_ps(&clipX[i], clip[0]);
+        _mm256_storeu_ps(&clipY[i], clip[1]);
+        _mm256_storeu_ps(&clipZ[i], clip[2]);
+        _mm256_storeu_ps(&clipW[i], clip[3]);
+
+        // Outcodes: one comparison mask per plane, then spread into a code per vertex
+        __m256 negW = _mm256_xor_ps(clip[3], signBit);
+        __m256 bandW = _mm256_mul_ps(guardBand, clip[3]);
+        __m256 negBandW = _mm256_xor_ps(bandW, signBit);
+        const int masks[] = {
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[2], negW, _CMP_LT_OQ)),        // NEAR
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[0], negBandW, _CMP_LT_OQ)),    // GUARD_LEFT
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[0], bandW, _CMP_GT_OQ)),       // GUARD_RIGHT
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[1], negBandW, _CMP_LT_OQ)),    // GUARD_BOTTOM
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[1], bandW, _CMP_GT_OQ)),       // GUARD_TOP
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[2], clip[3], _CMP_GT_OQ)),     // FAR
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[0], negW, _CMP_LT_OQ)),        // LEFT
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[0], clip[3], _CMP_GT_OQ)),     // RIGHT
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[1], negW, _CMP_LT_OQ)),        // BOTTOM
+            _mm256_movemask_ps(_mm256_cmp_ps(clip[1], clip[3], _CMP_GT_OQ))      // TOP
+        };
+        for (int lane = 0; lane < 8; ++lane) {
+            uint16_t code = 0;
+            for (int plane = 0; plane < 10; ++plane) {
+                code |= static_cast<uint16_t>(((masks[plane] >> lane) & 1) << plane);
+            }
+            outcodes[i + lane] = code;
+        }
+
+        // Perspective division and viewport transformation
+        __m256 ndcX = _mm256_div_ps(clip[0], clip[3]);
+        __m256 ndcY = _mm256_div_ps(clip[1], clip[3]);
+        __m256 ndcZ = _mm256_div_ps(clip[2], clip[3]);
+
+        _mm256_storeu_ps(&screenX[i], _mm256_mul_ps(_mm256_add_ps(ndcX, one), halfWidthV));
+        _mm256_storeu_ps(&screenY[i], _mm256_mul_ps(_mm256_add_ps(ndcY, one), halfHeightV));
+        _mm256_storeu_ps(&depth[i], ndcZ);
+    }
+#endif
+
+    // Remaining vertices (or all of them without AVX2)
+    for (; i < end; ++i) {
+        if (!vertexMask[i]) {
+            continue;
+        }
+        Eigen::Vector4f p = mvp * Eigen::Vector4f(positions[i].x(), positions[i].y(), positions[i].z(), 1.0f);
+        clipX[i] = p.x();
+        clipY[i] = p.y();
+        clipZ[i] = p.z();
+        clipW[i] = p.w();
+        outcodes[i] = Clipper::computeOutcode(p.x(), p.y(), p.z(), p.w());
+        screenX[i] = (p.x() / p.w() + 1.0f) * halfWidth;
+        screenY[i] = (p.y() / p.w() + 1.0f) * halfHeight;
+        depth[i] = p.z() / p.w();
+    }
+}
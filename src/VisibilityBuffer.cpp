@@ -0,0 +1,169 @@
+#include "VisibilityBuffer.h"
+#include "PixelShading.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int LANES = 8;    // Pixels shaded per step
+
+} // namespace
+
+VisibilityBuffer::VisibilityBuffer(std::vector<uint32_t>& frameBuffer, int width)
+    : frameBuffer(frameBuffer), width(width) {
+}
+
+void VisibilityBuffer::setTriangles(const std::vector<std::vector<ScreenTriangle>>& triangles,
+                                    const std::vector<std::vector<TriangleSetup>>& setups, unsigned int threadCount,
+                                    Shading shading) {
+    // Tile buffers start out empty and are emptied again by every shade()
+    size_t existingTiles = tiles.size();
+    if (existingTiles < threadCount) {
+        tiles.resize(threadCount);
+        for (size_t i = existingTiles; i < tiles.size(); ++i) {
+            std::fill(std::begin(tiles[i].triangleIds), std::end(tiles[i].triangleIds), NO_TRIANGLE);
+        }
+    }
+
+    this->shading = shading;
+    stride = shading == Shading::NORMAL_MAPPED ? ATTRIBUTE_COUNT : LX_A;
+    chunkFirstId.resize(triangles.size());
+    attributes.clear();
+
+    uint32_t id = 0;
+    for (size_t chunk = 0; chunk < triangles.size(); ++chunk) {
+        chunkFirstId[chunk] = id;
+        id += static_cast<uint32_t>(triangles[chunk].size());
+
+        // Same planes as the edge rasterizer evaluates, so both paths produce identical colors
+        for (size_t i = 0; i < triangles[chunk].size(); ++i) {
+            const TriangleSetup& setup = setups[chunk][i];
+            attributes.insert(attributes.end(), {
+                setup.originX, setup.originY,
+                setup.inverseW.a, setup.inverseW.b, setup.inverseW.c,
+                setup.uOverW.a, setup.uOverW.b, setup.uOverW.c,
+                setup.vOverW.a, setup.vOverW.b, setup.vOverW.c,
+                setup.intensityOverW.a, setup.intensityOverW.b, setup.intensityOverW.c,
+                triangles[chunk][i].intensity[0]
+            });
+            if (shading == Shading::NORMAL_MAPPED) {
+                attributes.insert(attributes.end(), {
+                    setup.lightXOverW.a, setup.lightXOverW.b, setup.lightXOverW.c,
+                    setup.lightYOverW.a, setup.lightYOverW.b, setup.lightYOverW.c,
+                    setup.lightZOverW.a, setup.lightZOverW.b, setup.lightZOverW.c
+                });
+            }
+        }
+    }
+}
+
+VisibilityTile& VisibilityBuffer::getTile() {
+    return tiles[ThreadPool::getThreadIndex()];
+}
+
+void VisibilityBuffer::shade(VisibilityTile& tile, const TileRect& clip, const TextureSampler& sampler,
+                             const TextureSampler* normalSampler) {
+#ifdef __AVX2__
+    const __m256i laneIndices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i noTriangle = _mm256_set1_epi32(static_cast<int>(NO_TRIANGLE));
+    const __m256i strides = _mm256_set1_epi32(stride);
+    const __m256 laneOffsets = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (int y = clip.y0; y < clip.y1; ++y) {
+        for (int x = clip.x0; x < clip.x1; x += LANES) {
+            int index = y * width + x;
+            int tileIndex = (y - clip.y0) * VisibilityTile::STRIDE + (x - clip.x0);
+
+            // Covered lanes: inside the tile and written by the visibility pass
+            __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(clip.x1 - x), laneIndices);
+            __m256i ids = _mm256_maskload_epi32(reinterpret_cast<const int*>(&tile.triangleIds[tileIndex]), mask);
+            mask = _mm256_andnot_si256(_mm256_cmpeq_epi32(ids, noTriangle), mask);
+            if (_mm256_testz_si256(mask, mask)) {
+                continue;
+            }
+
+            // Fetch each lane's triangle attributes; a single broadcast when all lanes share one triangle
+            __m256 values[ATTRIBUTE_COUNT];
+            int covered = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+            int firstLane = 0;
+            while (!((covered >> firstLane) & 1)) {
+                ++firstLane;
+            }
+            __m256i firstId = _mm256_permutevar8x32_epi32(ids, _mm256_set1_epi32(firstLane));
+            if (_mm256_testc_si256(_mm256_cmpeq_epi32(ids, firstId), mask)) {
+                const float* triangle = &attributes[static_cast<uint32_t>(_mm256_cvtsi256_si32(firstId)) * stride];
+                for (int i = 0; i < stride; ++i) {
+                    values[i] = _mm256_set1_ps(triangle[i]);
+                }
+            } else {
+                __m256i offsets = _mm256_mullo_epi32(ids, strides);
+                for (int i = 0; i < stride; ++i) {
+                    values[i] = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), attributes.data() + i, offsets,
+                                                         _mm256_castsi256_ps(mask), 4);
+                }
+            }
+
+            // Evaluate the planes at the pixels, exactly as the edge rasterizer does
+            __m256 dx = _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneOffsets), values[ORIGIN_X]);
+            __m256 dy = _mm256_sub_ps(_mm256_set1_ps(static_cast<float>(y)), values[ORIGIN_Y]);
+            __m256 w = _mm256_div_ps(_mm256_set1_ps(1.0f), evaluatePlane(values[W_A], values[W_B], values[W_C], dx, dy));
+            __m256 u = _mm256_mul_ps(evaluatePlane(values[U_A], values[U_B], values[U_C], dx, dy), w);
+            __m256 v = _mm256_mul_ps(evaluatePlane(values[V_A], values[V_B], values[V_C], dx, dy), w);
+            __m256 intensity = values[INTENSITY];
+            if (shading == Shading::TEXTURED_SHADED) {
+                intensity = _mm256_mul_ps(evaluatePlane(values[I_A], values[I_B], values[I_C], dx, dy), w);
+            }
+
+            __m256i texel = sampleTexture(sampler, values[U_A], values[U_B], values[V_A], values[V_B],
+                                          values[W_A], values[W_B], w, u, v, mask);
+            if (shading == Shading::NORMAL_MAPPED) {
+                __m256i normal = sampleTexture(*normalSampler, values[U_A], values[U_B], values[V_A], values[V_B],
+                                               values[W_A], values[W_B], w, u, v, mask);
+                intensity = normalMapIntensity(normal, _mm256_mul_ps(evaluatePlane(values[LX_A], values[LX_B], values[LX_C], dx, dy), w),
+                                               _mm256_mul_ps(evaluatePlane(values[LY_A], values[LY_B], values[LY_C], dx, dy), w),
+                                               _mm256_mul_ps(evaluatePlane(values[LZ_A], values[LZ_B], values[LZ_C], dx, dy), w));
+            }
+            __m256i color = applyLighting(texel, intensity);
+            _mm256_maskstore_epi32(reinterpret_cast<int*>(&frameBuffer[index]), mask, color);
+            _mm256_maskstore_epi32(reinterpret_cast<int*>(&tile.triangleIds[tileIndex]), mask, noTriangle);
+        }
+    }
+#else
+    for (int y = clip.y0; y < clip.y1; ++y) {
+        for (int x = clip.x0; x < clip.x1; ++x) {
+            int index = y * width + x;
+            int tileIndex = (y - clip.y0) * VisibilityTile::STRIDE + (x - clip.x0);
+            if (tile.triangleIds[tileIndex] == NO_TRIANGLE) {
+                continue;
+            }
+
+            const float* t = &attributes[tile.triangleIds[tileIndex] * stride];
+            float dx = static_cast<float>(x) - t[ORIGIN_X];
+            float dy = static_cast<float>(y) - t[ORIGIN_Y];
+
+            AttributePlane inverseW{t[W_A], t[W_B], t[W_C]};
+            AttributePlane uOverW{t[U_A], t[U_B], t[U_C]};
+            AttributePlane vOverW{t[V_A], t[V_B], t[V_C]};
+            float w = 1.0f / inverseW.at(dx, dy);
+            float u = uOverW.at(dx, dy) * w;
+            float v = vOverW.at(dx, dy) * w;
+            float intensity = t[INTENSITY];
+            if (shading == Shading::TEXTURED_SHADED) {
+                intensity = AttributePlane{t[I_A], t[I_B], t[I_C]}.at(dx, dy) * w;
+            } else if (shading == Shading::NORMAL_MAPPED) {
+                uint32_t normal = sampleTexture(*normalSampler, uOverW, vOverW, inverseW, w, u, v);
+                intensity = normalMapIntensity(normal, AttributePlane{t[LX_A], t[LX_B], t[LX_C]}.at(dx, dy) * w,
+                                               AttributePlane{t[LY_A], t[LY_B], t[LY_C]}.at(dx, dy) * w,
+                                               AttributePlane{t[LZ_A], t[LZ_B], t[LZ_C]}.at(dx, dy) * w);
+            }
+
+            frameBuffer[index] = applyLighting(sampleTexture(sampler, uOverW, vOverW, inverseW, w, u, v), intensity);
+            tile.triangleIds[tileIndex] = NO_TRIANGLE;
+        }
+    }
+#endif
+}
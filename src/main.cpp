@@ -9,6 +9,7 @@
 #include "CommandLineParser.h"
 #include "TGATextureLoader.h"
 #include "TextureLoaderFactory.h"
+#include "ModelLoaderFactory.h"
 
 namespace fs = std::filesystem;
 
@@ -63,6 +64,14 @@ int main(int argc, char* argv[]) {
         CommandLineParser parser(argc, argv);
         RendererConfig config = parser.parse();
         
+        // Size the shared texture cache
+        if (config.textureCacheMiB) {
+            TextureLoaderFactory::setCacheBudget(static_cast<size_t>(*config.textureCacheMiB) << 20);
+        }
+        
+        // Read and write .srmesh caches next to the models unless disabled
+        ModelLoaderFactory::setMeshCacheEnabled(config.meshCache);
+        
         // Create examples directory if needed
         if (!fs::exists("examples")) {
             fs::create_directory("examples");
@@ -104,6 +113,15 @@ int main(int argc, char* argv[]) {
                 spdlog::error("Failed to load texture from {}", config.textureFile);
                 return 1;
             }
+            if (config.textureFormat && !app.setTextureFormat(*config.textureFormat)) {
+                return 1;
+            }
+        }
+        
+        // Load the normal map if specified
+        if (!config.normalMapFile.empty() && !app.setNormalMap(config.normalMapFile, config.normalSpace)) {
+            spdlog::error("Failed to load normal map from {}", config.normalMapFile);
+            return 1;
         }
         
         // Set camera position
@@ -112,6 +130,26 @@ int main(int argc, char* argv[]) {
         // Set rendering mode
         app.setRenderMode(config.renderMode);
         
+        // Set the rasterizer backend
+        app.setRasterBackend(config.rasterBackend);
+        
+        // Override the texture filter, if requested
+        if (config.textureFilter) {
+            app.setTextureFilter(*config.textureFilter);
+        }
+        if (config.textureWrap) {
+            app.setTextureWrap(*config.textureWrap);
+        }
+        
+        // Set the triangle facing to cull
+        app.setCullMode(config.cullMode);
+        
+        // Set the shader program, if any
+        app.setShaderLook(config.shaderLook);
+        
+        // Set the number of rendering threads
+        app.setThreadCount(static_cast<unsigned int>(config.threads));
+        
         // Render the model
         if (!app.render()) {
             spdlog::error("Failed to render model");